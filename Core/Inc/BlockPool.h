@@ -0,0 +1,70 @@
+/*
+ * BlockPool.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_BLOCKPOOL_H_
+#define INC_BLOCKPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* The block classes, as poolCLASS( size in bytes, number of blocks ) entries
+in increasing order of size.  Sizes must be multiples of 8.  Define
+poolBLOCK_CLASSES in FreeRTOSConfig.h to change them.  The largest class holds
+the background commands of CommandWorker.c, and the task snapshots when
+there are few enough tasks. */
+#ifndef poolBLOCK_CLASSES
+	#define poolBLOCK_CLASSES		\
+		poolCLASS( 32, 16 )			\
+		poolCLASS( 128, 8 )			\
+		poolCLASS( 1024, 4 )
+#endif
+
+/* The size of the blocks of the largest class, for checking at compile time
+that a structure allocated from the pool fits in a block. */
+#define poolCLASS( xSize, uxBlocks ) char cClass##xSize[ xSize ];
+typedef union xBLOCK_POOL_SIZES
+{
+	poolBLOCK_CLASSES
+} BlockPoolSizes_t;
+#undef poolCLASS
+
+#define poolLARGEST_BLOCK_SIZE		sizeof( BlockPoolSizes_t )
+
+/* The usage of a block class. */
+typedef struct xBLOCK_POOL_STATS
+{
+	size_t xBlockSize;
+	UBaseType_t uxBlocks;
+	UBaseType_t uxFreeBlocks;
+	UBaseType_t uxMinimumEverFreeBlocks;
+	uint32_t ulAllocations;
+	uint32_t ulFailures;	/* Allocations this class could not satisfy, even from a larger class. */
+} BlockPoolStats_t;
+
+/*
+ * Allocate a block of at least xSize bytes from the smallest class that has
+ * one free, in constant time.  Returns NULL if there is none.  The blocks are
+ * statically allocated, so using them never fragments the FreeRTOS heap.  Must
+ * only be called from tasks.
+ */
+void *pvBlockPoolAllocate( size_t xSize );
+
+/*
+ * Return a block allocated by pvBlockPoolAllocate().  NULL is ignored.
+ */
+void vBlockPoolFree( void *pv );
+
+/*
+ * The number of block classes, and the usage of each.
+ */
+UBaseType_t uxBlockPoolClasses( void );
+void vBlockPoolGetStats( UBaseType_t uxClass, BlockPoolStats_t *pxStats );
+
+#endif /* INC_BLOCKPOOL_H_ */
@@ -0,0 +1,69 @@
+/*
+ * ClockProfile.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_CLOCKPROFILE_H_
+#define INC_CLOCKPROFILE_H_
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* The clock profiles.  All of them keep the 48MHz USB clock.
+ *
+ * eClockProfilePerformance	216MHz, voltage scale 1 with over-drive.
+ * eClockProfileBalanced	96MHz, voltage scale 3, the clock tree of the .ioc.
+ * eClockProfileLowPower	48MHz, voltage scale 3, and the idle task stops the
+ *							tick and sleeps until the next task has to run.
+ */
+typedef enum
+{
+	eClockProfilePerformance = 0,
+	eClockProfileBalanced,
+	eClockProfileLowPower,
+	eClockProfiles				/* The number of profiles, not a profile. */
+} ClockProfile_t;
+
+/* The profile main() switches to straight after SystemClock_Config(). */
+#ifndef clockBOOT_PROFILE
+	#define clockBOOT_PROFILE		eClockProfileBalanced
+#endif
+
+/*
+ * Switch the system clock to eProfile.  Everything derived from the clock is
+ * set up again: the flash wait states, the TIM1 HAL timebase, the RTOS tick,
+ * the USART3 baud rate, the Ethernet MDC clock and the run time counter.  Can
+ * be called before the scheduler is started, or from a task, which is then
+ * the only one to run until the switch is complete.  Output still being sent
+ * by USART3 is garbled, so the caller should let it drain first.  Returns
+ * pdFAIL, with the previous profile back in place, if the switch failed.
+ */
+BaseType_t xClockProfileApply( ClockProfile_t eProfile );
+
+/*
+ * Return the profile in use.
+ */
+ClockProfile_t eClockProfileGet( void );
+
+/*
+ * The name of a profile, as accepted by the clock command.
+ */
+const char *pcClockProfileName( ClockProfile_t eProfile );
+
+/*
+ * Return pdTRUE if the idle task can stop the tick and sleep in eProfile.
+ */
+BaseType_t xClockProfileAllowsSleep( ClockProfile_t eProfile );
+
+/*
+ * Called by the idle task through portSUPPRESS_TICKS_AND_SLEEP(), see
+ * FreeRTOSConfig.h.  Sleeps with the tick stopped in the profiles that allow
+ * it, and returns straight away in the others.
+ */
+void vClockProfileSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+
+#endif /* INC_CLOCKPROFILE_H_ */
@@ -0,0 +1,69 @@
+/*
+ * CommandCompress.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDCOMPRESS_H_
+#define INC_COMMANDCOMPRESS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * A byte aligned LZSS compressor for command output, streaming through a small
+ * fixed window so it needs no heap and little RAM.  It is used for the
+ * frameRESPONSE_OUTPUT_COMPRESSED frames, see CommandFrame.h.
+ *
+ * All the output of one response, compressed or not, is one stream.  Each
+ * chunk can refer back to the compressWINDOW_SIZE bytes that came before it,
+ * including those of earlier chunks, so the rows of a table compress against
+ * each other even though a command outputs one row per call.  A decoder keeps
+ * the same window: it starts empty with each response and has every byte of
+ * output appended to it, whether it arrived compressed or not.
+ *
+ * A compressed chunk is a sequence of groups.  Each group is a flag byte
+ * followed by up to eight items, one per flag bit starting with the least
+ * significant.  A clear bit is a literal byte.  A set bit is a match of two
+ * bytes: the distance back minus one, then the length minus
+ * compressMIN_MATCH.  A match can overlap the bytes it produces, so it is
+ * copied a byte at a time.  The last group of a chunk can have fewer than
+ * eight items.
+ */
+
+/* The distance back a match can reach, which is also the RAM used by each
+compressor.  Must not exceed 256, the distance is one byte. */
+#ifndef compressWINDOW_SIZE
+	#define compressWINDOW_SIZE		256
+#endif
+
+/* Matches are at least this long, a match is no shorter than the literals it
+replaces.  The longest is 255 more. */
+#define compressMIN_MATCH			3
+#define compressMAX_MATCH			( compressMIN_MATCH + 255 )
+
+/* The window of a stream, the last bytes of output oldest first. */
+typedef struct xCOMMAND_COMPRESSOR
+{
+	uint8_t ucWindow[ compressWINDOW_SIZE ];
+	size_t xWindowUsed;
+} CommandCompressor_t;
+
+/*
+ * Start a new stream.
+ */
+void vCommandCompressReset( CommandCompressor_t *pxCompressor );
+
+/*
+ * Compress the next xLength bytes of the stream into pucOutput.  Returns the
+ * compressed length, or 0 if it would not be shorter than xLength, in which
+ * case the chunk should be sent as it is.  Either way the chunk is added to
+ * the window.  pucOutput must have room for xLength bytes.
+ */
+size_t xCommandCompress( CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xLength, uint8_t *pucOutput );
+
+#endif /* INC_COMMANDCOMPRESS_H_ */
@@ -0,0 +1,139 @@
+/*
+ * CommandConsole.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDCONSOLE_H_
+#define INC_COMMANDCONSOLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+#include "CommandFrame.h"
+#include "CommandCompress.h"
+#include "CommandGovernor.h"
+
+/* Dimensions the buffer into which input characters are placed.  A line can
+hold several commands separated by ';', so it is long enough for a short batch.
+Longer lines are refused character by character, rather than cut short when
+they are executed. */
+#ifndef cmdMAX_INPUT_SIZE
+	#define cmdMAX_INPUT_SIZE		128
+#endif
+
+/* Dimensions the buffer that holds the history of each console.  The lines
+are stored back to back, each with its terminating NULL, so short lines take
+little space. */
+#ifndef cmdHISTORY_SIZE
+	#define cmdHISTORY_SIZE			256
+#endif
+
+/* The functions a transport (UART, USB, network...) provides to a console.
+pxWrite queues output for sending and returns pdFAIL if some of it had to be
+dropped.  pxFlush starts sending everything queued so far, and can be NULL if
+the transport sends output as soon as it is written.  pxWriteReference is as
+pxWrite, but for data that does not change, such as string constants and the
+references of FreeRTOS_CLIWriteReference(), which the transport can send in
+place rather than copy.  It can be left out, in which case pxWrite is used. */
+typedef struct xCOMMAND_CONSOLE_TRANSPORT
+{
+	BaseType_t ( *pxWrite )( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+	void ( *pxFlush )( void *pvTransport );
+	BaseType_t ( *pxWriteReference )( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+} CommandConsoleTransport_t;
+
+/* A command console: the line editor and the command interpreter session for
+one connection.  Each console is only used by the task that serves its
+transport, and by the worker tasks executing its background commands, so
+consoles on different transports run independently. */
+typedef struct xCOMMAND_CONSOLE
+{
+	CLI_Session_t xSession;							/* The command interpreter state. */
+	const CommandConsoleTransport_t *pxTransport;
+	void *pvTransport;								/* Passed to the transport functions. */
+	char cInputString[ cmdMAX_INPUT_SIZE ];
+	char cCommandString[ cmdMAX_INPUT_SIZE ];		/* The command of the line being executed. */
+	size_t xInputLength;
+	size_t xCursor;									/* The position in cInputString the next character is inserted at. */
+	char cHistory[ cmdHISTORY_SIZE ];				/* Executed lines, oldest first. */
+	size_t xHistoryUsed;
+	UBaseType_t uxHistoryBrowse;					/* How far back in the history the line being edited is, 0 for a new line. */
+	uint8_t ucEscapeState;							/* The progress through an ANSI escape sequence. */
+	uint8_t ucEscapeParameter;
+	char cLastRxedChar;
+	BaseType_t xOutputDropped;						/* Set if the transport dropped output of the current command. */
+	BaseType_t xFramesEnabled;						/* Set if binary frames are accepted, see CommandFrame.h. */
+	BaseType_t xReceivingFrame;
+	CommandFrameReceiver_t xFrameReceiver;
+	BaseType_t xCompressOutput;						/* Set by frameOPTION_COMPRESS. */
+	CommandCompressor_t xCompressor;				/* The window of the response being sent. */
+	SemaphoreHandle_t xLock;						/* Held while the console, or one of its background commands, writes to the transport. */
+	uint32_t ulGeneration;							/* Incremented each time the console is initialised. */
+	CommandGovernor_t xGovernor;					/* The priority of the task that processes the input. */
+} CommandConsole_t;
+
+/*
+ * Prepare pxConsole for use.  Command output is generated into pcOutputBuffer,
+ * which must not be used by any other console that can run at the same time.
+ * A console can be initialised again, for example for each new connection,
+ * after which its background commands that are still running are no longer
+ * output.  pxConsole must be zeroed before it is first initialised, as
+ * statically allocated consoles are.  It has to be initialised by the task that
+ * processes its input, which is boosted, see CommandGovernor.h.
+ */
+void vCommandConsoleInit( CommandConsole_t *pxConsole, const CommandConsoleTransport_t *pxTransport, void *pvTransport, char *pcOutputBuffer, size_t xOutputBufferLength );
+
+/*
+ * Accept the binary framed protocol, see CommandFrame.h, as well as text on
+ * pxConsole.  A frame can start wherever a new command line could.  Only
+ * enable it on transports that pass all byte values through unchanged.
+ */
+void vCommandConsoleEnableFrames( CommandConsole_t *pxConsole );
+
+/*
+ * Send the welcome message and the first prompt.
+ */
+void vCommandConsoleStart( CommandConsole_t *pxConsole );
+
+/*
+ * Process xLength characters received by the transport.  Characters are
+ * echoed, and edited with the arrow, home, end, delete and backspace keys of an
+ * ANSI terminal.  Up and down recall earlier lines, and tab completes the
+ * command.  Each completed line is executed with its output written to the
+ * transport before this function returns - unless the command is marked
+ * cliCOMMAND_FLAG_ASYNC, in which case it is passed to a worker task and its
+ * output is written as the worker generates it.  A line can hold several
+ * commands separated by ';', which are executed one after the other, in the
+ * console, with a single prompt at the end.
+ */
+void vCommandConsoleInput( CommandConsole_t *pxConsole, const char *pcInput, size_t xLength );
+
+/*
+ * Called by the task that processes the input of pxConsole when the transport
+ * has lost some of it.  A frame being received is abandoned, as is an escape
+ * sequence, so the input that follows is taken as the start of something new.
+ * The line being edited is kept.
+ */
+void vCommandConsoleInputLost( CommandConsole_t *pxConsole );
+
+/*
+ * Used by the worker tasks to write the output of a background command started
+ * when the console was in generation ulGeneration, and to say when the command
+ * has finished.  Nothing is written if the console has been initialised again
+ * since.  xCommandConsoleWriteBackground() returns pdFAIL if output was
+ * dropped.  xCommandConsoleWriteBackgroundPrefixed() writes the string pcPrefix
+ * first, with nothing written by another task in between.
+ */
+BaseType_t xCommandConsoleWriteBackground( CommandConsole_t *pxConsole, uint32_t ulGeneration, const char *pcBuffer, size_t xBufferLength );
+BaseType_t xCommandConsoleWriteBackgroundPrefixed( CommandConsole_t *pxConsole, uint32_t ulGeneration, const char *pcPrefix, const char *pcBuffer, size_t xBufferLength );
+void vCommandConsoleBackgroundFinished( CommandConsole_t *pxConsole, uint32_t ulGeneration, BaseType_t xOutputDropped );
+
+#endif /* INC_COMMANDCONSOLE_H_ */
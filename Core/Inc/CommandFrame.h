@@ -0,0 +1,159 @@
+/*
+ * CommandFrame.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDFRAME_H_
+#define INC_COMMANDFRAME_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * The binary framed protocol, used by machine clients instead of typing
+ * commands and parsing the text output.  It runs on the same consoles, and
+ * executes the same command handlers, as the text command line.
+ *
+ * Every frame, in both directions, is:
+ *
+ *   SOH | type | sequence | length (16 bits) | payload | CRC (16 bits)
+ *
+ * Multi-byte fields are little endian.  The CRC is CRC-16/CCITT-FALSE over the
+ * type, sequence, length and payload.  Responses carry the sequence number of
+ * the request they answer.
+ *
+ * frameREQUEST_EXECUTE	payload: command ID (16 bits), then parameters.  Each
+ * 						parameter is a TLV: a tag, a length byte, then the
+ * 						value.  frameTAG_STRING values are text,
+ * 						frameTAG_INT32 values are 4 byte signed integers.
+ * frameREQUEST_LIST	no payload.  Answered with a frameRESPONSE_COMMAND for
+ * 						each command.
+ * frameREQUEST_OPTIONS	payload: one byte of frameOPTION_ flags, which apply to
+ * 						the requests that follow on the same connection.
+ * frameREQUEST_WRITE	payload: offset (32 bits), then up to
+ * 						frameMAX_WRITE_DATA bytes of the firmware image
+ * 						started by "upload begin", see FirmwareUpdate.h.
+ * 						Answered with frameSTATUS_WRITE_FAILED if the data
+ * 						was not accepted.
+ *
+ * frameOPTION_COMPRESS	the output of frameREQUEST_EXECUTE is sent in
+ * 						frameRESPONSE_OUTPUT_COMPRESSED frames, where that
+ * 						makes it shorter.
+ *
+ * frameRESPONSE_OUTPUT		payload: output of the command, as generated.
+ * frameRESPONSE_OUTPUT_COMPRESSED	payload: output of the command, compressed
+ * 							as described in CommandCompress.h.  The output
+ * 							frames of a response, of both types, are one
+ * 							stream.
+ * frameRESPONSE_COMMAND	payload: command ID (16 bits), the expected number
+ * 							of parameters (signed byte, -1 for any), then the
+ * 							command string.
+ * frameRESPONSE_END		payload: a frameSTATUS_ value.  Ends the response
+ * 							to every request, including ones that were not
+ * 							understood.
+ *
+ * The ID of a command is the CRC of its command string, so it does not change
+ * when commands are added or removed.  While a command is executed for a frame
+ * FreeRTOS_CLIIsMachineReadable() returns pdTRUE, so the command can generate
+ * output without headers or padding.
+ */
+
+#define frameSOH					0x01
+
+#define frameREQUEST_EXECUTE		0x01
+#define frameREQUEST_LIST			0x02
+#define frameREQUEST_OPTIONS		0x03
+#define frameREQUEST_WRITE			0x04
+#define frameRESPONSE_OUTPUT		0x81
+#define frameRESPONSE_OUTPUT_COMPRESSED	0x83
+#define frameRESPONSE_COMMAND		0x82
+#define frameRESPONSE_END			0x8F
+
+#define frameOPTION_COMPRESS		0x01
+
+#define frameTAG_STRING				0x01
+#define frameTAG_INT32				0x02
+
+#define frameSTATUS_OK				0x00
+#define frameSTATUS_UNKNOWN_COMMAND	0x01
+#define frameSTATUS_BAD_REQUEST		0x02
+#define frameSTATUS_BAD_CRC			0x03
+#define frameSTATUS_UNKNOWN_TYPE	0x04
+#define frameSTATUS_OUTPUT_DROPPED	0x05
+#define frameSTATUS_WRITE_FAILED	0x06
+
+/* The fields of a frame. */
+#define frameHEADER_SIZE			5
+#define frameCRC_SIZE				2
+#define frameTYPE_OFFSET			1
+#define frameSEQUENCE_OFFSET		2
+#define frameLENGTH_OFFSET			3
+
+/* The largest frameREQUEST_EXECUTE payload accepted.  The command line built
+from a request must also fit in the console input buffer. */
+#define frameMAX_REQUEST_PAYLOAD	64
+
+/* The largest frameREQUEST_WRITE payload, which is the largest frame
+received. */
+#define frameWRITE_OFFSET_SIZE		4
+#define frameMAX_WRITE_DATA			512
+#define frameMAX_RECEIVE_PAYLOAD	( frameWRITE_OFFSET_SIZE + frameMAX_WRITE_DATA )
+
+/* A partly received frame is discarded if nothing more is received for this
+long, so a lost byte cannot leave the console waiting for the rest of a frame
+forever. */
+#define frameRECEIVE_TIMEOUT		( 100 / portTICK_PERIOD_MS )
+
+/* Collects the bytes of a request frame. */
+typedef struct xCOMMAND_FRAME_RECEIVER
+{
+	uint8_t ucFrame[ frameHEADER_SIZE + frameMAX_RECEIVE_PAYLOAD + frameCRC_SIZE ];
+	size_t xReceived;
+	TickType_t xLastByteTime;
+} CommandFrameReceiver_t;
+
+/*
+ * Add ucByte, received after the SOH that started the frame, to the frame.
+ * Returns pdTRUE once the whole frame has been received.  Frames that are too
+ * long are still received in full, so the end of the frame is found, but only
+ * the header is kept.
+ */
+BaseType_t xCommandFrameReceive( CommandFrameReceiver_t *pxReceiver, uint8_t ucByte );
+
+/*
+ * Check the CRC of the frame held by pxReceiver, and that its payload was
+ * kept.  Returns a frameSTATUS_ value.
+ */
+uint8_t ucCommandFrameCheck( const CommandFrameReceiver_t *pxReceiver );
+
+/*
+ * Build the command line for the frameREQUEST_EXECUTE payload pucPayload into
+ * pcLine.  Returns a frameSTATUS_ value.
+ */
+uint8_t ucCommandFrameBuildCommandLine( const uint8_t *pucPayload, size_t xLength, char *pcLine, size_t xLineLength );
+
+/*
+ * Return the ID of the command pcCommand.
+ */
+uint16_t usCommandFrameCommandID( const char *pcCommand );
+
+/*
+ * Update the CRC usCRC with xLength bytes.  Start with 0xFFFF.
+ */
+uint16_t usCommandFrameCRC( uint16_t usCRC, const uint8_t *pucData, size_t xLength );
+
+/*
+ * Fill in the header of a response frame.
+ */
+void vCommandFrameHeader( uint8_t *pucHeader, uint8_t ucType, uint8_t ucSequence, size_t xLength );
+
+/* Little endian field access. */
+#define frameREAD16( pucField )		( ( uint16_t ) ( ( pucField )[ 0 ] | ( ( pucField )[ 1 ] << 8 ) ) )
+#define frameREAD32( pucField )		( ( uint32_t ) frameREAD16( pucField ) | ( ( uint32_t ) frameREAD16( &( pucField )[ 2 ] ) << 16 ) )
+
+#endif /* INC_COMMANDFRAME_H_ */
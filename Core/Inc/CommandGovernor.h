@@ -0,0 +1,81 @@
+/*
+ * CommandGovernor.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDGOVERNOR_H_
+#define INC_COMMANDGOVERNOR_H_
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Keeps the consoles responsive without letting them take time from the
+ * tasks with deadlines.  A console task is raised to governorBOOST_PRIORITY
+ * when its console is initialised, and waits for input there, so it runs as
+ * soon as input arrives however busy the board is, and echoes it and answers
+ * short commands straight away.  Each command has a budget of CPU time,
+ * measured with the run-time stats counter of the task.  A command that uses
+ * it up is dropped to the priority the task was created with for the rest of
+ * its execution, so it only runs when nothing more important is ready, and
+ * the task is raised again once the command has finished.
+ *
+ * The budget is checked between the output strings of a command, so a single
+ * call to a command function that runs for longer, or one that suspends the
+ * scheduler, is not cut short.  Background commands run by CommandWorker.c are
+ * never boosted.
+ */
+
+/* The priority tasks process console input at.  It must be below the priority
+of every task with a deadline. */
+#ifndef governorBOOST_PRIORITY
+	#define governorBOOST_PRIORITY			( tskIDLE_PRIORITY + 2 )
+#endif
+
+/* The CPU time, in microseconds, a command can use at governorBOOST_PRIORITY.
+The budget can be changed at run time with vCommandGovernorSetBudget(). */
+#ifndef governorCOMMAND_BUDGET_US
+	#define governorCOMMAND_BUDGET_US		2000
+#endif
+
+/* The governor state of a console task. */
+typedef struct xCOMMAND_GOVERNOR
+{
+	BaseType_t xStarted;
+	UBaseType_t uxBasePriority;				/* The priority the task was created with. */
+	uint32_t ulCommandStart;				/* The run time of the task when the command started. */
+	BaseType_t xThrottled;					/* Set once the command has used up its budget. */
+} CommandGovernor_t;
+
+typedef struct xCOMMAND_GOVERNOR_STATS
+{
+	uint32_t ulBudget;						/* Microseconds. */
+	uint32_t ulCommands;
+	uint32_t ulThrottled;					/* Commands that used up their budget. */
+	uint32_t ulLongest;						/* The most CPU time a command has used, in microseconds. */
+} CommandGovernorStats_t;
+
+/*
+ * Boost the calling task.  The priority it was created with is only read the
+ * first time, so the governor has to be kept when its console is initialised
+ * again.
+ */
+void vCommandGovernorStart( CommandGovernor_t *pxGovernor );
+
+/*
+ * Called by the console task when each command starts, after each of its
+ * output strings, and when it has finished.
+ */
+void vCommandGovernorCommandStart( CommandGovernor_t *pxGovernor );
+void vCommandGovernorCheck( CommandGovernor_t *pxGovernor );
+void vCommandGovernorCommandEnd( CommandGovernor_t *pxGovernor );
+
+void vCommandGovernorSetBudget( uint32_t ulMicroseconds );
+void vCommandGovernorGetStats( CommandGovernorStats_t *pxStats );
+
+#endif /* INC_COMMANDGOVERNOR_H_ */
@@ -12,4 +12,9 @@
 
 void CommandLineInterfaceStart( uint16_t usStackSize, unsigned long uxPriority );
 
+/*
+ * Set the USART3 baud rate up again after PCLK1 has changed.
+ */
+void vCommandLineInterfaceClockChanged( void );
+
 #endif /* INC_COMMANDLINEINTERFACE_H_ */
@@ -0,0 +1,55 @@
+/*
+ * CommandWatch.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDWATCH_H_
+#define INC_COMMANDWATCH_H_
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#include "CommandConsole.h"
+
+/* The number of consoles that can watch a command at the same time.  Each
+console watches at most one command. */
+#ifndef watchMAX_WATCHES
+	#define watchMAX_WATCHES		2
+#endif
+
+/* The number of output strings of the watched command that are remembered.
+Commands generate their output a row at a time, so this is the number of rows
+that are only sent when they change.  Rows past it are always sent. */
+#ifndef watchMAX_ROWS
+	#define watchMAX_ROWS			32
+#endif
+
+/* The shortest period a command can be watched at. */
+#ifndef watchMIN_PERIOD_MS
+	#define watchMIN_PERIOD_MS		100
+#endif
+
+/*
+ * Execute pcCommandLine on behalf of pxConsole every ulPeriodMs milliseconds,
+ * from a software timer, on a worker task - see CommandWorker.h.  The first
+ * execution sends all the output.  After that only the output strings that
+ * differ from the same string of the previous execution are sent.  Each string
+ * sent is preceded by its index, counting from 1, and the first sent by an
+ * execution by a header naming the command and the execution.  Strings the
+ * previous execution had and the last one did not are reported as gone.  An
+ * execution is skipped if the previous one has not finished.  Replaces the
+ * command pxConsole was already watching.  Returns pdFAIL if all the watches
+ * are in use.  The caller checks the command has cliCOMMAND_FLAG_READ_ONLY
+ * set.
+ */
+BaseType_t xCommandWatchStart( CommandConsole_t *pxConsole, uint32_t ulPeriodMs, const char *pcCommandLine );
+
+/*
+ * Stop watching the command watched by pxConsole.  Returns pdFAIL if there was
+ * none.  The watch also stops by itself once pxConsole is initialised again.
+ */
+BaseType_t xCommandWatchStop( CommandConsole_t *pxConsole );
+
+#endif /* INC_COMMANDWATCH_H_ */
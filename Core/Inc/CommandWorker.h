@@ -0,0 +1,69 @@
+/*
+ * CommandWorker.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDWORKER_H_
+#define INC_COMMANDWORKER_H_
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#include "CommandConsole.h"
+
+/* The number of worker tasks, so the number of background commands that can
+run at the same time. */
+#ifndef workerTASKS
+	#define workerTASKS				2
+#endif
+
+/* The number of background commands that can wait for a worker. */
+#ifndef workerQUEUE_LENGTH
+	#define workerQUEUE_LENGTH		4
+#endif
+
+/* The stack of each worker task, in words. */
+#ifndef workerSTACK_SIZE
+	#define workerSTACK_SIZE		( configMINIMAL_STACK_SIZE * 3 )
+#endif
+
+/* The size of the buffer each background command generates its output into. */
+#ifndef workerOUTPUT_SIZE
+	#define workerOUTPUT_SIZE		512
+#endif
+
+/* Receives the output of a background command submitted with
+xCommandWorkerSubmitToSink() instead of the console.  pxOutput is called with
+each output string the command generates, and returns pdFAIL if it had to drop
+it.  pxFinished is called once the command has finished.  Both are called by the
+worker task, with pvContext as passed to xCommandWorkerSubmitToSink(). */
+typedef struct xCOMMAND_WORKER_SINK
+{
+	BaseType_t ( *pxOutput )( void *pvContext, const char *pcOutput, size_t xOutputLength );
+	void ( *pxFinished )( void *pvContext, BaseType_t xOutputDropped );
+} CommandWorkerSink_t;
+
+/*
+ * Create the worker tasks and the queue of background commands.  The tasks,
+ * their stacks and the queue are statically allocated.
+ */
+void CommandWorkerStart( unsigned long uxPriority );
+
+/*
+ * Queue the command line pcCommandLine to be executed by a worker task on
+ * behalf of pxConsole, with the output written to the console.  Returns pdFAIL
+ * if the queue is full or there is no memory for the command, in which case the
+ * caller should execute it itself.
+ */
+BaseType_t xCommandWorkerSubmit( CommandConsole_t *pxConsole, const char *pcCommandLine );
+
+/*
+ * As xCommandWorkerSubmit(), but the output is passed to pxSink, which must
+ * remain valid until its pxFinished function is called.  The command still
+ * runs in a session owned by pxConsole.
+ */
+BaseType_t xCommandWorkerSubmitToSink( CommandConsole_t *pxConsole, const char *pcCommandLine, const CommandWorkerSink_t *pxSink, void *pvContext );
+
+#endif /* INC_COMMANDWORKER_H_ */
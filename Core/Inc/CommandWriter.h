@@ -0,0 +1,71 @@
+/*
+ * CommandWriter.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_COMMANDWRITER_H_
+#define INC_COMMANDWRITER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Appends formatted output to the write buffer of a command.  The position is
+tracked, so each write costs only the characters it adds, and the buffer is
+always NULL terminated.  Output that does not fit is dropped and xTruncated is
+set.  Nothing is allocated, and unlike the stdio functions no newlib reentrancy
+structure is touched. */
+typedef struct xCOMMAND_WRITER
+{
+	char *pcBuffer;
+	size_t xBufferLength;
+	size_t xPosition;			/* The length of the string in pcBuffer. */
+	BaseType_t xTruncated;		/* Set once output has been dropped. */
+} CommandWriter_t;
+
+/*
+ * Start writing at the beginning of pcBuffer, which is xBufferLength bytes and
+ * is set to an empty string.
+ */
+void vCommandWriterInit( CommandWriter_t *pxWriter, char *pcBuffer, size_t xBufferLength );
+
+/*
+ * Append a string, or the first xLength characters of one, for example a
+ * parameter returned by FreeRTOS_CLIGetParameter().
+ */
+void vCommandWriteString( CommandWriter_t *pxWriter, const char *pcString );
+void vCommandWriteStringN( CommandWriter_t *pxWriter, const char *pcString, size_t xLength );
+
+/*
+ * Append pcString followed by enough spaces to fill uxWidth columns, as
+ * "%-*s" would.
+ */
+void vCommandWriteStringPadded( CommandWriter_t *pxWriter, const char *pcString, UBaseType_t uxWidth );
+
+void vCommandWriteChar( CommandWriter_t *pxWriter, char cCharacter );
+
+/*
+ * Append a decimal number right aligned in at least uxWidth columns, as "%*u"
+ * and "%*d" would.  A width of 0 uses as few columns as possible.
+ */
+void vCommandWriteUnsigned( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxWidth );
+void vCommandWriteSigned( CommandWriter_t *pxWriter, int32_t lValue, UBaseType_t uxWidth );
+
+/*
+ * Append a number in upper case hexadecimal with at least uxDigits digits,
+ * zero padded, as "%0*X" would.
+ */
+void vCommandWriteHex( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxDigits );
+
+/*
+ * Append a fixed point number: ulValue is in units of 10^-uxDecimals, so 1234
+ * with 1 decimal is written as "123.4".  Right aligned in at least uxWidth
+ * columns, counting the decimal point.
+ */
+void vCommandWriteFixed( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxDecimals, UBaseType_t uxWidth );
+
+#endif /* INC_COMMANDWRITER_H_ */
@@ -0,0 +1,85 @@
+/*
+ * ConfigStore.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_CONFIGSTORE_H_
+#define INC_CONFIGSTORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * A key/value store for settings that survive a reset, kept in the CONFIG
+ * region of STM32F767ZITX_FLASH.ld: flash sectors 1 and 2, used as two pages.
+ *
+ * Writes are appended to a log in the active page, so setting a key programs a
+ * few words and never erases.  When the active page is full the live records
+ * are copied to the other page, which becomes active, and the full page is
+ * erased later by a low priority task.  The pages take turns, so they wear
+ * evenly, and a reset at any point leaves either the old or the new page
+ * active.  Erasing a sector stalls everything that reads the flash for about
+ * half a second, which is why it is never done on the write path.
+ *
+ * A RAM index, a hash table of the offsets of the latest record of each key,
+ * finds a key without scanning the log.
+ */
+
+/* The number of keys the index has room for.  The hash table has twice as
+many slots. */
+#ifndef configstoreMAX_KEYS
+	#define configstoreMAX_KEYS			64
+#endif
+
+/* The longest key and value, not counting the terminating NULL. */
+#define configstoreMAX_KEY_LENGTH		31
+#define configstoreMAX_VALUE_LENGTH		95
+
+/* The size of each page, which is one sector. */
+#define configstorePAGE_SIZE			( 32UL * 1024UL )
+
+/* The usage of the store. */
+typedef struct xCONFIG_STORE_STATS
+{
+	UBaseType_t uxActivePage;
+	size_t xUsed;					/* Bytes of the active page written so far. */
+	size_t xSize;
+	UBaseType_t uxKeys;
+	uint32_t ulCompactions;			/* The number of times the log moved to the other page. */
+	BaseType_t xErasePending;
+} ConfigStoreStats_t;
+
+/*
+ * Find the active page and build the index, then create the task that erases
+ * full pages.  Called from main() before the scheduler is started.
+ */
+void ConfigStoreStart( unsigned long uxPriority );
+
+/*
+ * Copy the value of pcKey, NULL terminated, into pcValue.  Returns pdFAIL if
+ * the key is not set.  The value is cut short if it does not fit.
+ */
+BaseType_t xConfigStoreGet( const char *pcKey, char *pcValue, size_t xValueLength );
+
+/*
+ * Set pcKey to pcValue, or delete it if pcValue is NULL.  Returns pdFAIL if
+ * the key or value is too long, the index is full, or the flash could not be
+ * programmed.
+ */
+BaseType_t xConfigStoreSet( const char *pcKey, const char *pcValue );
+
+/*
+ * Copy the key and value of the next key at or after *puxPosition, which
+ * starts at 0, and step *puxPosition past it.  Returns pdFALSE once there are
+ * no more keys.  Keys are returned in no particular order.
+ */
+BaseType_t xConfigStoreNext( UBaseType_t *puxPosition, char *pcKey, size_t xKeyLength, char *pcValue, size_t xValueLength );
+
+void vConfigStoreGetStats( ConfigStoreStats_t *pxStats );
+
+#endif /* INC_CONFIGSTORE_H_ */
@@ -0,0 +1,122 @@
+/*
+ * FirmwareUpdate.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_FIRMWAREUPDATE_H_
+#define INC_FIRMWAREUPDATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * Updating the application over any of the consoles.
+ *
+ * The flash is laid out by STM32F767ZITX_FLASH.ld as:
+ *
+ *   0x08000000  sector 0      the boot code of FirmwareBoot.c
+ *   0x08008000  sectors 1-2   the configuration store
+ *   0x08018000  sectors 3-7   the application, starting with its vector table
+ *   0x08100000  sectors 8-11  the update area
+ *
+ * The image is the application region of a build, as made by
+ * "arm-none-eabi-objcopy -O binary -R .boot <elf> <bin>".  Its length and
+ * CRC-32 (the zlib one) are given to "upload begin", then it is sent in
+ * frameREQUEST_WRITE frames, see CommandFrame.h, and stored after the
+ * FirmwareUpdateHeader_t at the start of the update area.  A request is
+ * answered as soon as its data has been copied to one of two buffers, while a
+ * task programs the other, and the task erases the next sector of the update
+ * area while it waits for data, so the flash is written while the link is
+ * busy.  A client has to wait for the answer to one frame before sending the
+ * next, as the receive buffers only have room for one frame while the flash
+ * is stalled by an erase.
+ *
+ * "upload commit" checks the CRC of the stored image and writes the header.
+ * On the next reset the boot code finds it, copies the image over the
+ * application, checks it and marks the header as installed.  The boot sector
+ * and the configuration store are never written, so a reset during the copy
+ * starts the copy again.
+ */
+
+/* The header at the start of the update area.  The words are programmed once
+each, from erased: ulMagic last by "upload commit", ulInstalled by the boot
+code once the image has been copied. */
+typedef struct xFIRMWARE_UPDATE_HEADER
+{
+	uint32_t ulMagic;
+	uint32_t ulLength;
+	uint32_t ulCRC;
+	uint32_t ulInstalled;
+	uint32_t ulReserved[ 4 ];
+} FirmwareUpdateHeader_t;
+
+#define updateMAGIC					0x31445055UL		/* "UPD1" */
+#define updateINSTALLED				0x00000000UL
+#define updateERASED				0xFFFFFFFFUL
+
+/* The most data a single write can carry, the same as frameMAX_WRITE_DATA. */
+#define updateCHUNK_SIZE			512
+
+/* The progress of an upload. */
+typedef enum
+{
+	eUpdateIdle = 0,
+	eUpdateReceiving,
+	eUpdateCommitted,
+	eUpdateFailed
+} FirmwareUpdateState_t;
+
+typedef struct xFIRMWARE_UPDATE_STATUS
+{
+	FirmwareUpdateState_t eState;
+	uint32_t ulLength;
+	uint32_t ulReceived;			/* Bytes accepted by xFirmwareUpdateWrite(). */
+	uint32_t ulProgrammed;			/* Bytes programmed and read back. */
+	uint32_t ulErased;				/* Bytes of the update area erased. */
+	uint32_t ulMaximumLength;
+	BaseType_t xInstallPending;		/* Set if a committed image is installed on the next reset. */
+} FirmwareUpdateStatus_t;
+
+/*
+ * Create the task that programs the update area.
+ */
+void FirmwareUpdateStart( unsigned long uxPriority );
+
+/*
+ * Start receiving an image of ulLength bytes with the CRC-32 ulCRC, dropping
+ * any upload in progress.  Returns pdFAIL if the image is too long for the
+ * application region.
+ */
+BaseType_t xFirmwareUpdateBegin( uint32_t ulLength, uint32_t ulCRC );
+
+/*
+ * Queue xLength bytes of the image, which go at ulOffset, to be programmed.
+ * The data has to be sent in order, in words, except at the end of the image.
+ * Data that has already been received is accepted again and ignored, so a
+ * write whose answer was lost can be repeated.  Returns pdFAIL if the data is
+ * out of order, or programming has failed.
+ */
+BaseType_t xFirmwareUpdateWrite( uint32_t ulOffset, const uint8_t *pucData, size_t xLength );
+
+/*
+ * Wait for the received data to be programmed, check the CRC of the stored
+ * image, and write the header so it is installed on the next reset.
+ */
+BaseType_t xFirmwareUpdateCommit( void );
+
+void vFirmwareUpdateAbort( void );
+
+void vFirmwareUpdateGetStatus( FirmwareUpdateStatus_t *pxStatus );
+
+/*
+ * The CRC-32 used for the image, computed by the boot code.  Start with 0 and
+ * pass the result of one call to the next.
+ */
+uint32_t ulFirmwareBootCRC32( uint32_t ulCRC, const uint8_t *pucData, size_t xLength );
+
+#endif /* INC_FIRMWAREUPDATE_H_ */
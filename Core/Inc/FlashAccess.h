@@ -0,0 +1,47 @@
+/*
+ * FlashAccess.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_FLASHACCESS_H_
+#define INC_FLASHACCESS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * Programming and erasing the internal flash, shared by the configuration
+ * store and the firmware update.  The HAL flash driver only handles one
+ * operation at a time, and locks the flash again when it is done, so the
+ * operations are serialised here.
+ *
+ * The flash is used as a single bank, so every read of it, including
+ * instruction fetches and vector fetches, stalls while a word is programmed or
+ * a sector is erased.  Erasing a 256K sector takes one to two seconds.
+ */
+
+/*
+ * Program xLength bytes from pvData at ulAddress, which must be word aligned.
+ * The last word is padded with 0xFF.  The D-cache lines of the range are
+ * invalidated, so the new contents are read back.
+ */
+BaseType_t xFlashProgram( uint32_t ulAddress, const void *pvData, size_t xLength );
+
+/*
+ * Erase the sector that starts at ulAddress.  Returns pdFAIL if no sector
+ * starts there.
+ */
+BaseType_t xFlashEraseSector( uint32_t ulAddress );
+
+/*
+ * Return the size of the sector that holds ulAddress, or 0 if it is not in the
+ * flash.  The start of the sector is returned in *pulStart.
+ */
+uint32_t ulFlashSector( uint32_t ulAddress, uint32_t *pulStart );
+
+#endif /* INC_FLASHACCESS_H_ */
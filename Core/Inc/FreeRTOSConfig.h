@@ -54,6 +54,7 @@
 /* USER CODE BEGIN 0 */
   extern void configureTimerForRunTimeStats(void);
   extern unsigned long getRunTimeCounterValue(void);
+  extern void vClockProfileSuppressTicksAndSleep(uint32_t xExpectedIdleTime);
 /* USER CODE END 0 */
 #endif
 #define configENABLE_FPU                         0
@@ -169,6 +170,17 @@ standard names. */
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 #define configCOMMAND_INT_MAX_OUTPUT_SIZE 1024
+/* Collect the CLI commands into a const table in flash rather than registering
+them on the heap at run time. */
+#define configCOMMAND_INT_STATIC_COMMANDS 1
+/* The CLI uses a thread local storage pointer to find the session being
+served by the calling task. */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1
+#define configCOMMAND_INT_TLS_INDEX 0
+/* The idle task stops the tick and sleeps, but only in the clock profiles that
+allow it, see ClockProfile.h. */
+#define configUSE_TICKLESS_IDLE 1
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vClockProfileSuppressTicksAndSleep( xExpectedIdleTime )
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
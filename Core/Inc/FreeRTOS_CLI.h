@@ -49,16 +49,163 @@ typedef struct xCOMMAND_LINE_INPUT
 	const char * const pcHelpString;			/* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
 	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;	/* A pointer to the callback function that will return the output generated by the command. */
 	int8_t cExpectedNumberOfParameters;			/* Commands expect a fixed number of parameters, which may be zero. */
+	uint8_t ucFlags;							/* cliCOMMAND_FLAG_... values.  Zero when left out of the initialiser. */
 } CLI_Command_Definition_t;
 
+/* Set in ucFlags for a command that can take long enough to hold up its
+console.  Consoles hand these to a worker task, see CommandWorker.h, and carry
+on accepting input while the command runs. */
+#define cliCOMMAND_FLAG_ASYNC		( 1U << 0 )
+
+/* Set in ucFlags for a command that only reports, and changes nothing
+whatever its parameters.  Only these commands can be executed periodically by
+watch, see CommandWatch.h. */
+#define cliCOMMAND_FLAG_READ_ONLY	( 1U << 1 )
+
 /* For backward compatibility. */
 #define xCommandLineInput CLI_Command_Definition_t
 
+/* Set configCOMMAND_INT_STATIC_COMMANDS to 1 in FreeRTOSConfig.h to have the
+commands collected into a const table in flash at link time, rather than
+registered at run time.  No heap is then used by the command interpreter, and
+FreeRTOS_CLIRegisterCommand() only checks the command is in the table.  The
+linker script must provide the sorted .cli_commands output section. */
+#ifndef configCOMMAND_INT_STATIC_COMMANDS
+	#define configCOMMAND_INT_STATIC_COMMANDS 0
+#endif
+
+/* An entry in the command index.  The length of the command string is cached
+so it does not have to be recomputed for each command line. */
+typedef struct xCOMMAND_TABLE_ENTRY
+{
+	const CLI_Command_Definition_t *pxCommandLineDefinition;
+	size_t xCommandLength;
+} CLI_Command_Table_Entry_t;
+
+/* The number of parameters whose position is cached when a command line is
+tokenised.  Parameters past this number can still be obtained, but are found by
+scanning the command line. */
+#ifndef configCOMMAND_INT_MAX_PARAMETERS
+	#define configCOMMAND_INT_MAX_PARAMETERS 16
+#endif
+
+/* The position of a parameter within the command line. */
+typedef struct xCOMMAND_PARAMETER
+{
+	uint16_t usOffset;
+	uint16_t usLength;
+} CLI_Parameter_t;
+
+/* The parameters of the command being executed.  The command line is
+tokenised once, before the command is dispatched, so the parameter count check
+and each FreeRTOS_CLIGetParameter() call made by the command do not have to scan
+the command line again. */
+typedef struct xCOMMAND_PARAMETER_TABLE
+{
+	const char *pcCommandString;			/* The command line the table was built from. */
+	size_t xCommandLength;					/* The length of the command itself, the first word of the command line. */
+	UBaseType_t uxNumberOfParameters;		/* The number of parameters found, which can be more than are cached. */
+	CLI_Parameter_t xParameters[ configCOMMAND_INT_MAX_PARAMETERS ];
+} CLI_Parameter_Table_t;
+
+/* State a command can use to keep track of its progress when it returns pdTRUE
+to generate its output over several calls.  It is zeroed before the first call
+for each command line, and belongs to the session executing the command, so a
+command that keeps its state here rather than in static variables can be
+executed by several sessions at once.  A command that holds memory or anything
+else between calls sets pxAbandon, which FreeRTOS_CLIAbandonCommand() calls if
+the command is not executed to the end. */
+typedef struct xCOMMAND_STATE
+{
+	BaseType_t xStep;
+	UBaseType_t uxIndex;
+	const void *pvPosition;
+	void ( *pxAbandon )( struct xCOMMAND_STATE *pxState );
+} CLI_Command_State_t;
+
+/* The number of pieces the output of one call to a command can be made of,
+when it refers to data outside the output buffer with
+FreeRTOS_CLIWriteReference(). */
+#ifndef configCOMMAND_INT_MAX_OUTPUT_CHUNKS
+	#define configCOMMAND_INT_MAX_OUTPUT_CHUNKS 12
+#endif
+
+/* A piece of the output of a command.  ucReference is set if pcData is the
+data passed to FreeRTOS_CLIWriteReference(), which can be sent in place, and
+clear if it is part of the output buffer, which is reused by the next call. */
+typedef struct xCOMMAND_OUTPUT_CHUNK
+{
+	const char *pcData;
+	uint16_t usLength;
+	uint8_t ucReference;
+} CLI_Output_Chunk_t;
+
+/* Everything the command interpreter needs to execute commands for one
+command console.  Each console that can be used at the same time as another
+must have its own session, and its own output buffer.  The members are private
+to the command interpreter. */
+typedef struct xCOMMAND_SESSION
+{
+	const CLI_Command_Table_Entry_t *pxCommand;		/* The command being executed, or NULL if the next call starts a new command. */
+	CLI_Parameter_Table_t xParameters;				/* The parameters of the command being executed. */
+	CLI_Command_State_t xCommandState;				/* The progress of the command being executed. */
+	char *pcOutputBuffer;							/* The buffer the command output is written to. */
+	size_t xOutputBufferLength;
+	BaseType_t xMachineReadable;					/* Set if the output is read by a program rather than a person. */
+	void *pvOwner;									/* The console the session executes commands for, if any. */
+	BaseType_t xAcceptsReferences;					/* Set if whatever executes commands in the session sends the output chunks. */
+	CLI_Output_Chunk_t xOutputChunks[ configCOMMAND_INT_MAX_OUTPUT_CHUNKS ];	/* The output of the last call, if it used FreeRTOS_CLIWriteReference(). */
+	UBaseType_t uxOutputChunks;
+	size_t xOutputChunked;							/* The length of the text in the output buffer already in xOutputChunks. */
+} CLI_Session_t;
+
+/*
+ * Define a command.  This declares a const CLI_Command_Definition_t called
+ * xDefinition, and when configCOMMAND_INT_STATIC_COMMANDS is 1 also places an
+ * entry for it in the command table.  pcCommandString must be a string literal
+ * as it is also used to name the table section, which is how the linker sorts
+ * the table.  For example:
+ *
+ * FreeRTOS_CLI_DEFINE_COMMAND( xTaskStats, "task-stats", "\r\ntask-stats:\r\n ...\r\n", prvTaskStatsCommand, 0 );
+ *
+ * FreeRTOS_CLI_DEFINE_ASYNC_COMMAND() defines a command with
+ * cliCOMMAND_FLAG_ASYNC set.  FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS() takes the
+ * flags as its last argument.
+ */
+#if( configCOMMAND_INT_STATIC_COMMANDS == 1 )
+	#define FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, ucFlags )	\
+		static const CLI_Command_Definition_t xDefinition =																			\
+		{																																\
+			pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, ucFlags									\
+		};																																\
+		static const CLI_Command_Table_Entry_t xDefinition##TableEntry __attribute__( ( section( ".cli_commands." pcCommandString ), used ) ) =	\
+		{																																\
+			&xDefinition, sizeof( pcCommandString ) - 1																					\
+		}
+#else
+	#define FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, ucFlags )	\
+		static const CLI_Command_Definition_t xDefinition =																			\
+		{																																\
+			pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, ucFlags									\
+		}
+#endif
+
+#define FreeRTOS_CLI_DEFINE_COMMAND( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters )				\
+	FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, 0 )
+
+#define FreeRTOS_CLI_DEFINE_ASYNC_COMMAND( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters )			\
+	FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS( xDefinition, pcCommandString, pcHelpString, pxCommandInterpreter, cExpectedNumberOfParameters, cliCOMMAND_FLAG_ASYNC )
+
 /*
  * Register the command passed in using the pxCommandToRegister parameter.
  * Registering a command adds the command to the list of commands that are
  * handled by the command interpreter.  Once a command has been registered it
  * can be executed from the command line.
+ *
+ * Registered commands are kept in an index sorted by command string, so the
+ * command string must be a single word and can only be registered once.  At
+ * most configCOMMAND_INT_MAX_COMMANDS commands, including "help", can be
+ * registered.  pdFAIL is returned if the command could not be registered.
  */
 BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister );
 
@@ -71,30 +218,163 @@ BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const p
  * FreeRTOS_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
  *
  * pcCmdIntProcessCommand is not reentrant.  It must not be called from more
- * than one task - or at least - by more than one task at a time.
+ * than one task - or at least - by more than one task at a time.  Use
+ * FreeRTOS_CLIProcessSessionCommand() to run more than one command console.
  */
 BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  );
 
+/*
+ * Prepare pxSession for use with FreeRTOS_CLIProcessSessionCommand().  Output
+ * generated by commands executed in the session is written to pcOutputBuffer,
+ * which is xOutputBufferLength bytes long.
+ */
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession, char *pcOutputBuffer, size_t xOutputBufferLength );
+
+/*
+ * As FreeRTOS_CLIProcessCommand(), but all the state is kept in pxSession and
+ * the output is written to the output buffer of the session.  Different
+ * sessions can be used by different tasks at the same time, but a session must
+ * only be used by one task at a time.
+ */
+BaseType_t FreeRTOS_CLIProcessSessionCommand( CLI_Session_t *pxSession, const char * const pcCommandInput );
+
+/*
+ * Stop the command pxSession is executing, if FreeRTOS_CLIProcessSessionCommand()
+ * has not yet returned pdFALSE for it, so the next call starts a new command.
+ * The pxAbandon function of the command, if it set one, is called first, from
+ * the session, to free what the command holds.  Called before a session that can
+ * be part way through a command is initialised again or thrown away.
+ */
+void FreeRTOS_CLIAbandonCommand( CLI_Session_t *pxSession );
+
+/*
+ * Return the session of the command being executed by the calling task, or
+ * NULL if the calling task is not executing a command.
+ */
+CLI_Session_t *FreeRTOS_CLIGetSession( void );
+
+/*
+ * Return the state of the command being executed by the calling task, or NULL
+ * if the calling task is not executing a command.
+ */
+CLI_Command_State_t *FreeRTOS_CLIGetCommandState( void );
+
+/*
+ * Say whether the output of commands executed in pxSession is read by a
+ * program, such as a test client using the framed protocol, rather than a
+ * person.  pdFALSE after FreeRTOS_CLISessionInit().
+ */
+void FreeRTOS_CLISetMachineReadable( CLI_Session_t *pxSession, BaseType_t xMachineReadable );
+
+/*
+ * Return pdTRUE if the output of the command being executed by the calling task
+ * is read by a program, in which case the command can leave out headers and
+ * column padding.
+ */
+BaseType_t FreeRTOS_CLIIsMachineReadable( void );
+
+/*
+ * Record the console, or whatever else executes commands in pxSession, so
+ * commands that act on their console can find it.  NULL after
+ * FreeRTOS_CLISessionInit().
+ */
+void FreeRTOS_CLISetSessionOwner( CLI_Session_t *pxSession, void *pvOwner );
+
+/*
+ * Return the owner of the session of the command being executed by the calling
+ * task, or NULL if the calling task is not executing a command or the session
+ * has no owner.
+ */
+void *FreeRTOS_CLIGetSessionOwner( void );
+
+/*
+ * Say whether whatever executes commands in pxSession sends the output chunks
+ * returned by FreeRTOS_CLIGetOutputChunks(), rather than just the string in the
+ * output buffer.  pdFALSE after FreeRTOS_CLISessionInit().
+ */
+void FreeRTOS_CLISetAcceptsReferences( CLI_Session_t *pxSession, BaseType_t xAcceptsReferences );
+
+/*
+ * Return pdTRUE if the command being executed by the calling task can use
+ * FreeRTOS_CLIWriteReference().
+ */
+BaseType_t FreeRTOS_CLIAcceptsReferences( void );
+
+/*
+ * Called by a command to output xLength bytes at pcData, after what it has
+ * written to its output buffer so far, without copying them to the output
+ * buffer.  The console sends the data in place where its transport can, so the
+ * data must not change for as long as the console runs, as is the case for
+ * string constants in flash.  What the command writes to its output buffer
+ * afterwards follows the data, and what it wrote before must not be changed.
+ * Returns pdFAIL, and outputs nothing, if the session does not accept
+ * references, pcData is longer than 65535 bytes, or the output of this call
+ * already has as many pieces as it can hold.  The command can then copy the
+ * data, or return pdTRUE and output it on its next call.
+ */
+BaseType_t FreeRTOS_CLIWriteReference( const char *pcData, size_t xLength );
+
+/*
+ * Return the number of pieces the output of the last call made in pxSession
+ * is made of, and point *ppxChunks at them.  Returns 0 if the output is just
+ * the string in the output buffer, as it always is when the session does not
+ * accept references.
+ */
+UBaseType_t FreeRTOS_CLIGetOutputChunks( const CLI_Session_t *pxSession, const CLI_Output_Chunk_t **ppxChunks );
+
+/*
+ * Return the command at uxPosition in the command index, which is sorted by
+ * command string, or NULL if uxPosition is past the last command.  Used to
+ * enumerate the commands.
+ */
+const CLI_Command_Definition_t *FreeRTOS_CLIGetCommand( UBaseType_t uxPosition );
+
+/*
+ * Return the registered command that the command line pcCommandInput would
+ * execute, or NULL if there is none.  The parameters are not checked.
+ */
+const CLI_Command_Definition_t *FreeRTOS_CLIFindCommand( const char *pcCommandInput );
+
+/*
+ * Command lines can hold several commands separated by ';'.  Copy the first of
+ * the commands in pcCommands into pcCommand, which is xCommandLength bytes,
+ * without the leading and trailing spaces, and return a pointer to the
+ * commands that follow it, or NULL if it was the last.  A ';' inside double
+ * quotes is part of a parameter.  A command too long for pcCommand is cut
+ * short.  pcCommand is set to an empty string if the command is empty.
+ */
+const char *FreeRTOS_CLINextCommand( const char *pcCommands, char *pcCommand, size_t xCommandLength );
+
 /*-----------------------------------------------------------*/
 
 /*
  * A buffer into which command outputs can be written is declared in the
  * main command interpreter, rather than in the command console implementation,
- * to allow application that provide access to the command console via multiple
- * interfaces to share a buffer, and therefore save RAM.  Note, however, that
- * the command interpreter itself is not re-entrant, so only one command
- * console interface can be used at any one time.  For that reason, no attempt
- * is made to provide any mutual exclusion mechanism on the output buffer.
+ * so a command console that does not need its own buffer can use this one.
+ * Consoles that run at the same time must each have their own output buffer,
+ * so no attempt is made to provide any mutual exclusion mechanism on this one.
  *
  * FreeRTOS_CLIGetOutputBuffer() returns the address of the output buffer.
  */
 char *FreeRTOS_CLIGetOutputBuffer( void );
 
 /*
- * Return a pointer to the xParameterNumber'th word in pcCommandString.
+ * Return a pointer to the xParameterNumber'th parameter in pcCommandString.
+ * Parameters are separated by spaces, and a parameter that starts with a double
+ * quote extends to the closing double quote so it can contain spaces.  The
+ * quotes are not included in the returned parameter.
+ *
+ * The command line of the command being executed is tokenised before the
+ * command is called, so when called from a command with the pcCommandString it
+ * was passed the parameter is returned without scanning the string.
  */
 const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength );
 
+/*
+ * Return the number of parameters that follow the command in pcCommandString.
+ */
+UBaseType_t FreeRTOS_CLIGetNumberOfParameters( const char *pcCommandString );
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
@@ -0,0 +1,76 @@
+/*
+ * Latency.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_LATENCY_H_
+#define INC_LATENCY_H_
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* The latencies that are measured. */
+typedef enum
+{
+	eLatencyUARTCallback = 0,	/* USART3 or RX DMA interrupt entry to HAL_UARTEx_RxEventCallback(). */
+	eLatencyUARTWake,			/* The first of those interrupts to the console task running. */
+	eLatencyTickJitter,			/* Deviation of the time between TIM1 (HAL tick) interrupts from 1ms. */
+	eLatencyHistograms			/* The number of histograms, not a histogram. */
+} LatencyHistogram_t;
+
+/* The statistics of a histogram, in CPU cycles.  The percentiles are the upper
+edge of the bucket they fall in, so are up to 25% above the true value. */
+typedef struct xLATENCY_SUMMARY
+{
+	uint32_t ulCount;
+	uint32_t ulMinimum;
+	uint32_t ulMedian;
+	uint32_t ul99thPercentile;
+	uint32_t ulMaximum;
+} LatencySummary_t;
+
+/*
+ * Add a measurement, in CPU cycles, to a histogram.  Each histogram must only
+ * be written from one context - one interrupt or one task.
+ */
+void vLatencyRecord( LatencyHistogram_t eHistogram, uint32_t ulCycles );
+
+/*
+ * The measurement points.  vLatencyUARTInterrupt() is called on entry to the
+ * USART3 and USART3 RX DMA interrupts, vLatencyUARTCallback() from the RX event
+ * callback, vLatencyUARTTaskResumed() when the console task returns from
+ * waiting for received characters, and vLatencyTick() on entry to the TIM1
+ * interrupt.
+ */
+void vLatencyUARTInterrupt( void );
+void vLatencyUARTCallback( void );
+void vLatencyUARTTaskResumed( void );
+void vLatencyTick( void );
+
+/*
+ * Forget the time of the last TIM1 interrupt, so the next one is not measured.
+ * Called when the tick was stopped, or the clocks changed.
+ */
+void vLatencyTickRestart( void );
+
+/*
+ * Read the statistics of a histogram.  Must only be called from tasks.
+ */
+void vLatencyGetSummary( LatencyHistogram_t eHistogram, LatencySummary_t *pxSummary );
+
+/*
+ * Empty a histogram.  It is cleared by its writer the next time it records a
+ * measurement, so it is never written from two contexts at once.
+ */
+void vLatencyReset( LatencyHistogram_t eHistogram );
+
+/*
+ * The name to show for a histogram.
+ */
+const char *pcLatencyName( LatencyHistogram_t eHistogram );
+
+#endif /* INC_LATENCY_H_ */
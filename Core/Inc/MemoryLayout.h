@@ -0,0 +1,47 @@
+/*
+ * MemoryLayout.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_MEMORYLAYOUT_H_
+#define INC_MEMORYLAYOUT_H_
+
+/*
+ * Placement of code and data in the Cortex-M7 memories, see the linker script.
+ *
+ * memoryDMA_BUFFER		Buffers and descriptors accessed by a DMA controller.
+ * 						They are placed in a region the MPU makes
+ * 						non-cacheable, so they need no cache maintenance.
+ * memoryDTCM_DATA		Initialised data in the zero wait state DTCM.
+ * memoryDTCM_BSS		Zero initialised data in the DTCM.
+ * memoryITCM_CODE		Functions executed from the zero wait state ITCM.
+ *
+ * Data that is only used by the CPU but is written by a DMA controller, or read
+ * by one, after being written by the CPU, must either use memoryDMA_BUFFER or
+ * be cleaned and invalidated by the driver, as NetworkInterface.c does for the
+ * payloads it sends in place.
+ */
+#ifndef memoryPLACEMENT_DISABLED
+	#define memoryDMA_BUFFER		__attribute__( ( section( ".dma_buffer" ) ) )
+	#define memoryDTCM_DATA			__attribute__( ( section( ".dtcm_data" ) ) )
+	#define memoryDTCM_BSS			__attribute__( ( section( ".dtcm_bss" ) ) )
+	#define memoryITCM_CODE			__attribute__( ( section( ".itcm_text" ), noinline ) )
+#else
+	/* Defined when the command interpreter, console and pool sources are
+	built for a host, against the FreeRTOS POSIX port, to measure them without
+	a board, see Host/CMakeLists.txt.  There is only one memory there. */
+	#define memoryDMA_BUFFER
+	#define memoryDTCM_DATA
+	#define memoryDTCM_BSS
+	#define memoryITCM_CODE
+#endif
+
+/*
+ * Configure the MPU for the memory layout and enable the instruction and data
+ * caches.  Called at the start of main(), before anything uses a DMA buffer.
+ */
+void vMemoryLayoutConfigure( void );
+
+#endif /* INC_MEMORYLAYOUT_H_ */
@@ -0,0 +1,91 @@
+/*
+ * NetworkInterface.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_NETWORKINTERFACE_H_
+#define INC_NETWORKINTERFACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Build an IPv4 address in host byte order. */
+#define networkIPV4( a, b, c, d )	( ( ( uint32_t ) ( a ) << 24 ) | ( ( uint32_t ) ( b ) << 16 ) | ( ( uint32_t ) ( c ) << 8 ) | ( uint32_t ) ( d ) )
+
+/* The static address of the board.  There is no DHCP client, so boards that
+share a network have to be built with their own address. */
+#ifndef networkIP_ADDRESS
+	#define networkIP_ADDRESS		networkIPV4( 192, 168, 1, 10 )
+#endif
+
+/* IP protocol numbers. */
+#define networkPROTOCOL_ICMP		1
+#define networkPROTOCOL_TCP			6
+
+/* The sizes of the headers built by xNetworkSendIPv4(), and the largest
+transport header it accepts. */
+#define networkETHERNET_HEADER_SIZE	14
+#define networkIPV4_HEADER_SIZE		20
+#define networkMAX_TRANSPORT_HEADER	28
+
+/* The largest IPv4 payload that fits in a standard Ethernet frame. */
+#define networkMTU					1500
+
+/*
+ * Bring up the Ethernet MAC initialised by MX_ETH_Init() and start the task
+ * that receives frames, answers ARP and ICMP echo requests, and passes TCP
+ * segments to vTelnetTCPInput().
+ */
+void NetworkInterfaceStart( uint16_t usStackSize, unsigned long uxPriority );
+
+/*
+ * All the state of the network stack is protected by a single lock.  The
+ * network task holds it while a received frame is processed, and other tasks
+ * must hold it while calling xNetworkSendIPv4().
+ */
+void vNetworkLock( void );
+void vNetworkUnlock( void );
+
+/*
+ * Send an IPv4 packet to ulDestinationIP through the station pucDestinationMAC.
+ * The transport header is copied into the frame header, but the payload is
+ * read by the Ethernet DMA straight from pucPayload, so it must stay unchanged
+ * until it has been sent - for TCP, until it has been acknowledged.  The IP and
+ * transport checksums are inserted by the MAC.  Returns pdFAIL if no transmit
+ * descriptor became free in time.
+ */
+BaseType_t xNetworkSendIPv4( const uint8_t *pucDestinationMAC, uint32_t ulDestinationIP, uint8_t ucProtocol,
+							 const uint8_t *pucTransportHeader, size_t xTransportHeaderLength,
+							 const uint8_t *pucPayload, size_t xPayloadLength );
+
+/* Big endian field access for protocol headers. */
+static inline uint16_t usNetworkRead16( const uint8_t *pucField )
+{
+	return ( uint16_t ) ( ( pucField[ 0 ] << 8 ) | pucField[ 1 ] );
+}
+
+static inline uint32_t ulNetworkRead32( const uint8_t *pucField )
+{
+	return ( ( uint32_t ) pucField[ 0 ] << 24 ) | ( ( uint32_t ) pucField[ 1 ] << 16 ) | ( ( uint32_t ) pucField[ 2 ] << 8 ) | pucField[ 3 ];
+}
+
+static inline void vNetworkWrite16( uint8_t *pucField, uint16_t usValue )
+{
+	pucField[ 0 ] = ( uint8_t ) ( usValue >> 8 );
+	pucField[ 1 ] = ( uint8_t ) usValue;
+}
+
+static inline void vNetworkWrite32( uint8_t *pucField, uint32_t ulValue )
+{
+	pucField[ 0 ] = ( uint8_t ) ( ulValue >> 24 );
+	pucField[ 1 ] = ( uint8_t ) ( ulValue >> 16 );
+	pucField[ 2 ] = ( uint8_t ) ( ulValue >> 8 );
+	pucField[ 3 ] = ( uint8_t ) ulValue;
+}
+
+#endif /* INC_NETWORKINTERFACE_H_ */
@@ -0,0 +1,45 @@
+/*
+ * RunTimeStats.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_RUNTIMESTATS_H_
+#define INC_RUNTIMESTATS_H_
+
+#include <stdint.h>
+
+/* The period, in microseconds, of the counter the kernel is given for its
+run-time stats, see getRunTimeCounterValue().  The kernel's counters are 32
+bits, so they wrap after 2^32 periods: after about 5 days with 100 us, rather
+than the 71 minutes microseconds would give. */
+#ifndef runtimeCOUNTER_PERIOD_US
+	#define runtimeCOUNTER_PERIOD_US	100
+#endif
+
+/*
+ * The time base behind configGENERATE_RUN_TIME_STATS.  It is the DWT cycle
+ * counter extended to 64 bits, so it never wraps in practice and can also be
+ * used to time code.  Both functions can be called from tasks and from
+ * interrupts at or below configMAX_SYSCALL_INTERRUPT_PRIORITY, once the
+ * scheduler has been started.
+ */
+uint64_t ullGetRunTimeCycles( void );
+uint64_t ullGetRunTimeMicroseconds( void );
+
+/*
+ * Called after SystemCoreClock has changed, so the cycles counted from now on
+ * are converted to microseconds at the new rate.  The cycles counted before
+ * the change must have been collected first by a call to
+ * ullGetRunTimeCycles().
+ */
+void vRunTimeStatsClockChanged( void );
+
+/*
+ * Add time the cycle counter did not see, because the core was asleep, to the
+ * microsecond count.  The cycle count is left as it is.
+ */
+void vRunTimeStatsAddMicroseconds( uint32_t ulMicroseconds );
+
+#endif /* INC_RUNTIMESTATS_H_ */
@@ -0,0 +1,45 @@
+/*
+ * TelnetCommandConsole.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_TELNETCOMMANDCONSOLE_H_
+#define INC_TELNETCOMMANDCONSOLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* The TCP port the console listens on. */
+#ifndef telnetPORT
+	#define telnetPORT				23
+#endif
+
+/* The number of connections that can be served at the same time.  Each has
+its own task, console and output buffer. */
+#ifndef telnetMAX_SESSIONS
+	#define telnetMAX_SESSIONS		2
+#endif
+
+/*
+ * Create the tasks that serve the telnet sessions.  NetworkInterfaceStart()
+ * must also be called so connections are accepted.
+ */
+void TelnetCommandConsoleStart( uint16_t usStackSize, unsigned long uxPriority );
+
+/*
+ * Called by the network task, with the network lock held, for each TCP segment
+ * addressed to the board.
+ */
+void vTelnetTCPInput( const uint8_t *pucSourceMAC, uint32_t ulSourceIP, const uint8_t *pucSegment, size_t xLength );
+
+/*
+ * Called by the network task, with the network lock held, every
+ * telnetTIMER_PERIOD_MS to retransmit unacknowledged data.
+ */
+void vTelnetTimer( void );
+
+#define telnetTIMER_PERIOD_MS		50
+
+#endif /* INC_TELNETCOMMANDCONSOLE_H_ */
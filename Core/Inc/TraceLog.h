@@ -0,0 +1,55 @@
+/*
+ * TraceLog.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_TRACELOG_H_
+#define INC_TRACELOG_H_
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* The number of records kept.  Must be a power of two.  When the log is full
+the oldest records are overwritten. */
+#ifndef tracelogRECORDS
+	#define tracelogRECORDS			256
+#endif
+
+/* A trace record.  Formatting is deferred until the record is read, so
+writing one only costs a few stores. */
+typedef struct xTRACE_RECORD
+{
+	volatile uint32_t ulSequence;	/* The index of the record plus one once it is complete, 0 while it is written. */
+	uint32_t ulTimestamp;			/* The DWT cycle counter when the record was written. */
+	const char *pcFormat;			/* printf() format that formats the arguments. */
+	uint32_t ulContext;				/* The exception number (IPSR), 0 for a task. */
+	uint32_t ulArguments[ 4 ];
+} TraceRecord_t;
+
+/*
+ * Add a record to the trace log.  Can be called from any task or interrupt,
+ * including interrupts above configMAX_SYSCALL_INTERRUPT_PRIORITY, as it never
+ * blocks or masks interrupts.  pcFormat must be a string literal, as it is
+ * only used when the record is read, and can only contain conversions of 32-bit
+ * integers, such as %u, %d and %x.
+ */
+void vTraceLog( const char *pcFormat, uint32_t ulArgument1, uint32_t ulArgument2, uint32_t ulArgument3, uint32_t ulArgument4 );
+
+/*
+ * Copy the oldest record that has not been read yet into pxRecord and remove
+ * it from the log.  *pulLost is set to the number of records overwritten before
+ * they could be read.  Returns pdFALSE if there is no complete record to read.
+ * Must only be called from tasks.
+ */
+BaseType_t xTraceLogRead( TraceRecord_t *pxRecord, uint32_t *pulLost );
+
+/*
+ * Discard all the records that have not been read.
+ */
+void vTraceLogClear( void );
+
+#endif /* INC_TRACELOG_H_ */
@@ -0,0 +1,20 @@
+/*
+ * USBCommandConsole.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_USBCOMMANDCONSOLE_H_
+#define INC_USBCOMMANDCONSOLE_H_
+
+#include <stdint.h>
+
+/*
+ * Start a command console on USB_OTG_FS, enumerating as a CDC-ACM virtual COM
+ * port.  hpcd_USB_OTG_FS must have been initialised, and the commands are
+ * registered by CommandLineInterfaceStart().
+ */
+void USBCommandConsoleStart( uint16_t usStackSize, unsigned long uxPriority );
+
+#endif /* INC_USBCOMMANDCONSOLE_H_ */
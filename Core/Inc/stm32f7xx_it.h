@@ -55,7 +55,10 @@ void DebugMon_Handler(void);
 void TIM1_UP_TIM10_IRQHandler(void);
 void USART3_IRQHandler(void);
 /* USER CODE BEGIN EFP */
-
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void OTG_FS_IRQHandler(void);
+void ETH_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
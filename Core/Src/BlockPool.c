@@ -0,0 +1,174 @@
+/*
+ * BlockPool.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "BlockPool.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+#include "MemoryLayout.h"
+
+/* A free block holds the link to the next free block of its class. */
+typedef struct xFREE_BLOCK
+{
+	struct xFREE_BLOCK *pxNext;
+} FreeBlock_t;
+
+typedef struct xBLOCK_CLASS
+{
+	size_t xBlockSize;
+	UBaseType_t uxBlocks;
+	uint8_t *pucBlocks;
+
+	/* Blocks that have been freed.  Blocks from uxUnused on have never been
+	allocated, so are not linked into the list, which saves initialising the
+	pool at startup. */
+	FreeBlock_t *pxFreeList;
+	UBaseType_t uxUnused;
+
+	UBaseType_t uxFreeBlocks;
+	UBaseType_t uxMinimumEverFreeBlocks;
+	uint32_t ulAllocations;
+	uint32_t ulFailures;
+} BlockClass_t;
+
+/* The memory of each class.  uint64_t keeps the blocks 8 byte aligned. */
+#define poolCLASS( xSize, uxBlocks ) \
+	static uint64_t ullBlocks##xSize[ ( ( xSize ) * ( uxBlocks ) ) / sizeof( uint64_t ) ] memoryDTCM_BSS;
+poolBLOCK_CLASSES
+#undef poolCLASS
+
+#define poolCLASS( xSize, uxBlocks ) \
+	{ ( xSize ), ( uxBlocks ), ( uint8_t * ) ullBlocks##xSize, NULL, 0, ( uxBlocks ), ( uxBlocks ), 0, 0 },
+static BlockClass_t xClasses[] =
+{
+	poolBLOCK_CLASSES
+};
+#undef poolCLASS
+
+#define poolNUMBER_OF_CLASSES		( sizeof( xClasses ) / sizeof( xClasses[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+void *pvBlockPoolAllocate( size_t xSize )
+{
+BlockClass_t *pxClass, *pxFit = NULL;
+FreeBlock_t *pxBlock = NULL;
+UBaseType_t x;
+
+	taskENTER_CRITICAL();
+	{
+		/* The classes are in increasing order of size, so the first that has
+		a free block large enough is the best fit. */
+		for( x = 0; x < poolNUMBER_OF_CLASSES; x++ )
+		{
+			pxClass = &xClasses[ x ];
+			if( pxClass->xBlockSize < xSize )
+			{
+				continue;
+			}
+
+			if( pxFit == NULL )
+			{
+				pxFit = pxClass;
+			}
+
+			if( pxClass->pxFreeList != NULL )
+			{
+				pxBlock = pxClass->pxFreeList;
+				pxClass->pxFreeList = pxBlock->pxNext;
+			}
+			else if( pxClass->uxUnused < pxClass->uxBlocks )
+			{
+				pxBlock = ( FreeBlock_t * ) &( pxClass->pucBlocks[ pxClass->uxUnused * pxClass->xBlockSize ] );
+				pxClass->uxUnused++;
+			}
+			else
+			{
+				/* This class is exhausted, try the next larger one. */
+				continue;
+			}
+
+			pxClass->uxFreeBlocks--;
+			if( pxClass->uxFreeBlocks < pxClass->uxMinimumEverFreeBlocks )
+			{
+				pxClass->uxMinimumEverFreeBlocks = pxClass->uxFreeBlocks;
+			}
+			pxClass->ulAllocations++;
+			break;
+		}
+
+		if( ( pxBlock == NULL ) && ( pxFit != NULL ) )
+		{
+			pxFit->ulFailures++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+void vBlockPoolFree( void *pv )
+{
+BlockClass_t *pxClass;
+FreeBlock_t *pxBlock = ( FreeBlock_t * ) pv;
+UBaseType_t x;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	for( x = 0; x < poolNUMBER_OF_CLASSES; x++ )
+	{
+		pxClass = &xClasses[ x ];
+		if( ( ( uint8_t * ) pv >= pxClass->pucBlocks ) && ( ( uint8_t * ) pv < &( pxClass->pucBlocks[ pxClass->uxBlocks * pxClass->xBlockSize ] ) ) )
+		{
+			/* Only the start of a block can be freed. */
+			configASSERT( ( ( ( uint8_t * ) pv - pxClass->pucBlocks ) % pxClass->xBlockSize ) == 0 );
+
+			taskENTER_CRITICAL();
+			{
+				pxBlock->pxNext = pxClass->pxFreeList;
+				pxClass->pxFreeList = pxBlock;
+				pxClass->uxFreeBlocks++;
+			}
+			taskEXIT_CRITICAL();
+			return;
+		}
+	}
+
+	/* The block was not allocated from the pool. */
+	configASSERT( pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxBlockPoolClasses( void )
+{
+	return ( UBaseType_t ) poolNUMBER_OF_CLASSES;
+}
+/*-----------------------------------------------------------*/
+
+void vBlockPoolGetStats( UBaseType_t uxClass, BlockPoolStats_t *pxStats )
+{
+const BlockClass_t *pxClass;
+
+	configASSERT( uxClass < poolNUMBER_OF_CLASSES );
+	pxClass = &xClasses[ uxClass ];
+
+	taskENTER_CRITICAL();
+	{
+		pxStats->xBlockSize = pxClass->xBlockSize;
+		pxStats->uxBlocks = pxClass->uxBlocks;
+		pxStats->uxFreeBlocks = pxClass->uxFreeBlocks;
+		pxStats->uxMinimumEverFreeBlocks = pxClass->uxMinimumEverFreeBlocks;
+		pxStats->ulAllocations = pxClass->ulAllocations;
+		pxStats->ulFailures = pxClass->ulFailures;
+	}
+	taskEXIT_CRITICAL();
+}
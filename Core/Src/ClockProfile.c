@@ -0,0 +1,272 @@
+/*
+ * ClockProfile.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "ClockProfile.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+#include "main.h"
+#include "CommandLineInterface.h"
+#include "RunTimeStats.h"
+#include "Latency.h"
+
+/* The settings of a profile.  The PLL is fed by the 8MHz HSE divided by 4, as
+in SystemClock_Config(), and PLLQ always gives the 48MHz the USB core needs. */
+typedef struct xCLOCK_PROFILE_SETTINGS
+{
+	const char *pcName;
+	uint32_t ulPLLN;
+	uint32_t ulPLLP;
+	uint32_t ulPLLQ;
+	uint32_t ulVoltageScale;
+	BaseType_t xOverDrive;
+	uint32_t ulAPB1Divider;			/* PCLK1 must not exceed 54MHz. */
+	uint32_t ulAPB2Divider;			/* PCLK2 must not exceed 108MHz. */
+	uint32_t ulFlashLatency;		/* For a 2.7V to 3.6V supply. */
+	BaseType_t xAllowSleep;
+} ClockProfileSettings_t;
+
+static const ClockProfileSettings_t xProfiles[ eClockProfiles ] =
+{
+	/* eClockProfilePerformance */
+	{ "performance", 216, RCC_PLLP_DIV2, 9, PWR_REGULATOR_VOLTAGE_SCALE1, pdTRUE, RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_7, pdFALSE },
+	/* eClockProfileBalanced */
+	{ "balanced", 96, RCC_PLLP_DIV2, 4, PWR_REGULATOR_VOLTAGE_SCALE3, pdFALSE, RCC_HCLK_DIV2, RCC_HCLK_DIV1, FLASH_LATENCY_3, pdFALSE },
+	/* eClockProfileLowPower */
+	{ "low-power", 96, RCC_PLLP_DIV4, 4, PWR_REGULATOR_VOLTAGE_SCALE3, pdFALSE, RCC_HCLK_DIV1, RCC_HCLK_DIV1, FLASH_LATENCY_1, pdTRUE }
+};
+
+/* SystemClock_Config() sets up the clock tree of the balanced profile, but
+with over-drive on. */
+static ClockProfile_t eCurrentProfile = eClockProfileBalanced;
+
+/* Reprograms SysTick, and recalculates the tickless idle reload values, from
+configCPU_CLOCK_HZ.  Provided by the FreeRTOS port. */
+extern void vPortSetupTimerInterrupt( void );
+
+#if( configUSE_TICKLESS_IDLE == 1 )
+	/* The tickless idle implementation of the FreeRTOS port. */
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+#endif
+
+/*
+ * Move the system clock onto the HSE, set the PLL and the regulator up for
+ * pxSettings and move back onto the PLL.  Returns pdFAIL if the HAL reported
+ * an error, in which case the system clock can be left on the HSE.
+ */
+static BaseType_t prvSwitchClocks( const ClockProfileSettings_t *pxSettings );
+
+/*
+ * Set the divider of the Ethernet MDC clock for the new HCLK, which the HAL
+ * only does when the MAC is initialised.
+ */
+static void prvUpdateMDCClock( void );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xClockProfileApply( ClockProfile_t eProfile )
+{
+const BaseType_t xSchedulerRunning = ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) ? pdTRUE : pdFALSE;
+BaseType_t xReturn;
+
+	configASSERT( eProfile < eClockProfiles );
+
+	if( xSchedulerRunning != pdFALSE )
+	{
+		/* Count the time up to now at the old rate. */
+		( void ) ullGetRunTimeCycles();
+
+		/* Interrupts stay enabled, the HAL needs the TIM1 tick for its
+		timeouts. */
+		vTaskSuspendAll();
+	}
+
+	xReturn = prvSwitchClocks( &( xProfiles[ eProfile ] ) );
+	if( xReturn == pdPASS )
+	{
+		eCurrentProfile = eProfile;
+	}
+	else if( prvSwitchClocks( &( xProfiles[ eCurrentProfile ] ) ) != pdPASS )
+	{
+		/* The clocks are in an unknown state. */
+		Error_Handler();
+	}
+
+	/* HAL_RCC_ClockConfig() has already updated SystemCoreClock and set the
+	TIM1 timebase up again. */
+	vCommandLineInterfaceClockChanged();
+	prvUpdateMDCClock();
+
+	if( xSchedulerRunning != pdFALSE )
+	{
+		vPortSetupTimerInterrupt();
+		vRunTimeStatsClockChanged();
+		vLatencyTickRestart();
+		( void ) xTaskResumeAll();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+ClockProfile_t eClockProfileGet( void )
+{
+	return eCurrentProfile;
+}
+/*-----------------------------------------------------------*/
+
+const char *pcClockProfileName( ClockProfile_t eProfile )
+{
+	configASSERT( eProfile < eClockProfiles );
+	return xProfiles[ eProfile ].pcName;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xClockProfileAllowsSleep( ClockProfile_t eProfile )
+{
+	configASSERT( eProfile < eClockProfiles );
+	return xProfiles[ eProfile ].xAllowSleep;
+}
+/*-----------------------------------------------------------*/
+
+void vClockProfileSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+#if( configUSE_TICKLESS_IDLE == 1 )
+TickType_t xStartTick;
+uint32_t ulStartCycle, ulSleptMicroseconds, ulAwakeMicroseconds;
+
+	if( xProfiles[ eCurrentProfile ].xAllowSleep == pdFALSE )
+	{
+		return;
+	}
+
+	/* Called with the scheduler suspended.  The HAL tick would wake the core
+	every millisecond, so it is stopped as well. */
+	xStartTick = xTaskGetTickCount();
+	ulStartCycle = DWT->CYCCNT;
+	HAL_SuspendTick();
+
+	vPortSuppressTicksAndSleep( xExpectedIdleTime );
+
+	HAL_ResumeTick();
+	vLatencyTickRestart();
+
+	/* The cycle counter stops while the core sleeps, so add the time it
+	missed to the run time counter.  The port has already stepped the tick
+	count on by the time that passed. */
+	ulSleptMicroseconds = ( uint32_t ) ( xTaskGetTickCount() - xStartTick ) * ( 1000000UL / configTICK_RATE_HZ );
+	ulAwakeMicroseconds = ( DWT->CYCCNT - ulStartCycle ) / ( SystemCoreClock / 1000000UL );
+	if( ulSleptMicroseconds > ulAwakeMicroseconds )
+	{
+		vRunTimeStatsAddMicroseconds( ulSleptMicroseconds - ulAwakeMicroseconds );
+	}
+#else
+	( void ) xExpectedIdleTime;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSwitchClocks( const ClockProfileSettings_t *pxSettings )
+{
+RCC_OscInitTypeDef xOscInit = { 0 };
+RCC_ClkInitTypeDef xClkInit = { 0 };
+
+	xClkInit.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+	xClkInit.AHBCLKDivider = RCC_SYSCLK_DIV1;
+
+	/* The PLL cannot be changed while it is the system clock, and the
+	regulator scale can only be changed while the PLL is off.  The wait states
+	are left as they are, there are enough for the HSE whatever they are. */
+	xClkInit.SYSCLKSource = RCC_SYSCLKSOURCE_HSE;
+	xClkInit.APB1CLKDivider = RCC_HCLK_DIV1;
+	xClkInit.APB2CLKDivider = RCC_HCLK_DIV1;
+	if( HAL_RCC_ClockConfig( &xClkInit, __HAL_FLASH_GET_LATENCY() ) != HAL_OK )
+	{
+		return pdFAIL;
+	}
+
+	if( __HAL_PWR_GET_FLAG( PWR_FLAG_ODRDY ) != RESET )
+	{
+		if( HAL_PWREx_DisableOverDrive() != HAL_OK )
+		{
+			return pdFAIL;
+		}
+	}
+
+	xOscInit.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	xOscInit.PLL.PLLState = RCC_PLL_OFF;
+	if( HAL_RCC_OscConfig( &xOscInit ) != HAL_OK )
+	{
+		return pdFAIL;
+	}
+
+	__HAL_PWR_VOLTAGESCALING_CONFIG( pxSettings->ulVoltageScale );
+
+	xOscInit.PLL.PLLState = RCC_PLL_ON;
+	xOscInit.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+	xOscInit.PLL.PLLM = 4;
+	xOscInit.PLL.PLLN = pxSettings->ulPLLN;
+	xOscInit.PLL.PLLP = pxSettings->ulPLLP;
+	xOscInit.PLL.PLLQ = pxSettings->ulPLLQ;
+	xOscInit.PLL.PLLR = 2;
+	if( HAL_RCC_OscConfig( &xOscInit ) != HAL_OK )
+	{
+		return pdFAIL;
+	}
+
+	if( pxSettings->xOverDrive != pdFALSE )
+	{
+		if( HAL_PWREx_EnableOverDrive() != HAL_OK )
+		{
+			return pdFAIL;
+		}
+	}
+
+	/* HAL_RCC_ClockConfig() puts the new wait states in before raising the
+	clock, or after lowering it. */
+	xClkInit.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+	xClkInit.APB1CLKDivider = pxSettings->ulAPB1Divider;
+	xClkInit.APB2CLKDivider = pxSettings->ulAPB2Divider;
+	if( HAL_RCC_ClockConfig( &xClkInit, pxSettings->ulFlashLatency ) != HAL_OK )
+	{
+		return pdFAIL;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateMDCClock( void )
+{
+uint32_t ulHCLK = HAL_RCC_GetHCLKFreq(), ulRange;
+
+	/* MDC must stay below 2.5MHz. */
+	if( ulHCLK >= 150000000UL )
+	{
+		ulRange = ETH_MACMIIAR_CR_Div102;
+	}
+	else if( ulHCLK >= 100000000UL )
+	{
+		ulRange = ETH_MACMIIAR_CR_Div62;
+	}
+	else if( ulHCLK >= 60000000UL )
+	{
+		ulRange = ETH_MACMIIAR_CR_Div42;
+	}
+	else if( ulHCLK >= 35000000UL )
+	{
+		ulRange = ETH_MACMIIAR_CR_Div26;
+	}
+	else
+	{
+		ulRange = ETH_MACMIIAR_CR_Div16;
+	}
+
+	ETH->MACMIIAR = ( ETH->MACMIIAR & ~ETH_MACMIIAR_CR ) | ulRange;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,189 @@
+/*
+ * CommandCompress.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandCompress.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/*
+ * The byte at lIndex in the stream, counted from the start of the chunk being
+ * compressed.  Negative indexes are in the window.
+ */
+static uint8_t prvStreamByte( const CommandCompressor_t *pxCompressor, const uint8_t *pucInput, int32_t lIndex );
+
+/*
+ * Find the longest match for the bytes at xPosition of the chunk.  Returns its
+ * length, or 0 if there is none of at least compressMIN_MATCH bytes.
+ */
+static size_t prvFindMatch( const CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xPosition, size_t xLength, size_t *pxDistance );
+
+/*
+ * Add a chunk to the window.
+ */
+static void prvUpdateWindow( CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+void vCommandCompressReset( CommandCompressor_t *pxCompressor )
+{
+	pxCompressor->xWindowUsed = 0;
+}
+/*-----------------------------------------------------------*/
+
+size_t xCommandCompress( CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xLength, uint8_t *pucOutput )
+{
+size_t xPosition = 0, xOut = 0, xFlags = 0, xMatch, xDistance;
+UBaseType_t uxItem = 8;
+
+	while( xPosition < xLength )
+	{
+		if( uxItem == 8 )
+		{
+			/* Start a group. */
+			xFlags = xOut;
+			if( xOut >= xLength )
+			{
+				break;
+			}
+			pucOutput[ xOut++ ] = 0;
+			uxItem = 0;
+		}
+
+		xMatch = prvFindMatch( pxCompressor, pucInput, xPosition, xLength, &xDistance );
+		if( xMatch != 0 )
+		{
+			if( ( xOut + 2 ) > xLength )
+			{
+				break;
+			}
+			pucOutput[ xFlags ] |= ( uint8_t ) ( 1U << uxItem );
+			pucOutput[ xOut++ ] = ( uint8_t ) ( xDistance - 1 );
+			pucOutput[ xOut++ ] = ( uint8_t ) ( xMatch - compressMIN_MATCH );
+			xPosition += xMatch;
+		}
+		else
+		{
+			if( xOut >= xLength )
+			{
+				break;
+			}
+			pucOutput[ xOut++ ] = pucInput[ xPosition ];
+			xPosition++;
+		}
+
+		uxItem++;
+	}
+
+	/* Stopping before the end means the output grew as long as the input. */
+	if( ( xPosition < xLength ) || ( xOut >= xLength ) )
+	{
+		xOut = 0;
+	}
+
+	prvUpdateWindow( pxCompressor, pucInput, xLength );
+
+	return xOut;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStreamByte( const CommandCompressor_t *pxCompressor, const uint8_t *pucInput, int32_t lIndex )
+{
+	if( lIndex < 0 )
+	{
+		return pxCompressor->ucWindow[ ( int32_t ) pxCompressor->xWindowUsed + lIndex ];
+	}
+
+	return pucInput[ lIndex ];
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFindMatch( const CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xPosition, size_t xLength, size_t *pxDistance )
+{
+size_t xBest = 0, xDistance, xMaximum, xMatch, xReach;
+uint8_t ucFirst = pucInput[ xPosition ];
+
+	xMaximum = xLength - xPosition;
+	if( xMaximum > compressMAX_MATCH )
+	{
+		xMaximum = compressMAX_MATCH;
+	}
+	if( xMaximum < compressMIN_MATCH )
+	{
+		return 0;
+	}
+
+	/* The window and the chunk so far can both be referred to. */
+	xReach = xPosition + pxCompressor->xWindowUsed;
+	if( xReach > compressWINDOW_SIZE )
+	{
+		xReach = compressWINDOW_SIZE;
+	}
+
+	/* A brute force search of a window this small costs less than the time
+	the bytes it saves take to send. */
+	for( xDistance = 1; xDistance <= xReach; xDistance++ )
+	{
+		if( prvStreamByte( pxCompressor, pucInput, ( int32_t ) xPosition - ( int32_t ) xDistance ) != ucFirst )
+		{
+			continue;
+		}
+
+		/* Only the candidates that could be longer than the best one found so
+		far are compared in full. */
+		if( ( xBest != 0 ) &&
+			( prvStreamByte( pxCompressor, pucInput, ( int32_t ) ( xPosition + xBest ) - ( int32_t ) xDistance ) != pucInput[ xPosition + xBest ] ) )
+		{
+			continue;
+		}
+
+		for( xMatch = 1; xMatch < xMaximum; xMatch++ )
+		{
+			if( prvStreamByte( pxCompressor, pucInput, ( int32_t ) ( xPosition + xMatch ) - ( int32_t ) xDistance ) != pucInput[ xPosition + xMatch ] )
+			{
+				break;
+			}
+		}
+
+		if( xMatch > xBest )
+		{
+			xBest = xMatch;
+			*pxDistance = xDistance;
+			if( xBest == xMaximum )
+			{
+				break;
+			}
+		}
+	}
+
+	return ( xBest >= compressMIN_MATCH ) ? xBest : 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateWindow( CommandCompressor_t *pxCompressor, const uint8_t *pucInput, size_t xLength )
+{
+size_t xKeep;
+
+	if( xLength >= compressWINDOW_SIZE )
+	{
+		memcpy( pxCompressor->ucWindow, &pucInput[ xLength - compressWINDOW_SIZE ], compressWINDOW_SIZE );
+		pxCompressor->xWindowUsed = compressWINDOW_SIZE;
+		return;
+	}
+
+	/* Keep as much of the old window as still fits in front of the chunk. */
+	xKeep = compressWINDOW_SIZE - xLength;
+	if( xKeep > pxCompressor->xWindowUsed )
+	{
+		xKeep = pxCompressor->xWindowUsed;
+	}
+
+	memmove( pxCompressor->ucWindow, &pxCompressor->ucWindow[ pxCompressor->xWindowUsed - xKeep ], xKeep );
+	memcpy( &pxCompressor->ucWindow[ xKeep ], pucInput, xLength );
+	pxCompressor->xWindowUsed = xKeep + xLength;
+}
+/*-----------------------------------------------------------*/
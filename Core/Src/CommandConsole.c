@@ -0,0 +1,982 @@
+/*
+ * CommandConsole.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandConsole.h"
+#include "CommandWorker.h"
+#include "BlockPool.h"
+#include "FirmwareUpdate.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* DEL acts as a backspace. */
+#define cmdASCII_DEL		( 0x7F )
+#define cmdASCII_ESC		( 0x1B )
+#define cmdASCII_BEL		( 0x07 )
+
+/* The states of ucEscapeState.  Terminals send the editing keys as ESC [
+followed by an optional number and a final character, or as ESC O and a final
+character. */
+#define cmdESCAPE_NONE		0
+#define cmdESCAPE_STARTED	1
+#define cmdESCAPE_SEQUENCE	2
+
+/* Const messages output by the command console. */
+static const char * const pcWelcomeMessage = "\r\n\r\nFreeRTOS command server.\r\nType Help to view a list of registered commands.\r\n\r\n>";
+static const char * const pcEndOfOutputMessage = "\r\n[Press ENTER to execute the previous command again]\r\n>";
+static const char * const pcNewLine = "\r\n";
+static const char * const pcOutputDroppedMessage = "\r\n[Console output was dropped]\r\n";
+static const char * const pcBackgroundMessage = "[Running in the background]\r\n>";
+static const char * const pcBackgroundFinishedMessage = "\r\n[Background command finished]\r\n>";
+
+/*
+ * Write to the transport of the console, remembering if any output had to be
+ * dropped.  prvWriteReference() is for data that does not change, which the
+ * transport can send in place.
+ */
+static void prvWrite( CommandConsole_t *pxConsole, const char *pcBuffer, size_t xBufferLength );
+static void prvWriteReference( CommandConsole_t *pxConsole, const char *pcBuffer, size_t xBufferLength );
+
+/*
+ * Write the output of the last call made in the session of the console, which
+ * is either the string in its output buffer or the output chunks of the
+ * session.
+ */
+static void prvWriteOutput( CommandConsole_t *pxConsole );
+
+/*
+ * Start sending everything written to the transport so far.
+ */
+static void prvFlush( CommandConsole_t *pxConsole );
+
+/*
+ * Act on a character received while not in an escape sequence, other than the
+ * end of a line, or on the final character of an escape sequence.
+ */
+static void prvEditLine( CommandConsole_t *pxConsole, char cRxedChar );
+static void prvEscapeSequence( CommandConsole_t *pxConsole, char cFinal, uint8_t ucParameter );
+
+/*
+ * Line editing primitives.  Each updates cInputString and the terminal.
+ */
+static void prvInsertCharacter( CommandConsole_t *pxConsole, char cCharacter );
+static void prvDeleteCharacter( CommandConsole_t *pxConsole );
+static void prvMoveCursorTo( CommandConsole_t *pxConsole, size_t xPosition );
+static void prvReplaceLine( CommandConsole_t *pxConsole, const char *pcLine );
+
+/*
+ * Move the terminal cursor left xColumns, without changing xCursor.
+ */
+static void prvCursorLeft( CommandConsole_t *pxConsole, size_t xColumns );
+
+/*
+ * Write the characters from xCursor to the end of the line, followed by
+ * xErase spaces to remove characters deleted from the end, then move the
+ * terminal cursor back to xCursor.
+ */
+static void prvRedrawTail( CommandConsole_t *pxConsole, size_t xErase );
+
+/*
+ * Add pcLine to the history, dropping the oldest lines if there is not space.
+ * The same line twice in a row is only stored once.
+ */
+static void prvHistoryAdd( CommandConsole_t *pxConsole, const char *pcLine );
+
+/*
+ * Return the line uxBack lines back in the history, 1 being the latest, or
+ * NULL if the history does not go that far back.
+ */
+static const char *prvHistoryEntry( CommandConsole_t *pxConsole, UBaseType_t uxBack );
+
+/*
+ * Complete the command being typed from the index of registered commands, or
+ * list the choices if there is more than one.
+ */
+static void prvCompleteCommand( CommandConsole_t *pxConsole );
+
+/*
+ * Execute the command in cInputString and send its output.
+ */
+static void prvExecuteLine( CommandConsole_t *pxConsole );
+
+/*
+ * Execute the request frame held in xFrameReceiver and send the response
+ * frames.
+ */
+static void prvExecuteFrame( CommandConsole_t *pxConsole );
+
+/*
+ * Send a frame with a payload made of xPrefixLength bytes from pucPrefix, then
+ * xLength bytes from pucPayload.  Either can be NULL if its length is 0.
+ */
+static void prvWriteFrame( CommandConsole_t *pxConsole, uint8_t ucType, uint8_t ucSequence, const uint8_t *pucPrefix, size_t xPrefixLength, const uint8_t *pucPayload, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleInit( CommandConsole_t *pxConsole, const CommandConsoleTransport_t *pxTransport, void *pvTransport, char *pcOutputBuffer, size_t xOutputBufferLength )
+{
+	SemaphoreHandle_t xLock;
+	uint32_t ulGeneration;
+	CommandGovernor_t xGovernor;
+
+	configASSERT( pxConsole );
+	configASSERT( pxTransport );
+	configASSERT( pxTransport->pxWrite );
+
+	/* A background command of the previous generation can still be running,
+	so the lock is kept, and taken so the command is not part way through a
+	write. */
+	xLock = pxConsole->xLock;
+	if( xLock == NULL )
+	{
+		xLock = xSemaphoreCreateMutex();
+		configASSERT( xLock );
+	}
+	xSemaphoreTake( xLock, portMAX_DELAY );
+	ulGeneration = pxConsole->ulGeneration + 1;
+
+	/* A command the console was part way through, when its connection went,
+	frees what it holds before the session is cleared. */
+	FreeRTOS_CLIAbandonCommand( &( pxConsole->xSession ) );
+	xGovernor = pxConsole->xGovernor;
+
+	memset( pxConsole, 0x00, sizeof( CommandConsole_t ) );
+	FreeRTOS_CLISessionInit( &( pxConsole->xSession ), pcOutputBuffer, xOutputBufferLength );
+	FreeRTOS_CLISetSessionOwner( &( pxConsole->xSession ), pxConsole );
+	FreeRTOS_CLISetAcceptsReferences( &( pxConsole->xSession ), pdTRUE );
+	pxConsole->pxTransport = pxTransport;
+	pxConsole->pvTransport = pvTransport;
+	pxConsole->xLock = xLock;
+	pxConsole->ulGeneration = ulGeneration;
+
+	pxConsole->xGovernor = xGovernor;
+
+	xSemaphoreGive( xLock );
+
+	/* The console is initialised by the task that processes its input, which
+	waits for the input boosted.  This is done once the lock has been given
+	back, so the priority it reads was not inherited from a background
+	command. */
+	vCommandGovernorStart( &( pxConsole->xGovernor ) );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleEnableFrames( CommandConsole_t *pxConsole )
+{
+	pxConsole->xFramesEnabled = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleStart( CommandConsole_t *pxConsole )
+{
+	/* Send the welcome message. */
+	xSemaphoreTake( pxConsole->xLock, portMAX_DELAY );
+	prvWriteReference( pxConsole, pcWelcomeMessage, strlen( pcWelcomeMessage ) );
+	prvFlush( pxConsole );
+	xSemaphoreGive( pxConsole->xLock );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleInput( CommandConsole_t *pxConsole, const char *pcInput, size_t xLength )
+{
+	char cRxedChar;
+
+	/* Background commands only write between bursts of input. */
+	xSemaphoreTake( pxConsole->xLock, portMAX_DELAY );
+
+	while( xLength > 0 )
+	{
+		cRxedChar = *pcInput;
+		pcInput++;
+		xLength--;
+
+		if( pxConsole->xReceivingFrame != pdFALSE )
+		{
+			if( ( xTaskGetTickCount() - pxConsole->xFrameReceiver.xLastByteTime ) > frameRECEIVE_TIMEOUT )
+			{
+				/* The rest of the frame never arrived.  Treat this as
+				the start of new input. */
+				pxConsole->xReceivingFrame = pdFALSE;
+			}
+			else
+			{
+				pxConsole->xFrameReceiver.xLastByteTime = xTaskGetTickCount();
+				if( xCommandFrameReceive( &( pxConsole->xFrameReceiver ), ( uint8_t ) cRxedChar ) != pdFALSE )
+				{
+					pxConsole->xReceivingFrame = pdFALSE;
+					prvExecuteFrame( pxConsole );
+				}
+				continue;
+			}
+		}
+
+		/* A frame can only start where a command line could, so a stray
+		SOH typed in the middle of a line is just ignored.  Frames are not
+		echoed. */
+		if( ( cRxedChar == frameSOH ) && ( pxConsole->xFramesEnabled != pdFALSE ) && ( pxConsole->xInputLength == 0 ) )
+		{
+			pxConsole->xReceivingFrame = pdTRUE;
+			pxConsole->xFrameReceiver.xReceived = 0;
+			pxConsole->xFrameReceiver.xLastByteTime = xTaskGetTickCount();
+			pxConsole->cLastRxedChar = 0;
+			continue;
+		}
+
+		/* Terminals and scripts commonly end lines with "\r\n".  Treat the
+		pair as a single end of line, otherwise the '\n' would be seen as
+		an empty line and execute the command a second time. */
+		if( ( cRxedChar == '\n' ) && ( pxConsole->cLastRxedChar == '\r' ) )
+		{
+			pxConsole->cLastRxedChar = cRxedChar;
+			continue;
+		}
+		pxConsole->cLastRxedChar = cRxedChar;
+
+		if( pxConsole->ucEscapeState == cmdESCAPE_STARTED )
+		{
+			/* Only the sequences sent by the editing keys are recognised,
+			anything else after the ESC is dropped. */
+			pxConsole->ucEscapeParameter = 0;
+			pxConsole->ucEscapeState = ( ( cRxedChar == '[' ) || ( cRxedChar == 'O' ) ) ? cmdESCAPE_SEQUENCE : cmdESCAPE_NONE;
+			continue;
+		}
+
+		if( pxConsole->ucEscapeState == cmdESCAPE_SEQUENCE )
+		{
+			if( ( cRxedChar >= '0' ) && ( cRxedChar <= '9' ) )
+			{
+				if( pxConsole->ucEscapeParameter < 100 )
+				{
+					pxConsole->ucEscapeParameter = ( uint8_t ) ( ( pxConsole->ucEscapeParameter * 10 ) + ( cRxedChar - '0' ) );
+				}
+			}
+			else if( ( cRxedChar >= 0x40 ) && ( cRxedChar <= 0x7E ) )
+			{
+				pxConsole->ucEscapeState = cmdESCAPE_NONE;
+				prvEscapeSequence( pxConsole, cRxedChar, pxConsole->ucEscapeParameter );
+			}
+			continue;
+		}
+
+		/* Was it the end of the line? */
+		if( cRxedChar == '\n' || cRxedChar == '\r' )
+		{
+			/* Echo the end of the line, from the end of the line. */
+			prvMoveCursorTo( pxConsole, pxConsole->xInputLength );
+			prvWrite( pxConsole, &cRxedChar, sizeof( cRxedChar ) );
+			prvExecuteLine( pxConsole );
+		}
+		else
+		{
+			prvEditLine( pxConsole, cRxedChar );
+		}
+	}
+
+	/* The echoes for the whole burst are sent in one go. */
+	prvFlush( pxConsole );
+
+	xSemaphoreGive( pxConsole->xLock );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleInputLost( CommandConsole_t *pxConsole )
+{
+	pxConsole->xReceivingFrame = pdFALSE;
+	pxConsole->ucEscapeState = cmdESCAPE_NONE;
+	pxConsole->cLastRxedChar = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEditLine( CommandConsole_t *pxConsole, char cRxedChar )
+{
+	if( cRxedChar == cmdASCII_ESC )
+	{
+		pxConsole->ucEscapeState = cmdESCAPE_STARTED;
+	}
+	else if( ( cRxedChar == '\b' ) || ( cRxedChar == cmdASCII_DEL ) )
+	{
+		/* Backspace was pressed.  Erase the character before the cursor - if
+		any. */
+		if( pxConsole->xCursor > 0 )
+		{
+			prvMoveCursorTo( pxConsole, pxConsole->xCursor - 1 );
+			prvDeleteCharacter( pxConsole );
+		}
+	}
+	else if( cRxedChar == '\t' )
+	{
+		prvCompleteCommand( pxConsole );
+	}
+	else if( ( cRxedChar >= ' ' ) && ( cRxedChar <= '~' ) )
+	{
+		/* A character was entered.  Add it to the string entered so far.  When
+		a \n is entered the complete string will be passed to the command
+		interpreter. */
+		prvInsertCharacter( pxConsole, cRxedChar );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvEscapeSequence( CommandConsole_t *pxConsole, char cFinal, uint8_t ucParameter )
+{
+const char *pcLine;
+
+	switch( cFinal )
+	{
+		case 'A':
+			/* Up: the line before the one shown. */
+			pcLine = prvHistoryEntry( pxConsole, pxConsole->uxHistoryBrowse + 1 );
+			if( pcLine != NULL )
+			{
+				pxConsole->uxHistoryBrowse++;
+				prvReplaceLine( pxConsole, pcLine );
+			}
+			break;
+
+		case 'B':
+			/* Down: the line after the one shown, or an empty line after the
+			latest. */
+			if( pxConsole->uxHistoryBrowse > 0 )
+			{
+				pxConsole->uxHistoryBrowse--;
+				pcLine = ( pxConsole->uxHistoryBrowse > 0 ) ? prvHistoryEntry( pxConsole, pxConsole->uxHistoryBrowse ) : "";
+				prvReplaceLine( pxConsole, pcLine );
+			}
+			break;
+
+		case 'C':
+			if( pxConsole->xCursor < pxConsole->xInputLength )
+			{
+				prvMoveCursorTo( pxConsole, pxConsole->xCursor + 1 );
+			}
+			break;
+
+		case 'D':
+			if( pxConsole->xCursor > 0 )
+			{
+				prvMoveCursorTo( pxConsole, pxConsole->xCursor - 1 );
+			}
+			break;
+
+		case 'H':
+			prvMoveCursorTo( pxConsole, 0 );
+			break;
+
+		case 'F':
+			prvMoveCursorTo( pxConsole, pxConsole->xInputLength );
+			break;
+
+		case '~':
+			/* VT220 style keys: 1 or 7 home, 4 or 8 end, 3 delete. */
+			if( ( ucParameter == 1 ) || ( ucParameter == 7 ) )
+			{
+				prvMoveCursorTo( pxConsole, 0 );
+			}
+			else if( ( ucParameter == 4 ) || ( ucParameter == 8 ) )
+			{
+				prvMoveCursorTo( pxConsole, pxConsole->xInputLength );
+			}
+			else if( ucParameter == 3 )
+			{
+				prvDeleteCharacter( pxConsole );
+			}
+			break;
+
+		default:
+			/* Not an editing key. */
+			break;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertCharacter( CommandConsole_t *pxConsole, char cCharacter )
+{
+	/* The last byte is kept free for the terminating NULL. */
+	if( pxConsole->xInputLength >= ( cmdMAX_INPUT_SIZE - 1 ) )
+	{
+		prvWrite( pxConsole, "\a", 1 );
+		return;
+	}
+
+	memmove( &( pxConsole->cInputString[ pxConsole->xCursor + 1 ] ), &( pxConsole->cInputString[ pxConsole->xCursor ] ), pxConsole->xInputLength - pxConsole->xCursor );
+	pxConsole->cInputString[ pxConsole->xCursor ] = cCharacter;
+	pxConsole->xInputLength++;
+	pxConsole->cInputString[ pxConsole->xInputLength ] = '\0';
+
+	/* Echo the character back, then the rest of the line it was inserted
+	into. */
+	prvWrite( pxConsole, &cCharacter, sizeof( cCharacter ) );
+	pxConsole->xCursor++;
+	prvRedrawTail( pxConsole, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteCharacter( CommandConsole_t *pxConsole )
+{
+	if( pxConsole->xCursor < pxConsole->xInputLength )
+	{
+		memmove( &( pxConsole->cInputString[ pxConsole->xCursor ] ), &( pxConsole->cInputString[ pxConsole->xCursor + 1 ] ), pxConsole->xInputLength - pxConsole->xCursor );
+		pxConsole->xInputLength--;
+		prvRedrawTail( pxConsole, 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMoveCursorTo( CommandConsole_t *pxConsole, size_t xPosition )
+{
+	if( xPosition < pxConsole->xCursor )
+	{
+		prvCursorLeft( pxConsole, pxConsole->xCursor - xPosition );
+	}
+	else if( xPosition > pxConsole->xCursor )
+	{
+		/* Writing the characters again moves the cursor right on any
+		terminal. */
+		prvWrite( pxConsole, &( pxConsole->cInputString[ pxConsole->xCursor ] ), xPosition - pxConsole->xCursor );
+	}
+
+	pxConsole->xCursor = xPosition;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplaceLine( CommandConsole_t *pxConsole, const char *pcLine )
+{
+	prvMoveCursorTo( pxConsole, 0 );
+
+	strncpy( pxConsole->cInputString, pcLine, cmdMAX_INPUT_SIZE - 1 );
+	pxConsole->cInputString[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+	pxConsole->xInputLength = strlen( pxConsole->cInputString );
+
+	/* Write the new line over the old one, then erase what is left of the
+	old line. */
+	prvWrite( pxConsole, pxConsole->cInputString, pxConsole->xInputLength );
+	pxConsole->xCursor = pxConsole->xInputLength;
+	prvWrite( pxConsole, "\x1b[K", 3 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCursorLeft( CommandConsole_t *pxConsole, size_t xColumns )
+{
+char cSequence[ 8 ];
+size_t xLength;
+
+	if( xColumns == 1 )
+	{
+		prvWrite( pxConsole, "\b", 1 );
+	}
+	else if( xColumns > 1 )
+	{
+		xLength = ( size_t ) snprintf( cSequence, sizeof( cSequence ), "\x1b[%uD", ( unsigned int ) xColumns );
+		prvWrite( pxConsole, cSequence, xLength );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvRedrawTail( CommandConsole_t *pxConsole, size_t xErase )
+{
+size_t x, xTail = pxConsole->xInputLength - pxConsole->xCursor;
+
+	prvWrite( pxConsole, &( pxConsole->cInputString[ pxConsole->xCursor ] ), xTail );
+	for( x = 0; x < xErase; x++ )
+	{
+		prvWrite( pxConsole, " ", 1 );
+	}
+	prvCursorLeft( pxConsole, xTail + xErase );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHistoryAdd( CommandConsole_t *pxConsole, const char *pcLine )
+{
+size_t xLength = strlen( pcLine ) + 1, xOldest;
+const char *pcLatest = prvHistoryEntry( pxConsole, 1 );
+
+	if( ( xLength == 1 ) || ( xLength > cmdHISTORY_SIZE ) || ( ( pcLatest != NULL ) && ( strcmp( pcLatest, pcLine ) == 0 ) ) )
+	{
+		return;
+	}
+
+	/* Drop the oldest lines until there is space. */
+	while( ( pxConsole->xHistoryUsed + xLength ) > cmdHISTORY_SIZE )
+	{
+		xOldest = strlen( pxConsole->cHistory ) + 1;
+		memmove( pxConsole->cHistory, &( pxConsole->cHistory[ xOldest ] ), pxConsole->xHistoryUsed - xOldest );
+		pxConsole->xHistoryUsed -= xOldest;
+	}
+
+	memcpy( &( pxConsole->cHistory[ pxConsole->xHistoryUsed ] ), pcLine, xLength );
+	pxConsole->xHistoryUsed += xLength;
+}
+/*-----------------------------------------------------------*/
+
+static const char *prvHistoryEntry( CommandConsole_t *pxConsole, UBaseType_t uxBack )
+{
+size_t xStart = pxConsole->xHistoryUsed;
+
+	while( uxBack > 0 )
+	{
+		if( xStart == 0 )
+		{
+			return NULL;
+		}
+
+		/* Step back over the terminating NULL of the line before, then to its
+		start. */
+		xStart--;
+		while( ( xStart > 0 ) && ( pxConsole->cHistory[ xStart - 1 ] != '\0' ) )
+		{
+			xStart--;
+		}
+		uxBack--;
+	}
+
+	return ( xStart < pxConsole->xHistoryUsed ) ? &( pxConsole->cHistory[ xStart ] ) : NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCompleteCommand( CommandConsole_t *pxConsole )
+{
+const CLI_Command_Definition_t *pxCommand;
+const char *pcFirst = NULL;
+size_t xTyped = pxConsole->xInputLength, xCommon = 0, x;
+UBaseType_t uxPosition, uxMatches = 0;
+
+	/* Only the command itself is completed. */
+	if( ( pxConsole->xCursor != xTyped ) || ( memchr( pxConsole->cInputString, ' ', xTyped ) != NULL ) )
+	{
+		prvWrite( pxConsole, "\a", 1 );
+		return;
+	}
+
+	/* The index is sorted, so the matching commands are next to each other.
+	Find how much of the command they have in common. */
+	for( uxPosition = 0; ( pxCommand = FreeRTOS_CLIGetCommand( uxPosition ) ) != NULL; uxPosition++ )
+	{
+		if( strncmp( pxCommand->pcCommand, pxConsole->cInputString, xTyped ) != 0 )
+		{
+			if( uxMatches > 0 )
+			{
+				break;
+			}
+			continue;
+		}
+
+		if( uxMatches == 0 )
+		{
+			pcFirst = pxCommand->pcCommand;
+			xCommon = strlen( pcFirst );
+		}
+		else
+		{
+			for( x = xTyped; ( x < xCommon ) && ( pxCommand->pcCommand[ x ] == pcFirst[ x ] ); x++ )
+			{
+			}
+			xCommon = x;
+		}
+		uxMatches++;
+	}
+
+	if( uxMatches == 0 )
+	{
+		prvWrite( pxConsole, "\a", 1 );
+	}
+	else if( xCommon > xTyped )
+	{
+		for( x = xTyped; x < xCommon; x++ )
+		{
+			prvInsertCharacter( pxConsole, pcFirst[ x ] );
+		}
+
+		if( uxMatches == 1 )
+		{
+			prvInsertCharacter( pxConsole, ' ' );
+		}
+	}
+	else if( uxMatches > 1 )
+	{
+		/* Nothing more in common, so show the choices and the line again. */
+		prvWrite( pxConsole, pcNewLine, strlen( pcNewLine ) );
+		for( uxPosition = 0; ( pxCommand = FreeRTOS_CLIGetCommand( uxPosition ) ) != NULL; uxPosition++ )
+		{
+			if( strncmp( pxCommand->pcCommand, pxConsole->cInputString, xTyped ) == 0 )
+			{
+				prvWrite( pxConsole, pxCommand->pcCommand, strlen( pxCommand->pcCommand ) );
+				prvWrite( pxConsole, "  ", 2 );
+			}
+		}
+		prvWrite( pxConsole, "\r\n>", 3 );
+		prvWrite( pxConsole, pxConsole->cInputString, xTyped );
+	}
+	else
+	{
+		/* The command is already complete. */
+		prvInsertCharacter( pxConsole, ' ' );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecuteLine( CommandConsole_t *pxConsole )
+{
+	portBASE_TYPE xReturned;
+	char *pcOutputString = pxConsole->xSession.pcOutputBuffer;
+	const CLI_Command_Definition_t *pxCommand;
+	const char *pcNextCommand, *pcLastCommand;
+
+	/* Just to space the output from the input. */
+	prvWrite( pxConsole, pcNewLine, strlen( pcNewLine ) );
+
+	/* See if the command is empty, indicating that the last command is
+	to be executed again. */
+	pxConsole->uxHistoryBrowse = 0;
+	if( pxConsole->xInputLength == 0 )
+	{
+		/* Copy the last command back into the input string. */
+		pcLastCommand = prvHistoryEntry( pxConsole, 1 );
+		if( pcLastCommand != NULL )
+		{
+			strcpy( pxConsole->cInputString, pcLastCommand );
+		}
+	}
+	else
+	{
+		prvHistoryAdd( pxConsole, pxConsole->cInputString );
+	}
+
+	pxConsole->xOutputDropped = pdFALSE;
+
+	/* Commands that can take a long time are executed by a worker task, so
+	the console can be used while they run.  If no worker can take the
+	command it is executed here.  The commands of a batch are always executed
+	here, so they run in order. */
+	pxCommand = FreeRTOS_CLIFindCommand( pxConsole->cInputString );
+	if( ( pxCommand != NULL ) && ( ( pxCommand->ucFlags & cliCOMMAND_FLAG_ASYNC ) != 0 ) &&
+		( strchr( pxConsole->cInputString, ';' ) == NULL ) &&
+		( xCommandWorkerSubmit( pxConsole, pxConsole->cInputString ) == pdPASS ) )
+	{
+		pxConsole->xInputLength = 0;
+		pxConsole->xCursor = 0;
+		memset( pxConsole->cInputString, 0x00, cmdMAX_INPUT_SIZE );
+		prvWriteReference( pxConsole, pcBackgroundMessage, strlen( pcBackgroundMessage ) );
+		return;
+	}
+
+	pcNextCommand = pxConsole->cInputString;
+	do
+	{
+		pcNextCommand = FreeRTOS_CLINextCommand( pcNextCommand, pxConsole->cCommandString, cmdMAX_INPUT_SIZE );
+		if( ( pxConsole->cCommandString[ 0 ] == 0x00 ) && ( strchr( pxConsole->cInputString, ';' ) != NULL ) )
+		{
+			/* Nothing between two ';'. */
+			continue;
+		}
+
+		/* Pass the received command to the command interpreter.  The
+		command interpreter is called repeatedly until it returns pdFALSE
+		(indicating there is no more output) as it might generate more than
+		one string.  Once the command has used up its budget the rest of
+		it runs at the priority the task was created with. */
+		vCommandGovernorCommandStart( &( pxConsole->xGovernor ) );
+		do
+		{
+			/* Get the next output string from the command interpreter. */
+			pcOutputString[ 0 ] = 0x00;
+			xReturned = FreeRTOS_CLIProcessSessionCommand( &( pxConsole->xSession ), pxConsole->cCommandString );
+
+			/* Queue the generated string and let the transport start sending
+			it while the next string is generated.  The output buffer can
+			be reused as soon as the write returns. */
+			prvWriteOutput( pxConsole );
+			prvFlush( pxConsole );
+			vCommandGovernorCheck( &( pxConsole->xGovernor ) );
+
+		} while( xReturned != pdFALSE );
+		vCommandGovernorCommandEnd( &( pxConsole->xGovernor ) );
+	} while( pcNextCommand != NULL );
+
+	/* All the strings generated by the input command have been sent.
+	Clear the input string ready to receive the next command.  The
+	command that was just processed is in the history in case it is to be
+	processed again. */
+	pxConsole->xInputLength = 0;
+	pxConsole->xCursor = 0;
+	memset( pxConsole->cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+	/* Let the user know if the output was incomplete. */
+	if( pxConsole->xOutputDropped != pdFALSE )
+	{
+		prvWriteReference( pxConsole, pcOutputDroppedMessage, strlen( pcOutputDroppedMessage ) );
+	}
+
+	prvWriteReference( pxConsole, pcEndOfOutputMessage, strlen( pcEndOfOutputMessage ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecuteFrame( CommandConsole_t *pxConsole )
+{
+	const uint8_t *pucFrame = pxConsole->xFrameReceiver.ucFrame;
+	const uint8_t *pucPayload = &pucFrame[ frameHEADER_SIZE ];
+	size_t xPayloadLength = frameREAD16( &pucFrame[ frameLENGTH_OFFSET ] );
+	uint8_t ucSequence = pucFrame[ frameSEQUENCE_OFFSET ];
+	const CLI_Command_Definition_t *pxCommand;
+	uint8_t ucEntry[ 3 ];
+	uint16_t usID;
+	UBaseType_t uxPosition;
+	portBASE_TYPE xReturned;
+	char *pcOutputString = pxConsole->xSession.pcOutputBuffer;
+	uint8_t *pucCompressed = NULL;
+	size_t xOutputLength, xCompressedLength;
+	uint8_t ucStatus;
+
+	pxConsole->xOutputDropped = pdFALSE;
+	ucStatus = ucCommandFrameCheck( &( pxConsole->xFrameReceiver ) );
+
+	if( ucStatus == frameSTATUS_OK )
+	{
+		switch( pucFrame[ frameTYPE_OFFSET ] )
+		{
+			case frameREQUEST_EXECUTE:
+				if( xPayloadLength > frameMAX_REQUEST_PAYLOAD )
+				{
+					ucStatus = frameSTATUS_BAD_REQUEST;
+					break;
+				}
+
+				ucStatus = ucCommandFrameBuildCommandLine( pucPayload, xPayloadLength, pxConsole->cInputString, cmdMAX_INPUT_SIZE );
+				if( ucStatus != frameSTATUS_OK )
+				{
+					break;
+				}
+
+				/* The compressed output is only held until it is written, so
+				it uses a block rather than a buffer in every console.  If
+				there is none free the output is sent uncompressed, which the
+				client has to accept anyway. */
+				if( pxConsole->xCompressOutput != pdFALSE )
+				{
+					vCommandCompressReset( &( pxConsole->xCompressor ) );
+					pucCompressed = ( uint8_t * ) pvBlockPoolAllocate( pxConsole->xSession.xOutputBufferLength );
+				}
+
+				/* Run the command exactly as a typed command line, but send
+				each output string as a frame, straight from the output
+				buffer.  The client waits for the end frame anyway, so
+				background commands are executed here too.  Each frame is
+				checked, and maybe compressed, as a whole, so the output is
+				kept in the output buffer rather than referenced. */
+				FreeRTOS_CLISetMachineReadable( &( pxConsole->xSession ), pdTRUE );
+				FreeRTOS_CLISetAcceptsReferences( &( pxConsole->xSession ), pdFALSE );
+				vCommandGovernorCommandStart( &( pxConsole->xGovernor ) );
+				do
+				{
+					pcOutputString[ 0 ] = 0x00;
+					xReturned = FreeRTOS_CLIProcessSessionCommand( &( pxConsole->xSession ), pxConsole->cInputString );
+
+					if( pcOutputString[ 0 ] != 0x00 )
+					{
+						xOutputLength = strlen( pcOutputString );
+						xCompressedLength = 0;
+						if( pucCompressed != NULL )
+						{
+							xCompressedLength = xCommandCompress( &( pxConsole->xCompressor ), ( const uint8_t * ) pcOutputString, xOutputLength, pucCompressed );
+						}
+
+						if( xCompressedLength != 0 )
+						{
+							prvWriteFrame( pxConsole, frameRESPONSE_OUTPUT_COMPRESSED, ucSequence, NULL, 0, pucCompressed, xCompressedLength );
+						}
+						else
+						{
+							prvWriteFrame( pxConsole, frameRESPONSE_OUTPUT, ucSequence, NULL, 0, ( const uint8_t * ) pcOutputString, xOutputLength );
+						}
+						prvFlush( pxConsole );
+					}
+					vCommandGovernorCheck( &( pxConsole->xGovernor ) );
+				} while( xReturned != pdFALSE );
+				vCommandGovernorCommandEnd( &( pxConsole->xGovernor ) );
+				FreeRTOS_CLISetMachineReadable( &( pxConsole->xSession ), pdFALSE );
+				FreeRTOS_CLISetAcceptsReferences( &( pxConsole->xSession ), pdTRUE );
+				vBlockPoolFree( pucCompressed );
+
+				/* Framed commands are not repeated by an empty line. */
+				memset( pxConsole->cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+				if( pxConsole->xOutputDropped != pdFALSE )
+				{
+					ucStatus = frameSTATUS_OUTPUT_DROPPED;
+				}
+				break;
+
+			case frameREQUEST_LIST:
+				for( uxPosition = 0; ( pxCommand = FreeRTOS_CLIGetCommand( uxPosition ) ) != NULL; uxPosition++ )
+				{
+					usID = usCommandFrameCommandID( pxCommand->pcCommand );
+					ucEntry[ 0 ] = ( uint8_t ) usID;
+					ucEntry[ 1 ] = ( uint8_t ) ( usID >> 8 );
+					ucEntry[ 2 ] = ( uint8_t ) pxCommand->cExpectedNumberOfParameters;
+					prvWriteFrame( pxConsole, frameRESPONSE_COMMAND, ucSequence, ucEntry, sizeof( ucEntry ), ( const uint8_t * ) pxCommand->pcCommand, strlen( pxCommand->pcCommand ) );
+				}
+				break;
+
+			case frameREQUEST_OPTIONS:
+				if( ( xPayloadLength != 1 ) || ( ( pucPayload[ 0 ] & ~frameOPTION_COMPRESS ) != 0 ) )
+				{
+					ucStatus = frameSTATUS_BAD_REQUEST;
+					break;
+				}
+				pxConsole->xCompressOutput = ( ( pucPayload[ 0 ] & frameOPTION_COMPRESS ) != 0 ) ? pdTRUE : pdFALSE;
+				break;
+
+			case frameREQUEST_WRITE:
+				/* The data is copied before the request is answered, and
+				programmed while the next one is received. */
+				if( xPayloadLength <= frameWRITE_OFFSET_SIZE )
+				{
+					ucStatus = frameSTATUS_BAD_REQUEST;
+					break;
+				}
+				if( xFirmwareUpdateWrite( frameREAD32( pucPayload ), &pucPayload[ frameWRITE_OFFSET_SIZE ], xPayloadLength - frameWRITE_OFFSET_SIZE ) != pdPASS )
+				{
+					ucStatus = frameSTATUS_WRITE_FAILED;
+				}
+				break;
+
+			default:
+				ucStatus = frameSTATUS_UNKNOWN_TYPE;
+				break;
+		}
+	}
+
+	/* Every request is answered, so the client never has to time out. */
+	prvWriteFrame( pxConsole, frameRESPONSE_END, ucSequence, NULL, 0, &ucStatus, sizeof( ucStatus ) );
+	prvFlush( pxConsole );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandConsoleWriteBackground( CommandConsole_t *pxConsole, uint32_t ulGeneration, const char *pcBuffer, size_t xBufferLength )
+{
+	return xCommandConsoleWriteBackgroundPrefixed( pxConsole, ulGeneration, "", pcBuffer, xBufferLength );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandConsoleWriteBackgroundPrefixed( CommandConsole_t *pxConsole, uint32_t ulGeneration, const char *pcPrefix, const char *pcBuffer, size_t xBufferLength )
+{
+	BaseType_t xReturn = pdFAIL;
+	size_t xPrefixLength = strlen( pcPrefix );
+
+	xSemaphoreTake( pxConsole->xLock, portMAX_DELAY );
+	if( pxConsole->ulGeneration == ulGeneration )
+	{
+		xReturn = pdPASS;
+		if( xPrefixLength > 0 )
+		{
+			xReturn = pxConsole->pxTransport->pxWrite( pxConsole->pvTransport, pcPrefix, xPrefixLength );
+		}
+		if( pxConsole->pxTransport->pxWrite( pxConsole->pvTransport, pcBuffer, xBufferLength ) != pdPASS )
+		{
+			xReturn = pdFAIL;
+		}
+		prvFlush( pxConsole );
+	}
+	xSemaphoreGive( pxConsole->xLock );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vCommandConsoleBackgroundFinished( CommandConsole_t *pxConsole, uint32_t ulGeneration, BaseType_t xOutputDropped )
+{
+	if( xOutputDropped != pdFALSE )
+	{
+		( void ) xCommandConsoleWriteBackground( pxConsole, ulGeneration, pcOutputDroppedMessage, strlen( pcOutputDroppedMessage ) );
+	}
+	( void ) xCommandConsoleWriteBackground( pxConsole, ulGeneration, pcBackgroundFinishedMessage, strlen( pcBackgroundFinishedMessage ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteFrame( CommandConsole_t *pxConsole, uint8_t ucType, uint8_t ucSequence, const uint8_t *pucPrefix, size_t xPrefixLength, const uint8_t *pucPayload, size_t xLength )
+{
+	uint8_t ucHeader[ frameHEADER_SIZE ];
+	uint8_t ucCRC[ frameCRC_SIZE ];
+	uint16_t usCRC;
+
+	vCommandFrameHeader( ucHeader, ucType, ucSequence, xPrefixLength + xLength );
+	usCRC = usCommandFrameCRC( 0xFFFF, &ucHeader[ frameTYPE_OFFSET ], frameHEADER_SIZE - frameTYPE_OFFSET );
+	usCRC = usCommandFrameCRC( usCRC, pucPrefix, xPrefixLength );
+	usCRC = usCommandFrameCRC( usCRC, pucPayload, xLength );
+	ucCRC[ 0 ] = ( uint8_t ) usCRC;
+	ucCRC[ 1 ] = ( uint8_t ) ( usCRC >> 8 );
+
+	prvWrite( pxConsole, ( const char * ) ucHeader, sizeof( ucHeader ) );
+	prvWrite( pxConsole, ( const char * ) pucPrefix, xPrefixLength );
+	prvWrite( pxConsole, ( const char * ) pucPayload, xLength );
+	prvWrite( pxConsole, ( const char * ) ucCRC, sizeof( ucCRC ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWrite( CommandConsole_t *pxConsole, const char *pcBuffer, size_t xBufferLength )
+{
+	if( xBufferLength > 0 )
+	{
+		if( pxConsole->pxTransport->pxWrite( pxConsole->pvTransport, pcBuffer, xBufferLength ) != pdPASS )
+		{
+			pxConsole->xOutputDropped = pdTRUE;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteReference( CommandConsole_t *pxConsole, const char *pcBuffer, size_t xBufferLength )
+{
+	if( pxConsole->pxTransport->pxWriteReference == NULL )
+	{
+		prvWrite( pxConsole, pcBuffer, xBufferLength );
+	}
+	else if( xBufferLength > 0 )
+	{
+		if( pxConsole->pxTransport->pxWriteReference( pxConsole->pvTransport, pcBuffer, xBufferLength ) != pdPASS )
+		{
+			pxConsole->xOutputDropped = pdTRUE;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteOutput( CommandConsole_t *pxConsole )
+{
+	const CLI_Output_Chunk_t *pxChunks;
+	UBaseType_t uxChunks, x;
+
+	uxChunks = FreeRTOS_CLIGetOutputChunks( &( pxConsole->xSession ), &pxChunks );
+	if( uxChunks == 0 )
+	{
+		prvWrite( pxConsole, pxConsole->xSession.pcOutputBuffer, strlen( pxConsole->xSession.pcOutputBuffer ) );
+	}
+
+	for( x = 0; x < uxChunks; x++ )
+	{
+		if( pxChunks[ x ].ucReference != pdFALSE )
+		{
+			prvWriteReference( pxConsole, pxChunks[ x ].pcData, pxChunks[ x ].usLength );
+		}
+		else
+		{
+			prvWrite( pxConsole, pxChunks[ x ].pcData, pxChunks[ x ].usLength );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlush( CommandConsole_t *pxConsole )
+{
+	if( pxConsole->pxTransport->pxFlush != NULL )
+	{
+		pxConsole->pxTransport->pxFlush( pxConsole->pvTransport );
+	}
+}
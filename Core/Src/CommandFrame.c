@@ -0,0 +1,229 @@
+/*
+ * CommandFrame.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandFrame.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+/*
+ * Append xLength bytes to the command line of *pxUsed bytes.  Returns pdFAIL if
+ * they, and the terminating NULL, do not fit.
+ */
+static BaseType_t prvAppend( char *pcLine, size_t xLineLength, size_t *pxUsed, const char *pcText, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandFrameReceive( CommandFrameReceiver_t *pxReceiver, uint8_t ucByte )
+{
+size_t xFrameLength;
+
+	/* The SOH is the first byte of the frame. */
+	if( pxReceiver->xReceived == 0 )
+	{
+		pxReceiver->ucFrame[ 0 ] = frameSOH;
+		pxReceiver->xReceived = 1;
+	}
+
+	if( pxReceiver->xReceived < sizeof( pxReceiver->ucFrame ) )
+	{
+		pxReceiver->ucFrame[ pxReceiver->xReceived ] = ucByte;
+	}
+	pxReceiver->xReceived++;
+
+	if( pxReceiver->xReceived < frameHEADER_SIZE )
+	{
+		return pdFALSE;
+	}
+
+	xFrameLength = frameHEADER_SIZE + frameREAD16( &( pxReceiver->ucFrame[ frameLENGTH_OFFSET ] ) ) + frameCRC_SIZE;
+
+	return ( pxReceiver->xReceived >= xFrameLength ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucCommandFrameCheck( const CommandFrameReceiver_t *pxReceiver )
+{
+size_t xPayloadLength = frameREAD16( &( pxReceiver->ucFrame[ frameLENGTH_OFFSET ] ) );
+const uint8_t *pucCRC;
+uint16_t usCRC;
+
+	if( xPayloadLength > frameMAX_RECEIVE_PAYLOAD )
+	{
+		return frameSTATUS_BAD_REQUEST;
+	}
+
+	usCRC = usCommandFrameCRC( 0xFFFF, &( pxReceiver->ucFrame[ frameTYPE_OFFSET ] ), ( frameHEADER_SIZE - frameTYPE_OFFSET ) + xPayloadLength );
+	pucCRC = &( pxReceiver->ucFrame[ frameHEADER_SIZE + xPayloadLength ] );
+
+	return ( usCRC == frameREAD16( pucCRC ) ) ? frameSTATUS_OK : frameSTATUS_BAD_CRC;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucCommandFrameBuildCommandLine( const uint8_t *pucPayload, size_t xLength, char *pcLine, size_t xLineLength )
+{
+const CLI_Command_Definition_t *pxCommand = NULL;
+UBaseType_t uxPosition;
+uint16_t usID;
+size_t xOffset, xUsed = 0, xValueLength, x;
+uint8_t ucTag;
+char cNumber[ 12 ];
+int32_t lValue;
+BaseType_t xQuote;
+UBaseType_t uxParameters = 0;
+
+	if( xLength < 2 )
+	{
+		return frameSTATUS_BAD_REQUEST;
+	}
+
+	usID = frameREAD16( pucPayload );
+	for( uxPosition = 0; ( pxCommand = FreeRTOS_CLIGetCommand( uxPosition ) ) != NULL; uxPosition++ )
+	{
+		if( usCommandFrameCommandID( pxCommand->pcCommand ) == usID )
+		{
+			break;
+		}
+	}
+
+	if( pxCommand == NULL )
+	{
+		return frameSTATUS_UNKNOWN_COMMAND;
+	}
+
+	if( prvAppend( pcLine, xLineLength, &xUsed, pxCommand->pcCommand, strlen( pxCommand->pcCommand ) ) != pdPASS )
+	{
+		return frameSTATUS_BAD_REQUEST;
+	}
+
+	/* Turn each parameter back into text, so the command handler gets the
+	same command line it would have been given by the text console. */
+	for( xOffset = 2; xOffset < xLength; xOffset += 2 + xValueLength )
+	{
+		if( ( xOffset + 2 ) > xLength )
+		{
+			return frameSTATUS_BAD_REQUEST;
+		}
+
+		ucTag = pucPayload[ xOffset ];
+		xValueLength = pucPayload[ xOffset + 1 ];
+		if( ( xOffset + 2 + xValueLength ) > xLength )
+		{
+			return frameSTATUS_BAD_REQUEST;
+		}
+
+		if( prvAppend( pcLine, xLineLength, &xUsed, " ", 1 ) != pdPASS )
+		{
+			return frameSTATUS_BAD_REQUEST;
+		}
+		uxParameters++;
+
+		if( ( ucTag == frameTAG_INT32 ) && ( xValueLength == 4 ) )
+		{
+			lValue = ( int32_t ) ( frameREAD16( &pucPayload[ xOffset + 2 ] ) | ( ( uint32_t ) frameREAD16( &pucPayload[ xOffset + 4 ] ) << 16 ) );
+			snprintf( cNumber, sizeof( cNumber ), "%ld", ( long ) lValue );
+			if( prvAppend( pcLine, xLineLength, &xUsed, cNumber, strlen( cNumber ) ) != pdPASS )
+			{
+				return frameSTATUS_BAD_REQUEST;
+			}
+		}
+		else if( ucTag == frameTAG_STRING )
+		{
+			/* Strings that are empty or contain spaces are quoted.  Quotes and
+			control characters cannot be represented on a command line. */
+			xQuote = ( xValueLength == 0 ) ? pdTRUE : pdFALSE;
+			for( x = 0; x < xValueLength; x++ )
+			{
+				if( ( pucPayload[ xOffset + 2 + x ] < ' ' ) || ( pucPayload[ xOffset + 2 + x ] > '~' ) || ( pucPayload[ xOffset + 2 + x ] == '"' ) )
+				{
+					return frameSTATUS_BAD_REQUEST;
+				}
+				if( pucPayload[ xOffset + 2 + x ] == ' ' )
+				{
+					xQuote = pdTRUE;
+				}
+			}
+
+			if( ( ( xQuote != pdFALSE ) && ( prvAppend( pcLine, xLineLength, &xUsed, "\"", 1 ) != pdPASS ) ) ||
+				( prvAppend( pcLine, xLineLength, &xUsed, ( const char * ) &pucPayload[ xOffset + 2 ], xValueLength ) != pdPASS ) ||
+				( ( xQuote != pdFALSE ) && ( prvAppend( pcLine, xLineLength, &xUsed, "\"", 1 ) != pdPASS ) ) )
+			{
+				return frameSTATUS_BAD_REQUEST;
+			}
+		}
+		else
+		{
+			return frameSTATUS_BAD_REQUEST;
+		}
+	}
+
+	/* Reported in the status rather than by the text the command interpreter
+	would output. */
+	if( ( pxCommand->cExpectedNumberOfParameters >= 0 ) && ( uxParameters != ( UBaseType_t ) pxCommand->cExpectedNumberOfParameters ) )
+	{
+		return frameSTATUS_BAD_REQUEST;
+	}
+
+	return frameSTATUS_OK;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usCommandFrameCommandID( const char *pcCommand )
+{
+	return usCommandFrameCRC( 0xFFFF, ( const uint8_t * ) pcCommand, strlen( pcCommand ) );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usCommandFrameCRC( uint16_t usCRC, const uint8_t *pucData, size_t xLength )
+{
+UBaseType_t uxBit;
+
+	/* CRC-16/CCITT-FALSE, polynomial 0x1021, calculated a bit at a time as
+	frames are short. */
+	while( xLength > 0 )
+	{
+		usCRC ^= ( uint16_t ) ( *pucData << 8 );
+		for( uxBit = 0; uxBit < 8; uxBit++ )
+		{
+			usCRC = ( ( usCRC & 0x8000 ) != 0 ) ? ( uint16_t ) ( ( usCRC << 1 ) ^ 0x1021 ) : ( uint16_t ) ( usCRC << 1 );
+		}
+
+		pucData++;
+		xLength--;
+	}
+
+	return usCRC;
+}
+/*-----------------------------------------------------------*/
+
+void vCommandFrameHeader( uint8_t *pucHeader, uint8_t ucType, uint8_t ucSequence, size_t xLength )
+{
+	pucHeader[ 0 ] = frameSOH;
+	pucHeader[ frameTYPE_OFFSET ] = ucType;
+	pucHeader[ frameSEQUENCE_OFFSET ] = ucSequence;
+	pucHeader[ frameLENGTH_OFFSET ] = ( uint8_t ) xLength;
+	pucHeader[ frameLENGTH_OFFSET + 1 ] = ( uint8_t ) ( xLength >> 8 );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppend( char *pcLine, size_t xLineLength, size_t *pxUsed, const char *pcText, size_t xLength )
+{
+	if( ( *pxUsed + xLength ) >= xLineLength )
+	{
+		return pdFAIL;
+	}
+
+	memcpy( &pcLine[ *pxUsed ], pcText, xLength );
+	*pxUsed += xLength;
+	pcLine[ *pxUsed ] = 0x00;
+
+	return pdPASS;
+}
@@ -0,0 +1,129 @@
+/*
+ * CommandGovernor.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandGovernor.h"
+
+#include "RunTimeStats.h"
+
+static volatile uint32_t ulBudget = governorCOMMAND_BUDGET_US;
+
+/* Updated by every console, so only accessed in critical sections. */
+static CommandGovernorStats_t xStats;
+
+/*
+ * Return the CPU time the calling task has used, in microseconds.
+ */
+static uint32_t prvTaskRunTime( void );
+
+/*
+ * The priority the task is boosted to, which is never below the priority it
+ * was created with.
+ */
+static UBaseType_t prvBoostPriority( const CommandGovernor_t *pxGovernor );
+
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorStart( CommandGovernor_t *pxGovernor )
+{
+	if( pxGovernor->xStarted == pdFALSE )
+	{
+		pxGovernor->uxBasePriority = uxTaskPriorityGet( NULL );
+		pxGovernor->xStarted = pdTRUE;
+	}
+
+	pxGovernor->xThrottled = pdFALSE;
+	vTaskPrioritySet( NULL, prvBoostPriority( pxGovernor ) );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorCommandStart( CommandGovernor_t *pxGovernor )
+{
+	pxGovernor->ulCommandStart = prvTaskRunTime();
+	pxGovernor->xThrottled = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorCheck( CommandGovernor_t *pxGovernor )
+{
+	if( pxGovernor->xThrottled != pdFALSE )
+	{
+		return;
+	}
+
+	if( ( prvTaskRunTime() - pxGovernor->ulCommandStart ) > ulBudget )
+	{
+		pxGovernor->xThrottled = pdTRUE;
+		vTaskPrioritySet( NULL, pxGovernor->uxBasePriority );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorCommandEnd( CommandGovernor_t *pxGovernor )
+{
+uint32_t ulUsed = prvTaskRunTime() - pxGovernor->ulCommandStart;
+
+	taskENTER_CRITICAL();
+	{
+		xStats.ulCommands++;
+		if( pxGovernor->xThrottled != pdFALSE )
+		{
+			xStats.ulThrottled++;
+		}
+		if( ulUsed > xStats.ulLongest )
+		{
+			xStats.ulLongest = ulUsed;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( pxGovernor->xThrottled != pdFALSE )
+	{
+		pxGovernor->xThrottled = pdFALSE;
+		vTaskPrioritySet( NULL, prvBoostPriority( pxGovernor ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorSetBudget( uint32_t ulMicroseconds )
+{
+	ulBudget = ulMicroseconds;
+}
+/*-----------------------------------------------------------*/
+
+void vCommandGovernorGetStats( CommandGovernorStats_t *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+	}
+	taskEXIT_CRITICAL();
+
+	pxStats->ulBudget = ulBudget;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvTaskRunTime( void )
+{
+TaskStatus_t xStatus;
+
+	/* The run time of a task is only brought up to date when it is switched
+	out, so yield first.  The task is the only one ready at its priority most
+	of the time, so it carries straight on. */
+	taskYIELD();
+	vTaskGetInfo( NULL, &xStatus, pdFALSE, eRunning );
+
+	/* The counter wraps at 2^32 periods, so the microseconds wrap at 2^32
+	too, and the differences taken from them stay right. */
+	return ( uint32_t ) xStatus.ulRunTimeCounter * runtimeCOUNTER_PERIOD_US;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvBoostPriority( const CommandGovernor_t *pxGovernor )
+{
+	return ( pxGovernor->uxBasePriority > governorBOOST_PRIORITY ) ? pxGovernor->uxBasePriority : governorBOOST_PRIORITY;
+}
+/*-----------------------------------------------------------*/
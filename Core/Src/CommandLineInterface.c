@@ -12,353 +12,2835 @@
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "timers.h"
 
 /* Standard includes. */
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* FreeRTOS+CLI includes. */
 #include "FreeRTOS_CLI.h"
+#include "CommandConsole.h"
 
 #include "stm32f7xx_hal.h"
+#include "MemoryLayout.h"
+#include "TraceLog.h"
+#include "Latency.h"
+#include "BlockPool.h"
+#include "CommandWatch.h"
+#include "CommandWriter.h"
+#include "ClockProfile.h"
+#include "ConfigStore.h"
+#include "FirmwareUpdate.h"
+#include "CommandGovernor.h"
+
+/* Dimensions the circular buffer into which the USART3 RX DMA stream writes
+received characters.  The task is woken on the idle line, half transfer and
+transfer complete events, so the buffer only has to absorb the characters that
+arrive while the task is busy executing a command, or is stalled by a flash
+erase.  That is at most one firmware upload frame, see FirmwareUpdate.h. */
+#define cmdRX_DMA_BUFFER_SIZE		1024
+
+/* How long, in ticks, to wait before trying again when the DMA reception could
+not be started. */
+#define cmdRX_RESTART_DELAY			( 10 / portTICK_PERIOD_MS )
+
+/* Dimensions the ring buffer through which all console output is passed to the
+USART3 TX DMA stream.  Echoes, newlines and command output are appended to the
+ring and sent in as few DMA transfers as possible. */
+#define cmdTX_BUFFER_SIZE			1024
+
+/* The maximum time in ticks to wait for the UART to free space in the TX ring
+buffer before the remaining output is dropped and counted as an overflow. */
+#define cmdMAX_TX_WAIT				( 100 / portTICK_PERIOD_MS )
+
+/* The number of references to output that is sent in place, see
+prvSendReference(), that can be queued for the USART3 TX DMA stream.  Shorter
+references are copied to the TX ring buffer, as a DMA transfer of their own
+would take longer to set up than the copy. */
+#define cmdTX_REFERENCES			16
+#define cmdTX_MIN_REFERENCE			32
+
+/* The number of tasks more than uxTaskGetNumberOfTasks() returned that a task
+snapshot has room for. */
+#define cmdSNAPSHOT_SPARE_TASKS		2
+
+/* stack-stats marks the tasks with less stack than this left, in words, as
+close to overflowing. */
+#define cmdSTACK_LOW_WATER_MARK		32
+
+/* The number of times bench times each benchmark, unless told otherwise, and
+the most it can be told to. */
+#define cmdBENCH_ITERATIONS			1000
+#define cmdBENCH_MAX_ITERATIONS		100000UL
+
+/* The size of the output buffer of the session the dispatch benchmark executes
+its command in. */
+#define cmdBENCH_OUTPUT_SIZE		64
+
+/* The maximum time in ticks clock waits for the output already queued to be
+sent before it changes the clocks, which also changes the baud rate while the
+switch is in progress. */
+#define cmdCLOCK_DRAIN_WAIT			( 200 / portTICK_PERIOD_MS )
+
+/* After baud switches the UART it goes back to the previous settings unless a
+carriage return arrives at the new rate within this time, so a rate the
+terminal cannot follow does not leave the console unreachable. */
+#define cmdBAUD_CONFIRM_MS			10000
+
+/* The largest difference between the baud rate asked for and the one the
+divider gives, in tenths of a percent. */
+#define cmdBAUD_MAX_ERROR			20
+
+/* The USART3 RTS and CTS pins, which are only switched to the UART when flow
+control is turned on.  They are not connected to the ST-LINK virtual COM port,
+so flow control needs a separate USB to serial adapter. */
+#define cmdUART_FLOW_CONTROL_PORT	GPIOD
+#define cmdUART_CTS_PIN				GPIO_PIN_11
+#define cmdUART_RTS_PIN				GPIO_PIN_12
+
+/* upload reset waits this long, in ticks, for its message to be sent before
+it resets the board. */
+#define cmdUPLOAD_RESET_DELAY		( 200 / portTICK_PERIOD_MS )
+
+/* The state of all the tasks, taken when task-stats or run-time-stats is
+entered and output one task per call. */
+typedef struct xTASK_SNAPSHOT
+{
+	BaseType_t xFromHeap;			/* Set if it did not fit in a block of the block pool. */
+	UBaseType_t uxNumberOfTasks;
+	uint32_t ulTotalRunTime;
+	uint64_t ullTaskRunTime;		/* The sum of the run times of the tasks, set by run-time-stats. */
+	TaskStatus_t xTasks[];
+} TaskSnapshot_t;
+
+/* Output queued for the USART3 TX DMA stream that is sent from where it is
+rather than from the TX ring buffer.  It is sent once the ring buffer has been
+sent up to xRingPosition, the head of the ring buffer when it was queued, so
+the output stays in order. */
+typedef struct xTX_REFERENCE
+{
+	const uint8_t *pucData;
+	size_t xLength;
+	size_t xRingPosition;
+} TxReference_t;
+
+/* A script: commands separated by ';', as they would be typed on one line,
+executed by the run command. */
+typedef struct xCOMMAND_SCRIPT
+{
+	const char *pcName;
+	const char *pcCommands;
+} CommandScript_t;
+
+/* The progress of the run command.  The commands of the script are executed in
+a session of their own, which writes to the output buffer of the session
+executing run. */
+typedef struct xSCRIPT_RUN
+{
+	CLI_Session_t xSession;
+	const char *pcNextCommand;		/* NULL after the last command. */
+	BaseType_t xExecuting;			/* Set while cCommandString has more output to generate. */
+	char cCommandString[ cmdMAX_INPUT_SIZE ];
+} ScriptRun_t;
+
+/* A micro-benchmark run by the bench command.  pxIteration is timed once per
+iteration.  pxSetUp, which returns pdFAIL if the benchmark cannot run, and
+pxTearDown can be NULL. */
+typedef struct xBENCHMARK
+{
+	const char *pcName;
+	BaseType_t ( *pxSetUp )( void );
+	void ( *pxIteration )( void );
+	void ( *pxTearDown )( void );
+} Benchmark_t;
+
+/* The scripts, which are const so stay in flash. */
+static const CommandScript_t xScripts[] =
+{
+	{ "status", "task-stats;stack-stats;heap-stats;pool-stats" },
+	{ "timing", "run-time-stats;latency" }
+};
+
+extern UART_HandleTypeDef huart3;
+
+/* Circular buffer written by the USART3 RX DMA stream.  The DMA stream is the
+only producer and the console task the only consumer, so no locking is needed:
+the ISR publishes the DMA write index in xRxDmaHead and the task advances its
+own xRxDmaTail as the characters are processed. */
+static uint8_t ucRxDmaBuffer[ cmdRX_DMA_BUFFER_SIZE ] memoryDMA_BUFFER;
+static volatile size_t xRxDmaHead = 0;
+static size_t xRxDmaTail = 0;
+
+/* The number of characters the DMA stream has written, and the task has
+consumed, since the reception was started.  The indexes alone cannot tell
+whether the DMA stream has gone round the buffer past the task, but these
+counts can.  xRxDmaPosition is the last position reported to the ISR. */
+static volatile uint32_t ulRxDmaWritten = 0;
+static uint32_t ulRxConsumed = 0;
+static size_t xRxDmaPosition = 0;
+
+/* Set by the error callback when the reception has to be restarted, which is
+done from the task so the ring buffer indexes are only ever reset by the
+consumer. */
+static volatile BaseType_t xRxRestartRequired = pdFALSE;
+
+/* Ring buffer drained by the USART3 TX DMA stream.  The task is the only
+writer of xTxHead, and the TX complete interrupt the only writer of xTxTail.
+xTxInFlight holds the length of the DMA transfer in progress, or 0 when the
+stream is idle. */
+static uint8_t ucTxBuffer[ cmdTX_BUFFER_SIZE ] memoryDMA_BUFFER;
+static volatile size_t xTxHead = 0;
+static volatile size_t xTxTail = 0;
+static volatile size_t xTxInFlight = 0;
+
+/* The references sent between the bytes of the ring buffer.  As for the ring
+buffer, the task is the only writer of xTxReferenceHead, and the TX complete
+interrupt the only writer of xTxReferenceTail and of xTxReferenceSent, the
+length of the oldest reference already sent.  xTxInFlightReference is set while
+the DMA transfer in progress is of a reference. */
+static TxReference_t xTxReferences[ cmdTX_REFERENCES ];
+static volatile size_t xTxReferenceHead = 0;
+static volatile size_t xTxReferenceTail = 0;
+static size_t xTxReferenceSent = 0;
+static volatile BaseType_t xTxInFlightReference = pdFALSE;
+
+/* The number of output bytes that had to be dropped because the UART did not
+free space in the TX ring buffer, or for a reference, within cmdMAX_TX_WAIT. */
+static uint32_t ulTxDroppedBytes = 0;
+
+/* This semaphore is used to allow the task to wait for space in the TX ring
+buffer without wasting any CPU time.  It is given each time a DMA transfer
+completes. */
+static SemaphoreHandle_t xTxCompleteSemaphore = NULL;
+
+/* This semaphore is used to allow the task to wait for received characters
+without wasting any CPU time.  It is given once per DMA event, not once per
+character. */
+static SemaphoreHandle_t xRxCompleteSemaphore = NULL;
+
+/* The console served over USART3. */
+static CommandConsole_t xUARTConsole;
+
+/* The settings the UART goes back to if a switch made by baud is not
+confirmed in time.  xBaudPending is set from the switch until it is confirmed
+or reverted, and is only changed in critical sections.  xBaudReverted is set
+by the timer when it has put the old settings back, and cleared by the console
+task once it has said so, as the timer service task must not wait for the
+console. */
+static volatile BaseType_t xBaudPending = pdFALSE;
+static volatile BaseType_t xBaudReverted = pdFALSE;
+static uint32_t ulFallbackBaudRate = 0;
+static uint32_t ulFallbackHwFlowCtl = 0;
+static TimerHandle_t xBaudFallbackTimer = NULL;
+static StaticTimer_t xBaudFallbackTimerBuffer;
+
+static void prvUARTCommandConsoleTask( void *pvParameters );
+
+/*
+ * Adapt prvSendBuffer(), prvFlushOutput() and prvSendReference() to the console
+ * transport interface.
+ */
+static BaseType_t prvUARTWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+static void prvUARTFlush( void *pvTransport );
+static BaseType_t prvUARTWriteReference( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+
+static const CommandConsoleTransport_t xUARTTransport =
+{
+	prvUARTWrite,
+	prvUARTFlush,
+	prvUARTWriteReference
+};
+
+/*
+ * Append xBufferLength bytes to the TX ring buffer.  Returns pdFAIL if some of
+ * the output had to be dropped because the ring buffer stayed full.
+ */
+static BaseType_t prvSendBuffer( const char * pcBuffer, size_t xBufferLength );
+
+/*
+ * Queue xBufferLength bytes that do not change to be sent in place, after the
+ * output already queued, by a DMA transfer of their own.  Returns pdFAIL if
+ * they had to be dropped because the queue of references stayed full.
+ */
+static BaseType_t prvSendReference( const char * pcBuffer, size_t xBufferLength );
+
+/*
+ * Start sending whatever is in the TX ring buffer, if the DMA stream is idle.
+ */
+static void prvFlushOutput( void );
+
+/*
+ * (Re)start the circular DMA reception into ucRxDmaBuffer.  If it cannot be
+ * started, xRxRestartRequired is left set so the task tries again.
+ */
+static void prvStartReception( void );
+
+/*
+ * Wait, for at most xTicksToWait, until everything in the TX ring buffer and
+ * the queue of references has been sent and the last character has left the
+ * UART.
+ */
+static BaseType_t prvWaitForOutputIdle( TickType_t xTicksToWait );
+
+/*
+ * Calculate the BRR value and oversampling that give ulBaudRate from the
+ * current PCLK1.  16x oversampling is used when it is accurate enough, as it
+ * tolerates more clock difference between the ends of the line.  Returns
+ * pdFAIL if neither can get within cmdBAUD_MAX_ERROR.
+ */
+static BaseType_t prvCalculateBaudRate( uint32_t ulBaudRate, uint32_t *pulBRR, uint32_t *pulOverSampling );
+
+/*
+ * Set USART3 to ulBaudRate, with hardware flow control if ulHwFlowCtl is
+ * UART_HWCONTROL_RTS_CTS.  The DMA streams are not stopped.  Returns pdFAIL,
+ * leaving the UART as it was, if the rate cannot be made from PCLK1.
+ */
+static BaseType_t prvConfigureUART( uint32_t ulBaudRate, uint32_t ulHwFlowCtl );
+
+/*
+ * Called by the fallback timer when a baud switch was not confirmed in time.
+ * Puts the old settings back and wakes the console task to report it, without
+ * blocking.
+ */
+static void prvBaudFallbackCallback( TimerHandle_t xTimer );
+
+/*
+ * Confirm a pending baud switch if the pucData received by the UART holds a
+ * carriage return.
+ */
+static void prvCheckBaudConfirmation( const uint8_t *pucData, size_t xLength );
+
+/*
+ * Take a snapshot of the state of every task, in a block from the block pool,
+ * or from the FreeRTOS heap if there are too many tasks for the largest block
+ * or no block is free.  The caller frees it with prvFreeTaskSnapshot().
+ */
+static TaskSnapshot_t *prvTakeTaskSnapshot( void );
+static void prvFreeTaskSnapshot( TaskSnapshot_t *pxSnapshot );
+
+/*
+ * The pxAbandon functions of the commands that keep a task snapshot, and of
+ * run, in pxState->pvPosition.
+ */
+static void prvAbandonTaskSnapshot( CLI_Command_State_t *pxState );
+static void prvAbandonScript( CLI_Command_State_t *pxState );
+
+/*
+ * The character vTaskList() uses for eState.
+ */
+static char prvTaskStateCharacter( eTaskState eState );
+
+/*
+ * Implements the task-stats command.
+ */
+static portBASE_TYPE prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the run-time-stats command.
+ */
+static portBASE_TYPE prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the heap-stats command.
+ */
+static portBASE_TYPE prvHeapStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the stack-stats command.
+ */
+static portBASE_TYPE prvStackStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the pool-stats command.
+ */
+static portBASE_TYPE prvPoolStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the run command.
+ */
+static portBASE_TYPE prvRunCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the echo-three-parameters command.
+ */
+static portBASE_TYPE prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the echo-parameters command.
+ */
+static portBASE_TYPE prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Convert a number of CPU cycles to tenths of a microsecond.
+ */
+static uint32_t prvCyclesToTenthsOfMicroseconds( uint32_t ulCycles );
+
+/*
+ * Implements the latency command.
+ */
+static portBASE_TYPE prvLatencyCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the trace command.
+ */
+static portBASE_TYPE prvTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * The benchmarks of the bench command, see xBenchmarks.
+ */
+static void prvBenchDispatch( void );
+static void prvBenchLookup( void );
+static void prvBenchUARTWrite( void );
+static BaseType_t prvBenchSemaphoreSetUp( void );
+static void prvBenchSemaphore( void );
+static BaseType_t prvBenchContextSwitchSetUp( void );
+static void prvBenchContextSwitch( void );
+static void prvBenchContextSwitchTearDown( void );
+static void prvBenchContextSwitchTask( void *pvParameters );
+static void prvBenchHeap( void );
+static void prvBenchPool( void );
+static void prvBenchNothing( void );
+
+/*
+ * Time uxIterations calls to pxIteration with the DWT cycle counter.  The cost
+ * of timing an empty function is taken off each sample.
+ */
+static void prvBenchMeasure( void ( *pxIteration )( void ), uint32_t ulIterations, uint32_t *pulMinimum, uint32_t *pulMean, uint32_t *pulMaximum );
+
+/*
+ * The pxAbandon function of bench, which lets the next bench command run.
+ */
+static void prvAbandonBench( CLI_Command_State_t *pxState );
+
+/*
+ * Implements the bench command.
+ */
+static portBASE_TYPE prvBenchCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the watch command.
+ */
+static portBASE_TYPE prvWatchCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the clock command.
+ */
+static portBASE_TYPE prvClockCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the baud command.
+ */
+static portBASE_TYPE prvBaudCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the config command.
+ */
+static portBASE_TYPE prvConfigCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the upload command.
+ */
+static portBASE_TYPE prvUploadCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * Implements the governor command.
+ */
+static portBASE_TYPE prvGovernorCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+
+/* The benchmarks, in the order bench runs them. */
+static const Benchmark_t xBenchmarks[] =
+{
+	{ "dispatch", NULL, prvBenchDispatch, NULL },
+	{ "lookup", NULL, prvBenchLookup, NULL },
+	{ "uart-write", NULL, prvBenchUARTWrite, NULL },
+	{ "semaphore", prvBenchSemaphoreSetUp, prvBenchSemaphore, NULL },
+	{ "context-switch", prvBenchContextSwitchSetUp, prvBenchContextSwitch, prvBenchContextSwitchTearDown },
+	{ "heap", NULL, prvBenchHeap, NULL },
+	{ "pool", NULL, prvBenchPool, NULL }
+};
+
+/* The state of the benchmarks.  Only one bench command runs at a time, the one
+that set xBenchRunning. */
+static BaseType_t xBenchRunning = pdFALSE;
+static CLI_Session_t xBenchSession;
+static char cBenchOutput[ cmdBENCH_OUTPUT_SIZE ];
+static SemaphoreHandle_t xBenchSemaphore = NULL;
+static StaticSemaphore_t xBenchSemaphoreBuffer;
+static TaskHandle_t xBenchTask = NULL;
+static TaskHandle_t xBenchHelperTask = NULL;
+static StaticTask_t xBenchHelperTaskBuffer;
+static StackType_t xBenchHelperStack[ configMINIMAL_STACK_SIZE ];
+
+/* Structure that defines the "run-time-stats" command line command.   This
+generates a table that shows how much run time each task has.  The commands
+that list the tasks run in the background, as on a slow console sending the
+table takes a while. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xRunTimeStats,
+	"run-time-stats", /* The command string to type. */
+	"\r\nrun-time-stats:\r\n Displays a table showing how much processing time each FreeRTOS task has used\r\n",
+	prvRunTimeStatsCommand, /* The function to run. */
+	0, /* No parameters are expected. */
+	cliCOMMAND_FLAG_ASYNC | cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "task-stats" command line command.  This generates
+a table that gives information on each task in the system. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xTaskStats,
+	"task-stats", /* The command string to type. */
+	"\r\ntask-stats:\r\n Displays a table showing the state of each FreeRTOS task\r\n",
+	prvTaskStatsCommand, /* The function to run. */
+	0, /* No parameters are expected. */
+	cliCOMMAND_FLAG_ASYNC | cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "heap-stats" command line command.  This shows
+how much of the FreeRTOS heap is in use and how fragmented it is. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xHeapStats,
+	"heap-stats", /* The command string to type. */
+	"\r\nheap-stats:\r\n Displays the free space, fragmentation and allocation counts of the FreeRTOS heap\r\n",
+	prvHeapStatsCommand, /* The function to run. */
+	0, /* No parameters are expected. */
+	cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "stack-stats" command line command.  This shows
+the least stack each task has had left, tightest first. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xStackStats,
+	"stack-stats", /* The command string to type. */
+	"\r\nstack-stats:\r\n Displays the stack high water mark of each FreeRTOS task, lowest first\r\n",
+	prvStackStatsCommand, /* The function to run. */
+	0, /* No parameters are expected. */
+	cliCOMMAND_FLAG_ASYNC | cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "pool-stats" command line command.  This shows
+the usage of each class of the block pool. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xPoolStats,
+	"pool-stats", /* The command string to type. */
+	"\r\npool-stats:\r\n Displays the usage of each class of fixed size blocks in the block pool\r\n",
+	prvPoolStatsCommand, /* The function to run. */
+	0, /* No parameters are expected. */
+	cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "run" command line command.  This executes the
+commands of a script one after the other. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xRun,
+	"run",
+	"\r\nrun [script]:\r\n Executes the commands of a script one after the other, or lists the scripts\r\n",
+	prvRunCommand, /* The function to run. */
+	-1 /* The script is optional. */
+);
+
+/* Structure that defines the "echo_3_parameters" command line command.  This
+takes exactly three parameters that the command simply echos back one at a
+time. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xThreeParameterEcho,
+	"echo-3-parameters",
+	"\r\necho-3-parameters <param1> <param2> <param3>:\r\n Expects three parameters, echos each in turn\r\n",
+	prvThreeParameterEchoCommand, /* The function to run. */
+	3, /* Three parameters are expected, which can take any value. */
+	cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "echo_parameters" command line command.  This
+takes a variable number of parameters that the command simply echos back one at
+a time. */
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS(
+	xParameterEcho,
+	"echo-parameters",
+	"\r\necho-parameters <...>:\r\n Take variable number of parameters, echos each in turn\r\n",
+	prvParameterEchoCommand, /* The function to run. */
+	-1, /* The user can enter any number of commands. */
+	cliCOMMAND_FLAG_READ_ONLY
+);
+
+/* Structure that defines the "latency" command line command.  This outputs the
+statistics of the latency histograms, or empties them. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xLatency,
+	"latency",
+	"\r\nlatency [reset]:\r\n Displays the interrupt and task wake up latencies measured since the last reset, or resets them\r\n",
+	prvLatencyCommand, /* The function to run. */
+	-1 /* reset is optional. */
+);
+
+/* Structure that defines the "trace" command line command.  This outputs, and
+removes, the records in the trace log. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xTrace,
+	"trace",
+	"\r\ntrace [clear]:\r\n Outputs the records added to the trace log since it was last read, or discards them\r\n",
+	prvTraceCommand, /* The function to run. */
+	-1 /* clear is optional. */
+);
+
+/* Structure that defines the "bench" command line command.  This times the
+micro-benchmarks in xBenchmarks with the cycle counter.  It takes a while, so
+runs in the background. */
+FreeRTOS_CLI_DEFINE_ASYNC_COMMAND(
+	xBench,
+	"bench",
+	"\r\nbench [<name> | all [iterations]]:\r\n Times the micro-benchmarks, or one of them, in CPU cycles\r\n",
+	prvBenchCommand, /* The function to run. */
+	-1 /* The benchmark and the number of iterations are optional. */
+);
+
+/* Structure that defines the "watch" command line command.  This executes a
+command periodically, sending only the rows of its output that changed.  Only
+commands with cliCOMMAND_FLAG_READ_ONLY set can be watched. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xWatch,
+	"watch",
+	"\r\nwatch [<period ms> <command...> | stop]:\r\n Executes a command every period in the background, showing only the rows that changed, or stops\r\n",
+	prvWatchCommand, /* The function to run. */
+	-1 /* The period and command, or stop, are optional. */
+);
+
+/* Structure that defines the "clock" command line command.  This shows the
+clocks, or switches to one of the profiles in ClockProfile.h. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xClock,
+	"clock",
+	"\r\nclock [performance | balanced | low-power]:\r\n Displays the clocks and the power settings, or switches to another clock profile\r\n",
+	prvClockCommand, /* The function to run. */
+	-1 /* The profile is optional. */
+);
+
+/* Structure that defines the "baud" command line command.  This shows the
+USART3 settings, or changes the baud rate and flow control. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xBaud,
+	"baud",
+	"\r\nbaud [<rate> [rts-cts]]:\r\n Displays the UART settings, or switches to another baud rate, optionally with hardware flow control.  Press enter at the new rate within 10 s to keep it\r\n",
+	prvBaudCommand, /* The function to run. */
+	-1 /* The rate and flow control are optional. */
+);
+
+/* Structure that defines the "config" command line command.  This reads and
+writes the settings kept in flash by ConfigStore.c. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xConfig,
+	"config",
+	"\r\nconfig [get <key> | set <key> <value> | delete <key> | list]:\r\n Reads, writes or lists the settings kept in flash, or displays the usage of the store.  Quote values that contain spaces\r\n",
+	prvConfigCommand, /* The function to run. */
+	-1 /* The operation is optional. */
+);
+
+/* Structure that defines the "upload" command line command.  This controls
+the firmware update, whose data is sent in binary frames. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xUpload,
+	"upload",
+	"\r\nupload [begin <length> <crc32> | commit | abort | reset]:\r\n Starts receiving a firmware image in frameREQUEST_WRITE frames, installs it on the next reset once it has been checked, or displays the progress\r\n",
+	prvUploadCommand, /* The function to run. */
+	-1 /* The operation is optional. */
+);
+
+/* Structure that defines the "governor" command line command.  This shows how
+the commands executed by the consoles use their CPU time budget, or changes
+it. */
+FreeRTOS_CLI_DEFINE_COMMAND(
+	xGovernor,
+	"governor",
+	"\r\ngovernor [budget <us>]:\r\n Displays the CPU time budget of console commands and how many used it up, or sets the budget.  Commands over budget run at the priority of the console task\r\n",
+	prvGovernorCommand, /* The function to run. */
+	-1 /* The budget is optional. */
+);
+
+static TaskSnapshot_t *prvTakeTaskSnapshot( void )
+{
+TaskSnapshot_t *pxSnapshot;
+UBaseType_t uxArraySize;
+size_t xSize;
+BaseType_t xFromHeap = pdFALSE;
+
+	/* Leave room for a few tasks to be created between the count being read
+	and the snapshot being taken. */
+	uxArraySize = uxTaskGetNumberOfTasks() + cmdSNAPSHOT_SPARE_TASKS;
+	xSize = sizeof( TaskSnapshot_t ) + ( uxArraySize * sizeof( TaskStatus_t ) );
+
+	/* The largest blocks are shared with the background commands, and only
+	hold a couple of dozen tasks, so fall back to the heap rather than fail.
+	The snapshot only lives while its command runs. */
+	pxSnapshot = ( TaskSnapshot_t * ) pvBlockPoolAllocate( xSize );
+	if( pxSnapshot == NULL )
+	{
+		pxSnapshot = ( TaskSnapshot_t * ) pvPortMalloc( xSize );
+		xFromHeap = pdTRUE;
+	}
+
+	if( pxSnapshot != NULL )
+	{
+		pxSnapshot->xFromHeap = xFromHeap;
+		pxSnapshot->uxNumberOfTasks = uxTaskGetSystemState( pxSnapshot->xTasks, uxArraySize, &( pxSnapshot->ulTotalRunTime ) );
+	}
+
+	return pxSnapshot;
+}
+
+static void prvFreeTaskSnapshot( TaskSnapshot_t *pxSnapshot )
+{
+	if( pxSnapshot->xFromHeap != pdFALSE )
+	{
+		vPortFree( pxSnapshot );
+	}
+	else
+	{
+		vBlockPoolFree( pxSnapshot );
+	}
+}
+
+static void prvAbandonTaskSnapshot( CLI_Command_State_t *pxState )
+{
+	prvFreeTaskSnapshot( ( TaskSnapshot_t * ) pxState->pvPosition );
+}
+
+static void prvAbandonScript( CLI_Command_State_t *pxState )
+{
+	ScriptRun_t *pxRun = ( ScriptRun_t * ) pxState->pvPosition;
+
+	/* The command of the script that was executing goes too. */
+	FreeRTOS_CLIAbandonCommand( &( pxRun->xSession ) );
+	vBlockPoolFree( pxRun );
+}
+
+static char prvTaskStateCharacter( eTaskState eState )
+{
+char cReturn;
+
+	switch( eState )
+	{
+		case eRunning:		cReturn = 'X'; break;
+		case eReady:		cReturn = 'R'; break;
+		case eBlocked:		cReturn = 'B'; break;
+		case eSuspended:	cReturn = 'S'; break;
+		case eDeleted:		cReturn = 'D'; break;
+		default:			cReturn = '?'; break;
+	}
+
+	return cReturn;
+}
+
+static portBASE_TYPE prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char *const pcHeader =
+			"Task          State  Priority  Stack	#\r\n************************************************\r\n";
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	TaskSnapshot_t *pxSnapshot;
+	const TaskStatus_t *pxTask;
+
+	( void ) pcCommandString;
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		/* Take a snapshot of all the tasks, then output the header.  The table
+		itself is output one row per call, so it never has to fit in the output
+		buffer however many tasks there are. */
+		pxSnapshot = prvTakeTaskSnapshot();
+		if( pxSnapshot == NULL )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Not enough memory to list the tasks\r\n" );
+			return pdFALSE;
+		}
+
+		pxState->pvPosition = pxSnapshot;
+		pxState->pxAbandon = prvAbandonTaskSnapshot;
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+
+		/* Programs are given the rows without the header. */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? "" : pcHeader );
+		return pdTRUE;
+	}
+
+	pxSnapshot = ( TaskSnapshot_t * ) pxState->pvPosition;
+	if( pxState->uxIndex >= pxSnapshot->uxNumberOfTasks )
+	{
+		/* Every row has been output. */
+		prvFreeTaskSnapshot( pxSnapshot );
+		pcWriteBuffer[ 0 ] = 0x00;
+		return pdFALSE;
+	}
+
+	pxTask = &( pxSnapshot->xTasks[ pxState->uxIndex ] );
+
+	/* Programs get the same columns, without padding. */
+	snprintf( pcWriteBuffer, xWriteBufferLen, "%-*s\t%c\t%u\t%u\t%u\r\n",
+				( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? 0 : ( int ) ( configMAX_TASK_NAME_LEN - 1 ), pxTask->pcTaskName,
+				prvTaskStateCharacter( pxTask->eCurrentState ),
+				( unsigned int ) pxTask->uxCurrentPriority,
+				( unsigned int ) pxTask->usStackHighWaterMark,
+				( unsigned int ) pxTask->xTaskNumber );
+	pxState->uxIndex++;
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char * const pcHeader = "Task            Abs Time      % Time\r\n****************************************\r\n";
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	TaskSnapshot_t *pxSnapshot;
+	const TaskStatus_t *pxTask;
+	uint32_t ulPercentage;
+	UBaseType_t x;
+
+	( void ) pcCommandString;
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		/* As task-stats, one row is output per call. */
+		pxSnapshot = prvTakeTaskSnapshot();
+		if( pxSnapshot == NULL )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Not enough memory to list the tasks\r\n" );
+			return pdFALSE;
+		}
+
+		/* The kernel keeps 32-bit run times, in runtimeCOUNTER_PERIOD_US periods,
+		so the total and the time of each task wrap after about 5 days.  The
+		total wraps first, and the idle task, which has most of the time, soon
+		after.  Percentages are calculated against the sum of the times of the
+		tasks, which adds up to 100% even once the total has wrapped, but are
+		wrong after a task's own time has. */
+		pxSnapshot->ullTaskRunTime = 0;
+		for( x = 0; x < pxSnapshot->uxNumberOfTasks; x++ )
+		{
+			pxSnapshot->ullTaskRunTime += pxSnapshot->xTasks[ x ].ulRunTimeCounter;
+		}
+
+		pxState->pvPosition = pxSnapshot;
+		pxState->pxAbandon = prvAbandonTaskSnapshot;
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+
+		/* Programs are given the rows without the header. */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? "" : pcHeader );
+		return pdTRUE;
+	}
+
+	pxSnapshot = ( TaskSnapshot_t * ) pxState->pvPosition;
+	if( pxState->uxIndex >= pxSnapshot->uxNumberOfTasks )
+	{
+		prvFreeTaskSnapshot( pxSnapshot );
+		pcWriteBuffer[ 0 ] = 0x00;
+		return pdFALSE;
+	}
+
+	pxTask = &( pxSnapshot->xTasks[ pxState->uxIndex ] );
+	ulPercentage = ( pxSnapshot->ullTaskRunTime > 0 ) ? ( uint32_t ) ( ( ( uint64_t ) pxTask->ulRunTimeCounter * 100ULL ) / pxSnapshot->ullTaskRunTime ) : 0;
+	if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+	{
+		/* Programs get the raw counter and work out the share themselves. */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s\t%u\r\n", pxTask->pcTaskName, ( unsigned int ) pxTask->ulRunTimeCounter );
+	}
+	else if( ulPercentage > 0 )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%-*s\t%u\t\t%u%%\r\n",
+					( int ) ( configMAX_TASK_NAME_LEN - 1 ), pxTask->pcTaskName,
+					( unsigned int ) pxTask->ulRunTimeCounter, ( unsigned int ) ulPercentage );
+	}
+	else
+	{
+		/* Less than 1% of the time was used. */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%-*s\t%u\t\t<1%%\r\n",
+					( int ) ( configMAX_TASK_NAME_LEN - 1 ), pxTask->pcTaskName,
+					( unsigned int ) pxTask->ulRunTimeCounter );
+	}
+	pxState->uxIndex++;
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvHeapStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	HeapStats_t xHeapStats;
+	uint32_t ulFragmentation;
+
+	( void ) pcCommandString;
+	configASSERT( pcWriteBuffer );
+
+	vPortGetHeapStats( &xHeapStats );
+
+	/* The share of the free space that is not in the largest free block, so
+	cannot be used by an allocation as large as all the free space. */
+	ulFragmentation = 0;
+	if( xHeapStats.xAvailableHeapSpaceInBytes > 0 )
+	{
+		ulFragmentation = 100UL - ( uint32_t ) ( ( ( uint64_t ) xHeapStats.xSizeOfLargestFreeBlockInBytes * 100ULL ) / xHeapStats.xAvailableHeapSpaceInBytes );
+	}
+
+	snprintf( pcWriteBuffer, xWriteBufferLen,
+				( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ?
+					"size\t%u\r\nfree\t%u\r\nminimum-free\t%u\r\nlargest-block\t%u\r\nsmallest-block\t%u\r\nfree-blocks\t%u\r\nfragmentation\t%u\r\nallocations\t%u\r\nfrees\t%u\r\n" :
+					"Heap size           %u bytes\r\nFree                %u bytes\r\nMinimum ever free   %u bytes\r\nLargest free block  %u bytes\r\nSmallest free block %u bytes\r\nFree blocks         %u\r\nFragmentation       %u%%\r\nAllocations         %u\r\nFrees               %u\r\n",
+				( unsigned int ) configTOTAL_HEAP_SIZE,
+				( unsigned int ) xHeapStats.xAvailableHeapSpaceInBytes,
+				( unsigned int ) xHeapStats.xMinimumEverFreeBytesRemaining,
+				( unsigned int ) xHeapStats.xSizeOfLargestFreeBlockInBytes,
+				( unsigned int ) xHeapStats.xSizeOfSmallestFreeBlockInBytes,
+				( unsigned int ) xHeapStats.xNumberOfFreeBlocks,
+				( unsigned int ) ulFragmentation,
+				( unsigned int ) xHeapStats.xNumberOfSuccessfulAllocations,
+				( unsigned int ) xHeapStats.xNumberOfSuccessfulFrees );
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvStackStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char *const pcHeader =
+			"Task            Free (words)  Free (bytes)\r\n********************************************\r\n";
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	TaskSnapshot_t *pxSnapshot;
+	const TaskStatus_t *pxTask;
+	TaskStatus_t xTask;
+	UBaseType_t x, y;
+	CommandWriter_t xWriter;
+
+	( void ) pcCommandString;
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		/* As task-stats, one row is output per call. */
+		pxSnapshot = prvTakeTaskSnapshot();
+		if( pxSnapshot == NULL )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Not enough memory to list the tasks\r\n" );
+			return pdFALSE;
+		}
+
+		/* Sort the tasks with the least stack left first.  There are only a
+		few, so an insertion sort is enough. */
+		for( x = 1; x < pxSnapshot->uxNumberOfTasks; x++ )
+		{
+			xTask = pxSnapshot->xTasks[ x ];
+			for( y = x; ( y > 0 ) && ( pxSnapshot->xTasks[ y - 1 ].usStackHighWaterMark > xTask.usStackHighWaterMark ); y-- )
+			{
+				pxSnapshot->xTasks[ y ] = pxSnapshot->xTasks[ y - 1 ];
+			}
+			pxSnapshot->xTasks[ y ] = xTask;
+		}
+
+		pxState->pvPosition = pxSnapshot;
+		pxState->pxAbandon = prvAbandonTaskSnapshot;
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+
+		/* Programs are given the rows without the header. */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? "" : pcHeader );
+		return pdTRUE;
+	}
+
+	pxSnapshot = ( TaskSnapshot_t * ) pxState->pvPosition;
+	if( pxState->uxIndex >= pxSnapshot->uxNumberOfTasks )
+	{
+		prvFreeTaskSnapshot( pxSnapshot );
+		pcWriteBuffer[ 0 ] = 0x00;
+		return pdFALSE;
+	}
+
+	pxTask = &( pxSnapshot->xTasks[ pxState->uxIndex ] );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+	if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+	{
+		vCommandWriteString( &xWriter, pxTask->pcTaskName );
+		vCommandWriteChar( &xWriter, '\t' );
+		vCommandWriteUnsigned( &xWriter, pxTask->usStackHighWaterMark, 0 );
+	}
+	else
+	{
+		vCommandWriteStringPadded( &xWriter, pxTask->pcTaskName, configMAX_TASK_NAME_LEN - 1 );
+		vCommandWriteChar( &xWriter, '\t' );
+		vCommandWriteUnsigned( &xWriter, pxTask->usStackHighWaterMark, 8 );
+		vCommandWriteChar( &xWriter, '\t' );
+		vCommandWriteUnsigned( &xWriter, ( uint32_t ) ( pxTask->usStackHighWaterMark * sizeof( StackType_t ) ), 8 );
+		if( pxTask->usStackHighWaterMark < cmdSTACK_LOW_WATER_MARK )
+		{
+			vCommandWriteString( &xWriter, "  low" );
+		}
+	}
+	vCommandWriteString( &xWriter, "\r\n" );
+	pxState->uxIndex++;
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvPoolStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char *const pcHeader =
+			"Size  Blocks  Free  Min free  Allocations  Failures\r\n****************************************************\r\n";
+	static const uint8_t ucWidths[] = { 4, 8, 6, 10, 13, 10 };
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	BlockPoolStats_t xStats;
+	uint32_t ulValues[ 6 ];
+	size_t x;
+	CommandWriter_t xWriter;
+
+	( void ) pcCommandString;
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		/* One class is output per call. */
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? "" : pcHeader );
+		return pdTRUE;
+	}
+
+	if( pxState->uxIndex >= uxBlockPoolClasses() )
+	{
+		pcWriteBuffer[ 0 ] = 0x00;
+		return pdFALSE;
+	}
+
+	vBlockPoolGetStats( pxState->uxIndex, &xStats );
+	ulValues[ 0 ] = ( uint32_t ) xStats.xBlockSize;
+	ulValues[ 1 ] = ( uint32_t ) xStats.uxBlocks;
+	ulValues[ 2 ] = ( uint32_t ) xStats.uxFreeBlocks;
+	ulValues[ 3 ] = ( uint32_t ) xStats.uxMinimumEverFreeBlocks;
+	ulValues[ 4 ] = xStats.ulAllocations;
+	ulValues[ 5 ] = xStats.ulFailures;
+
+	/* Programs get the values separated by tabs, people get columns. */
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+	for( x = 0; x < ( sizeof( ulValues ) / sizeof( ulValues[ 0 ] ) ); x++ )
+	{
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			if( x > 0 )
+			{
+				vCommandWriteChar( &xWriter, '\t' );
+			}
+			vCommandWriteUnsigned( &xWriter, ulValues[ x ], 0 );
+		}
+		else
+		{
+			vCommandWriteUnsigned( &xWriter, ulValues[ x ], ucWidths[ x ] );
+		}
+	}
+	vCommandWriteString( &xWriter, "\r\n" );
+	pxState->uxIndex++;
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvRunCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	ScriptRun_t *pxRun;
+	const char *pcParameter;
+	BaseType_t xParameterStringLength, xReturned;
+	UBaseType_t x;
+	int iLength;
+
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+		if( pcParameter == NULL )
+		{
+			/* There are only a few scripts, so they are listed in one go. */
+			iLength = 0;
+			for( x = 0; ( x < ( sizeof( xScripts ) / sizeof( xScripts[ 0 ] ) ) ) && ( ( size_t ) iLength < xWriteBufferLen ); x++ )
+			{
+				iLength += snprintf( pcWriteBuffer + iLength, xWriteBufferLen - iLength, "%s: %s\r\n", xScripts[ x ].pcName, xScripts[ x ].pcCommands );
+			}
+			return pdFALSE;
+		}
+
+		for( x = 0; x < ( sizeof( xScripts ) / sizeof( xScripts[ 0 ] ) ); x++ )
+		{
+			if( ( strlen( xScripts[ x ].pcName ) == ( size_t ) xParameterStringLength ) &&
+				( strncmp( xScripts[ x ].pcName, pcParameter, xParameterStringLength ) == 0 ) )
+			{
+				break;
+			}
+		}
+
+		if( x == ( sizeof( xScripts ) / sizeof( xScripts[ 0 ] ) ) )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "No script called %.*s\r\n", ( int ) xParameterStringLength, pcParameter );
+			return pdFALSE;
+		}
+
+		pxRun = ( ScriptRun_t * ) pvBlockPoolAllocate( sizeof( ScriptRun_t ) );
+		if( pxRun == NULL )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Not enough memory to run the script\r\n" );
+			return pdFALSE;
+		}
+
+		/* The commands write straight into this command's output buffer,
+		which is the same for every call. */
+		FreeRTOS_CLISessionInit( &( pxRun->xSession ), pcWriteBuffer, xWriteBufferLen );
+		FreeRTOS_CLISetMachineReadable( &( pxRun->xSession ), FreeRTOS_CLIIsMachineReadable() );
+		FreeRTOS_CLISetAcceptsReferences( &( pxRun->xSession ), FreeRTOS_CLIAcceptsReferences() );
+		FreeRTOS_CLISetSessionOwner( &( pxRun->xSession ), FreeRTOS_CLIGetSessionOwner() );
+		pxRun->pcNextCommand = xScripts[ x ].pcCommands;
+		pxRun->xExecuting = pdFALSE;
+
+		pxState->pvPosition = pxRun;
+		pxState->pxAbandon = prvAbandonScript;
+		pxState->xStep = 1;
+	}
+
+	pxRun = ( ScriptRun_t * ) pxState->pvPosition;
+	pcWriteBuffer[ 0 ] = 0x00;
+
+	if( pxRun->xExecuting == pdFALSE )
+	{
+		if( pxRun->pcNextCommand == NULL )
+		{
+			vBlockPoolFree( pxRun );
+			return pdFALSE;
+		}
+
+		pxRun->pcNextCommand = FreeRTOS_CLINextCommand( pxRun->pcNextCommand, pxRun->cCommandString, sizeof( pxRun->cCommandString ) );
+		if( pxRun->cCommandString[ 0 ] == 0x00 )
+		{
+			return pdTRUE;
+		}
+
+		/* A script that runs scripts could run itself for ever. */
+		if( FreeRTOS_CLIFindCommand( pxRun->cCommandString ) == &xRun )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Scripts cannot run scripts\r\n" );
+			return pdTRUE;
+		}
+
+		/* People are shown which command the output that follows is from. */
+		pxRun->xExecuting = pdTRUE;
+		if( FreeRTOS_CLIIsMachineReadable() == pdFALSE )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "> %s\r\n", pxRun->cCommandString );
+		}
+		return pdTRUE;
+	}
+
+	/* One output string of the command per call, as if the command was
+	executed directly. */
+	xReturned = FreeRTOS_CLIProcessSessionCommand( &( pxRun->xSession ), pxRun->cCommandString );
+	if( xReturned == pdFALSE )
+	{
+		pxRun->xExecuting = pdFALSE;
+	}
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char *pcParameter;
+	portBASE_TYPE xParameterStringLength, xReturn;
+	CommandWriter_t xWriter;
+
+	/* The number of the next parameter is kept in the state of the session
+	executing the command, so consoles on different transports can run the
+	command at the same time.  The state is zeroed each time a new command is
+	entered. */
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+
+	/* Check the write buffer is not NULL.  The writer never writes past
+	xWriteBufferLen, long parameters are cut short instead. */
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	if( pxState->xStep == 0 )
+	{
+		/* The first time the function is called after the command has been
+		entered just a header string is returned. */
+		vCommandWriteString( &xWriter, "The three parameters were:\r\n" );
+
+		/* Next time the function is called the first parameter will be echoed
+		back. */
+		pxState->xStep = 1L;
+
+		/* There is more data to be returned as no parameters have been echoed
+		back yet. */
+		xReturn = pdPASS;
+	}
+	else
+	{
+		/* Obtain the parameter string. */
+		pcParameter = FreeRTOS_CLIGetParameter
+							(
+								pcCommandString,		/* The command string itself. */
+								pxState->xStep,			/* Return the next parameter. */
+								&xParameterStringLength	/* Store the parameter string length. */
+							);
+
+		/* Sanity check something was returned. */
+		configASSERT( pcParameter );
+
+		/* Return the parameter string. */
+		vCommandWriteSigned( &xWriter, ( int32_t ) pxState->xStep, 0 );
+		vCommandWriteString( &xWriter, ": " );
+		vCommandWriteStringN( &xWriter, pcParameter, ( size_t ) xParameterStringLength );
+		vCommandWriteString( &xWriter, "\r\n" );
+
+		/* If this is the last of the three parameters then there are no more
+		strings to return after this one. */
+		if( pxState->xStep == 3L )
+		{
+			/* If this is the last of the three parameters then there are no more
+			strings to return after this one. */
+			xReturn = pdFALSE;
+			pxState->xStep = 0L;
+		}
+		else
+		{
+			/* There are more parameters to return after this one. */
+			xReturn = pdTRUE;
+			pxState->xStep++;
+		}
+	}
+
+	return xReturn;
+}
+
+static portBASE_TYPE prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char *pcParameter;
+	portBASE_TYPE xParameterStringLength, xReturn;
+	CommandWriter_t xWriter;
+
+	/* The number of the next parameter is kept in the state of the session
+	executing the command, so consoles on different transports can run the
+	command at the same time.  The state is zeroed each time a new command is
+	entered. */
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+
+	/* Check the write buffer is not NULL.  The writer never writes past
+	xWriteBufferLen, long parameters are cut short instead. */
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	if( pxState->xStep == 0 )
+	{
+		/* The first time the function is called after the command has been
+		entered just a header string is returned. */
+		vCommandWriteString( &xWriter, "The parameters were:\r\n" );
+
+		/* Next time the function is called the first parameter will be echoed
+		back. */
+		pxState->xStep = 1L;
+
+		/* There is more data to be returned as no parameters have been echoed
+		back yet. */
+		xReturn = pdPASS;
+	}
+	else
+	{
+		/* Obtain the parameter string. */
+		pcParameter = FreeRTOS_CLIGetParameter
+							(
+								pcCommandString,		/* The command string itself. */
+								pxState->xStep,			/* Return the next parameter. */
+								&xParameterStringLength	/* Store the parameter string length. */
+							);
+
+		if( pcParameter != NULL )
+		{
+			/* Return the parameter string. */
+			vCommandWriteSigned( &xWriter, ( int32_t ) pxState->xStep, 0 );
+			vCommandWriteString( &xWriter, ": " );
+			vCommandWriteStringN( &xWriter, pcParameter, ( size_t ) xParameterStringLength );
+			vCommandWriteString( &xWriter, "\r\n" );
+
+			/* There might be more parameters to return after this one. */
+			xReturn = pdTRUE;
+			pxState->xStep++;
+		}
+		else
+		{
+			/* No more parameters were found.  The write buffer was left
+			empty by vCommandWriterInit(). */
+
+			/* No more data to return. */
+			xReturn = pdFALSE;
+
+			/* Start over the next time this command is executed. */
+			pxState->xStep = 0;
+		}
+	}
+
+	return xReturn;
+}
+
+static uint32_t prvCyclesToTenthsOfMicroseconds( uint32_t ulCycles )
+{
+	return ( uint32_t ) ( ( ( uint64_t ) ulCycles * 10000000ULL ) / SystemCoreClock );
+}
+
+static portBASE_TYPE prvLatencyCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	const char * const pcHeader = "Latency (us)       Count       Min       p50       p99       Max\r\n********************************************************************\r\n";
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	LatencySummary_t xSummary;
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	LatencyHistogram_t eHistogram;
+	uint32_t ulTimes[ 4 ];
+	size_t x;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+		if( pcParameter != NULL )
+		{
+			if( ( xParameterStringLength == 5 ) && ( strncmp( pcParameter, "reset", 5 ) == 0 ) )
+			{
+				for( eHistogram = ( LatencyHistogram_t ) 0; eHistogram < eLatencyHistograms; eHistogram++ )
+				{
+					vLatencyReset( eHistogram );
+				}
+				snprintf( pcWriteBuffer, xWriteBufferLen, "Latency histograms reset\r\n" );
+			}
+			else
+			{
+				snprintf( pcWriteBuffer, xWriteBufferLen, "Unknown parameter, expected reset\r\n" );
+			}
+			return pdFALSE;
+		}
+
+		/* One histogram is output per call. */
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( FreeRTOS_CLIIsMachineReadable() != pdFALSE ) ? "" : pcHeader );
+		return pdTRUE;
+	}
+
+	if( pxState->uxIndex >= ( UBaseType_t ) eLatencyHistograms )
+	{
+		pcWriteBuffer[ 0 ] = 0x00;
+		return pdFALSE;
+	}
+
+	eHistogram = ( LatencyHistogram_t ) pxState->uxIndex;
+	vLatencyGetSummary( eHistogram, &xSummary );
+	ulTimes[ 0 ] = xSummary.ulMinimum;
+	ulTimes[ 1 ] = xSummary.ulMedian;
+	ulTimes[ 2 ] = xSummary.ul99thPercentile;
+	ulTimes[ 3 ] = xSummary.ulMaximum;
+
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+	if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+	{
+		/* Programs get the raw cycle counts. */
+		vCommandWriteString( &xWriter, pcLatencyName( eHistogram ) );
+		vCommandWriteChar( &xWriter, '\t' );
+		vCommandWriteUnsigned( &xWriter, xSummary.ulCount, 0 );
+		for( x = 0; x < ( sizeof( ulTimes ) / sizeof( ulTimes[ 0 ] ) ); x++ )
+		{
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteUnsigned( &xWriter, ulTimes[ x ], 0 );
+		}
+	}
+	else
+	{
+		/* The times are shown to a tenth of a microsecond. */
+		vCommandWriteStringPadded( &xWriter, pcLatencyName( eHistogram ), 14 );
+		vCommandWriteUnsigned( &xWriter, xSummary.ulCount, 10 );
+		for( x = 0; x < ( sizeof( ulTimes ) / sizeof( ulTimes[ 0 ] ) ); x++ )
+		{
+			vCommandWriteFixed( &xWriter, prvCyclesToTenthsOfMicroseconds( ulTimes[ x ] ), 1, 10 );
+		}
+	}
+	vCommandWriteString( &xWriter, "\r\n" );
+	pxState->uxIndex++;
+
+	return pdTRUE;
+}
+
+static portBASE_TYPE prvTraceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	TraceRecord_t xRecord;
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	uint32_t ulLost, ulNanoseconds;
+	int iLength;
+
+	configASSERT( pcWriteBuffer );
+
+	if( pxState->xStep == 0 )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+		if( pcParameter != NULL )
+		{
+			if( ( xParameterStringLength == 5 ) && ( strncmp( pcParameter, "clear", 5 ) == 0 ) )
+			{
+				vTraceLogClear();
+				snprintf( pcWriteBuffer, xWriteBufferLen, "Trace log cleared\r\n" );
+			}
+			else
+			{
+				snprintf( pcWriteBuffer, xWriteBufferLen, "Unknown parameter, expected clear\r\n" );
+			}
+			return pdFALSE;
+		}
+	}
+
+	/* One record is output per call, so the records are only formatted as
+	fast as the console drains them. */
+	if( xTraceLogRead( &xRecord, &ulLost ) == pdFALSE )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%s", ( pxState->xStep == 0 ) ? "The trace log is empty\r\n" : "" );
+		return pdFALSE;
+	}
+
+	/* Each record is stamped with the time since the one before it.  uxIndex
+	holds the timestamp of the record output by the previous call. */
+	if( pxState->xStep == 0 )
+	{
+		pxState->uxIndex = xRecord.ulTimestamp;
+		pxState->xStep = 1;
+	}
+	ulNanoseconds = ( uint32_t ) ( ( ( uint64_t ) ( xRecord.ulTimestamp - ( uint32_t ) pxState->uxIndex ) * 1000000000ULL ) / SystemCoreClock );
+	pxState->uxIndex = xRecord.ulTimestamp;
+
+	iLength = 0;
+	if( ulLost > 0 )
+	{
+		iLength = snprintf( pcWriteBuffer, xWriteBufferLen, "(%u records lost)\r\n", ( unsigned int ) ulLost );
+	}
+
+	/* Each part is only added if the ones before it fitted, as snprintf()
+	returns the length it would have written. */
+	if( ( size_t ) iLength >= xWriteBufferLen )
+	{
+		return pdTRUE;
+	}
+
+	if( xRecord.ulContext == 0 )
+	{
+		iLength += snprintf( pcWriteBuffer + iLength, xWriteBufferLen - iLength, "+%6u.%03uus  task    ",
+								( unsigned int ) ( ulNanoseconds / 1000 ), ( unsigned int ) ( ulNanoseconds % 1000 ) );
+	}
+	else
+	{
+		iLength += snprintf( pcWriteBuffer + iLength, xWriteBufferLen - iLength, "+%6u.%03uus  irq %-3u ",
+								( unsigned int ) ( ulNanoseconds / 1000 ), ( unsigned int ) ( ulNanoseconds % 1000 ),
+								( unsigned int ) xRecord.ulContext );
+	}
+
+	if( ( size_t ) iLength < xWriteBufferLen )
+	{
+		iLength += snprintf( pcWriteBuffer + iLength, xWriteBufferLen - iLength, xRecord.pcFormat,
+								xRecord.ulArguments[ 0 ], xRecord.ulArguments[ 1 ],
+								xRecord.ulArguments[ 2 ], xRecord.ulArguments[ 3 ] );
+	}
+
+	if( ( size_t ) iLength < xWriteBufferLen )
+	{
+		snprintf( pcWriteBuffer + iLength, xWriteBufferLen - iLength, "\r\n" );
+	}
+
+	return pdTRUE;
+}
+
+static void prvBenchDispatch( void )
+{
+	/* A complete command, from tokenising the line to the last output
+	string. */
+	while( FreeRTOS_CLIProcessSessionCommand( &xBenchSession, "echo-3-parameters a b c" ) != pdFALSE )
+	{
+	}
+}
+
+static void prvBenchLookup( void )
+{
+	( void ) FreeRTOS_CLIFindCommand( "watch 1000 latency" );
+}
+
+static void prvBenchUARTWrite( void )
+{
+static const char cBlank[] = "                               \r";
+BaseType_t xTakeLock;
+
+	/* Written through the TX ring buffer, under the console lock as any
+	output of the console is.  bench holds the lock already when it runs in
+	the console task, as part of a batch, a script or a frame, or when no
+	worker could take it.  Blank so it does not disturb the terminal.  Once the
+	ring buffer is full each write waits for the UART, so the maximum shows the
+	cost of a full ring. */
+	xTakeLock = ( xSemaphoreGetMutexHolder( xUARTConsole.xLock ) == xTaskGetCurrentTaskHandle() ) ? pdFALSE : pdTRUE;
+	if( xTakeLock != pdFALSE )
+	{
+		xSemaphoreTake( xUARTConsole.xLock, portMAX_DELAY );
+	}
+
+	( void ) prvSendBuffer( cBlank, sizeof( cBlank ) - 1 );
+	prvFlushOutput();
+
+	if( xTakeLock != pdFALSE )
+	{
+		xSemaphoreGive( xUARTConsole.xLock );
+	}
+}
+
+static BaseType_t prvBenchSemaphoreSetUp( void )
+{
+	if( xBenchSemaphore == NULL )
+	{
+		xBenchSemaphore = xSemaphoreCreateBinaryStatic( &xBenchSemaphoreBuffer );
+	}
+
+	return ( xBenchSemaphore != NULL ) ? pdPASS : pdFAIL;
+}
+
+static void prvBenchSemaphore( void )
+{
+	xSemaphoreGive( xBenchSemaphore );
+	xSemaphoreTake( xBenchSemaphore, 0 );
+}
+
+static BaseType_t prvBenchContextSwitchSetUp( void )
+{
+	/* The helper has a higher priority, so giving it a notification switches
+	to it straight away, and it switches back when it blocks again. */
+	if( uxTaskPriorityGet( NULL ) >= ( configMAX_PRIORITIES - 1 ) )
+	{
+		return pdFAIL;
+	}
+
+	xBenchTask = xTaskGetCurrentTaskHandle();
+	xBenchHelperTask = xTaskCreateStatic( prvBenchContextSwitchTask, "Bench", configMINIMAL_STACK_SIZE, NULL,
+											uxTaskPriorityGet( NULL ) + 1, xBenchHelperStack, &xBenchHelperTaskBuffer );
+
+	return ( xBenchHelperTask != NULL ) ? pdPASS : pdFAIL;
+}
+
+static void prvBenchContextSwitch( void )
+{
+	/* Two context switches, there and back. */
+	xTaskNotifyGive( xBenchHelperTask );
+	( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+}
+
+static void prvBenchContextSwitchTearDown( void )
+{
+	/* The helper is only ever blocked here, and a task deleted by another task
+	is freed at once, so its buffers can be used again straight away. */
+	vTaskDelete( xBenchHelperTask );
+	xBenchHelperTask = NULL;
+}
+
+static void prvBenchContextSwitchTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		xTaskNotifyGive( xBenchTask );
+	}
+}
+
+static void prvBenchHeap( void )
+{
+	vPortFree( pvPortMalloc( 64 ) );
+}
+
+static void prvBenchPool( void )
+{
+	vBlockPoolFree( pvBlockPoolAllocate( 64 ) );
+}
+
+static void prvBenchNothing( void )
+{
+}
+
+static void prvBenchMeasure( void ( *pxIteration )( void ), uint32_t ulIterations, uint32_t *pulMinimum, uint32_t *pulMean, uint32_t *pulMaximum )
+{
+	void ( * volatile pxNothing )( void ) = prvBenchNothing;
+	uint32_t ulStart, ulCycles, ulOverhead = UINT32_MAX, x;
+	uint64_t ullTotal = 0;
+
+	/* The least it takes to time a function that does nothing. */
+	for( x = 0; x < 16; x++ )
+	{
+		ulStart = DWT->CYCCNT;
+		pxNothing();
+		ulCycles = DWT->CYCCNT - ulStart;
+		if( ulCycles < ulOverhead )
+		{
+			ulOverhead = ulCycles;
+		}
+	}
+
+	*pulMinimum = UINT32_MAX;
+	*pulMaximum = 0;
+	for( x = 0; x < ulIterations; x++ )
+	{
+		ulStart = DWT->CYCCNT;
+		pxIteration();
+		ulCycles = DWT->CYCCNT - ulStart;
+		ulCycles = ( ulCycles > ulOverhead ) ? ( ulCycles - ulOverhead ) : 0;
+
+		ullTotal += ulCycles;
+		if( ulCycles < *pulMinimum )
+		{
+			*pulMinimum = ulCycles;
+		}
+		if( ulCycles > *pulMaximum )
+		{
+			*pulMaximum = ulCycles;
+		}
+	}
+
+	*pulMean = ( uint32_t ) ( ullTotal / ulIterations );
+}
+
+static void prvAbandonBench( CLI_Command_State_t *pxState )
+{
+	( void ) pxState;
+	xBenchRunning = pdFALSE;
+}
+
+static portBASE_TYPE prvBenchCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	const Benchmark_t *pxBenchmark;
+	const char *pcParameter;
+	BaseType_t xParameterStringLength, xRunning;
+	uint32_t ulIterations = cmdBENCH_ITERATIONS, ulMinimum, ulMean, ulMaximum;
+	char *pcEnd;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	/* The parameters are read again on each call, they are already
+	tokenised. */
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+	if( pcParameter != NULL )
+	{
+		ulIterations = strtoul( pcParameter, &pcEnd, 10 );
+		if( ( pcEnd != ( pcParameter + xParameterStringLength ) ) || ( ulIterations == 0 ) || ( ulIterations > cmdBENCH_MAX_ITERATIONS ) )
+		{
+			vCommandWriteString( &xWriter, "Expected between 1 and " );
+			vCommandWriteUnsigned( &xWriter, cmdBENCH_MAX_ITERATIONS, 0 );
+			vCommandWriteString( &xWriter, " iterations\r\n" );
+
+			/* The parameters are the same on each call, but whichever call
+			returns pdFALSE must let the next bench command run. */
+			if( pxState->xStep != 0 )
+			{
+				xBenchRunning = pdFALSE;
+			}
+			return pdFALSE;
+		}
+	}
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( ( pcParameter != NULL ) && ( xParameterStringLength == 3 ) && ( strncmp( pcParameter, "all", 3 ) == 0 ) )
+	{
+		pcParameter = NULL;
+	}
+
+	if( pxState->xStep == 0 )
+	{
+		taskENTER_CRITICAL();
+		{
+			xRunning = xBenchRunning;
+			xBenchRunning = pdTRUE;
+		}
+		taskEXIT_CRITICAL();
+
+		if( xRunning != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, "bench is already running\r\n" );
+			return pdFALSE;
+		}
+
+		FreeRTOS_CLISessionInit( &xBenchSession, cBenchOutput, sizeof( cBenchOutput ) );
+		pxState->uxIndex = 0;
+		pxState->xStep = 1;
+		pxState->pxAbandon = prvAbandonBench;
+
+		/* The results depend on the clock, the flash wait states and the
+		caches, so say what they were. */
+		if( FreeRTOS_CLIIsMachineReadable() == pdFALSE )
+		{
+			vCommandWriteUnsigned( &xWriter, SystemCoreClock / 1000000UL, 0 );
+			vCommandWriteString( &xWriter, " MHz, " );
+			vCommandWriteUnsigned( &xWriter, ( FLASH->ACR & FLASH_ACR_LATENCY ) >> FLASH_ACR_LATENCY_Pos, 0 );
+			vCommandWriteString( &xWriter, " flash wait states, I-cache " );
+			vCommandWriteString( &xWriter, ( ( SCB->CCR & SCB_CCR_IC_Msk ) != 0 ) ? "on" : "off" );
+			vCommandWriteString( &xWriter, ", D-cache " );
+			vCommandWriteString( &xWriter, ( ( SCB->CCR & SCB_CCR_DC_Msk ) != 0 ) ? "on" : "off" );
+			vCommandWriteString( &xWriter, "\r\nBenchmark (cycles)      Min      Mean       Max\r\n************************************************\r\n" );
+		}
+		return pdTRUE;
+	}
+
+	/* One benchmark is run per call, skipping those that were not asked
+	for. */
+	while( pxState->uxIndex < ( sizeof( xBenchmarks ) / sizeof( xBenchmarks[ 0 ] ) ) )
+	{
+		pxBenchmark = &( xBenchmarks[ pxState->uxIndex ] );
+		pxState->uxIndex++;
+
+		if( ( pcParameter != NULL ) &&
+			( ( strlen( pxBenchmark->pcName ) != ( size_t ) xParameterStringLength ) || ( strncmp( pxBenchmark->pcName, pcParameter, xParameterStringLength ) != 0 ) ) )
+		{
+			continue;
+		}
+
+		pxState->xStep = 2;
+		if( ( pxBenchmark->pxSetUp != NULL ) && ( pxBenchmark->pxSetUp() != pdPASS ) )
+		{
+			vCommandWriteString( &xWriter, pxBenchmark->pcName );
+			vCommandWriteString( &xWriter, ": could not be set up\r\n" );
+			return pdTRUE;
+		}
+
+		prvBenchMeasure( pxBenchmark->pxIteration, ulIterations, &ulMinimum, &ulMean, &ulMaximum );
+
+		if( pxBenchmark->pxTearDown != NULL )
+		{
+			pxBenchmark->pxTearDown();
+		}
+
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, pxBenchmark->pcName );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteUnsigned( &xWriter, ulMinimum, 0 );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteUnsigned( &xWriter, ulMean, 0 );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteUnsigned( &xWriter, ulMaximum, 0 );
+		}
+		else
+		{
+			vCommandWriteStringPadded( &xWriter, pxBenchmark->pcName, 18 );
+			vCommandWriteUnsigned( &xWriter, ulMinimum, 10 );
+			vCommandWriteUnsigned( &xWriter, ulMean, 10 );
+			vCommandWriteUnsigned( &xWriter, ulMaximum, 10 );
+		}
+		vCommandWriteString( &xWriter, "\r\n" );
+		return pdTRUE;
+	}
+
+	if( pxState->xStep != 2 )
+	{
+		vCommandWriteString( &xWriter, "No benchmark called " );
+		vCommandWriteStringN( &xWriter, pcParameter, ( size_t ) xParameterStringLength );
+		vCommandWriteString( &xWriter, "\r\n" );
+	}
+
+	xBenchRunning = pdFALSE;
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvWatchCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	CommandConsole_t *pxConsole = ( CommandConsole_t * ) FreeRTOS_CLIGetSessionOwner();
+	const CLI_Command_Definition_t *pxCommand;
+	const char *pcParameter, *pcCommandLine;
+	BaseType_t xParameterStringLength, xCommandLineLength;
+	char *pcEnd;
+	unsigned long ulPeriodMs;
+
+	configASSERT( pcWriteBuffer );
+
+	if( pxConsole == NULL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "watch can only be used from a console\r\n" );
+		return pdFALSE;
+	}
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( ( pcParameter == NULL ) || ( ( xParameterStringLength == 4 ) && ( strncmp( pcParameter, "stop", 4 ) == 0 ) ) )
+	{
+		if( xCommandWatchStop( pxConsole ) != pdPASS )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "No command is being watched\r\n" );
+		}
+		else
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Stopped watching\r\n" );
+		}
+		return pdFALSE;
+	}
+
+	ulPeriodMs = strtoul( pcParameter, &pcEnd, 10 );
+	pcCommandLine = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xCommandLineLength );
+	if( ( pcEnd != ( pcParameter + xParameterStringLength ) ) || ( pcCommandLine == NULL ) )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Expected a period in milliseconds and a command\r\n" );
+		return pdFALSE;
+	}
+
+	/* The command is everything after the period. */
+	pxCommand = FreeRTOS_CLIFindCommand( pcCommandLine );
+	if( pxCommand == NULL )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Command not recognised\r\n" );
+		return pdFALSE;
+	}
+
+	/* Repeating a command that changes something, such as baud or upload, is
+	never what was meant, and watching watch would start a watch that replaces
+	itself. */
+	if( ( pxCommand->ucFlags & cliCOMMAND_FLAG_READ_ONLY ) == 0 )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Only commands that change nothing can be watched\r\n" );
+		return pdFALSE;
+	}
+
+	if( xCommandWatchStart( pxConsole, ( uint32_t ) ulPeriodMs, pcCommandLine ) != pdPASS )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Too many commands are being watched\r\n" );
+		return pdFALSE;
+	}
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "Watching '%s' every %u ms, enter 'watch stop' to stop\r\n", pcCommandLine,
+				( unsigned int ) ( ( ulPeriodMs < watchMIN_PERIOD_MS ) ? watchMIN_PERIOD_MS : ulPeriodMs ) );
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvClockCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	static const char * const pcLabels[] = { "profile", "sysclk", "hclk", "pclk1", "pclk2", "flash-wait-states", "voltage-scale", "over-drive", "sleep" };
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	ClockProfile_t eProfile;
+	uint32_t ulValues[ 9 ];
+	UBaseType_t uxRow;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( pcParameter != NULL )
+	{
+		for( eProfile = ( ClockProfile_t ) 0; eProfile < eClockProfiles; eProfile++ )
+		{
+			if( ( strlen( pcClockProfileName( eProfile ) ) == ( size_t ) xParameterStringLength ) &&
+				( strncmp( pcClockProfileName( eProfile ), pcParameter, xParameterStringLength ) == 0 ) )
+			{
+				break;
+			}
+		}
+
+		if( eProfile == eClockProfiles )
+		{
+			vCommandWriteString( &xWriter, "Expected performance, balanced or low-power\r\n" );
+			return pdFALSE;
+		}
+
+		if( eProfile != eClockProfileGet() )
+		{
+			/* Whatever is still being sent when the clocks change is
+			garbled. */
+			( void ) prvWaitForOutputIdle( cmdCLOCK_DRAIN_WAIT );
+
+			if( xClockProfileApply( eProfile ) != pdPASS )
+			{
+				vCommandWriteString( &xWriter, "Could not switch to " );
+				vCommandWriteString( &xWriter, pcClockProfileName( eProfile ) );
+				vCommandWriteString( &xWriter, "\r\n" );
+				return pdFALSE;
+			}
+		}
+	}
+
+	eProfile = eClockProfileGet();
+	ulValues[ 1 ] = HAL_RCC_GetSysClockFreq();
+	ulValues[ 2 ] = HAL_RCC_GetHCLKFreq();
+	ulValues[ 3 ] = HAL_RCC_GetPCLK1Freq();
+	ulValues[ 4 ] = HAL_RCC_GetPCLK2Freq();
+	ulValues[ 5 ] = ( FLASH->ACR & FLASH_ACR_LATENCY ) >> FLASH_ACR_LATENCY_Pos;
+	/* VOS is 3 for scale 1 and 1 for scale 3. */
+	ulValues[ 6 ] = 4UL - ( ( PWR->CR1 & PWR_CR1_VOS ) >> PWR_CR1_VOS_Pos );
+
+	for( uxRow = 0; uxRow < ( sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ); uxRow++ )
+	{
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, pcLabels[ uxRow ] );
+			vCommandWriteChar( &xWriter, '\t' );
+		}
+		else
+		{
+			vCommandWriteStringPadded( &xWriter, pcLabels[ uxRow ], 20 );
+		}
+
+		switch( uxRow )
+		{
+			case 0:
+				vCommandWriteString( &xWriter, pcClockProfileName( eProfile ) );
+				break;
+
+			case 1:
+			case 2:
+			case 3:
+			case 4:
+				/* Frequencies are shown in MHz, with one decimal for PCLK1
+				at 27MHz and the like. */
+				vCommandWriteFixed( &xWriter, ulValues[ uxRow ] / 100000UL, 1, 0 );
+				if( FreeRTOS_CLIIsMachineReadable() == pdFALSE )
+				{
+					vCommandWriteString( &xWriter, " MHz" );
+				}
+				break;
+
+			case 5:
+			case 6:
+				vCommandWriteUnsigned( &xWriter, ulValues[ uxRow ], 0 );
+				break;
+
+			case 7:
+				vCommandWriteString( &xWriter, ( __HAL_PWR_GET_FLAG( PWR_FLAG_ODRDY ) != RESET ) ? "on" : "off" );
+				break;
+
+			default:
+				vCommandWriteString( &xWriter, ( xClockProfileAllowsSleep( eProfile ) != pdFALSE ) ? "tickless" : "off" );
+				break;
+		}
+
+		vCommandWriteString( &xWriter, "\r\n" );
+	}
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvBaudCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	uint32_t ulBaudRate, ulHwFlowCtl = UART_HWCONTROL_NONE, ulBRR, ulOverSampling;
+	char *pcEnd;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( pcParameter == NULL )
+	{
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			vCommandWriteUnsigned( &xWriter, huart3.Init.BaudRate, 0 );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteUnsigned( &xWriter, ( huart3.Init.OverSampling == UART_OVERSAMPLING_8 ) ? 8 : 16, 0 );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteString( &xWriter, ( huart3.Init.HwFlowCtl == UART_HWCONTROL_RTS_CTS ) ? "rts-cts" : "none" );
+			vCommandWriteChar( &xWriter, '\t' );
+			vCommandWriteString( &xWriter, ( xBaudPending != pdFALSE ) ? "pending" : "confirmed" );
+		}
+		else
+		{
+			vCommandWriteUnsigned( &xWriter, huart3.Init.BaudRate, 0 );
+			vCommandWriteString( &xWriter, ( huart3.Init.OverSampling == UART_OVERSAMPLING_8 ) ? " baud, 8x oversampling, " : " baud, 16x oversampling, " );
+			vCommandWriteString( &xWriter, ( huart3.Init.HwFlowCtl == UART_HWCONTROL_RTS_CTS ) ? "RTS/CTS flow control" : "no flow control" );
+			vCommandWriteString( &xWriter, ( xBaudPending != pdFALSE ) ? ", not confirmed yet" : "" );
+		}
+		vCommandWriteString( &xWriter, "\r\n" );
+		return pdFALSE;
+	}
+
+	ulBaudRate = strtoul( pcParameter, &pcEnd, 10 );
+	if( ( pcEnd != ( pcParameter + xParameterStringLength ) ) || ( prvCalculateBaudRate( ulBaudRate, &ulBRR, &ulOverSampling ) != pdPASS ) )
+	{
+		vCommandWriteString( &xWriter, "Cannot make that baud rate from the " );
+		vCommandWriteUnsigned( &xWriter, HAL_RCC_GetPCLK1Freq(), 0 );
+		vCommandWriteString( &xWriter, " Hz UART clock\r\n" );
+		return pdFALSE;
+	}
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+	if( pcParameter != NULL )
+	{
+		if( ( xParameterStringLength != 7 ) || ( strncmp( pcParameter, "rts-cts", 7 ) != 0 ) )
+		{
+			vCommandWriteString( &xWriter, "Expected rts-cts\r\n" );
+			return pdFALSE;
+		}
+		ulHwFlowCtl = UART_HWCONTROL_RTS_CTS;
+	}
+
+	if( pxState->xStep == 0 )
+	{
+		if( xBaudPending != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, "The last switch has not been confirmed yet\r\n" );
+			return pdFALSE;
+		}
+
+		/* The enter that confirms a switch, pressed on its own, executes the
+		baud command that made it again. */
+		if( ( ulBaudRate == huart3.Init.BaudRate ) && ( ulHwFlowCtl == huart3.Init.HwFlowCtl ) )
+		{
+			vCommandWriteString( &xWriter, "Already at " );
+			vCommandWriteUnsigned( &xWriter, ulBaudRate, 0 );
+			vCommandWriteString( &xWriter, " baud\r\n" );
+			return pdFALSE;
+		}
+
+		/* Say what is about to happen while the terminal can still read it,
+		the switch is made on the next call once this has been sent. */
+		vCommandWriteString( &xWriter, "Switching to " );
+		vCommandWriteUnsigned( &xWriter, ulBaudRate, 0 );
+		vCommandWriteString( &xWriter, " baud, press enter at the new rate within 10 s to keep it\r\n" );
+		pxState->xStep = 1;
+		return pdTRUE;
+	}
+
+	( void ) prvWaitForOutputIdle( cmdCLOCK_DRAIN_WAIT );
+
+	if( xBaudFallbackTimer == NULL )
+	{
+		xBaudFallbackTimer = xTimerCreateStatic( "Baud", pdMS_TO_TICKS( cmdBAUD_CONFIRM_MS ), pdFALSE, NULL,
+												 prvBaudFallbackCallback, &xBaudFallbackTimerBuffer );
+		configASSERT( xBaudFallbackTimer );
+	}
+
+	/* The console lock is held, and the timer service task may be waiting for
+	it, so the timer command queue is not waited on. */
+	if( xTimerReset( xBaudFallbackTimer, 0 ) != pdPASS )
+	{
+		vCommandWriteString( &xWriter, "The confirmation timer could not be started, the baud rate was not changed\r\n" );
+		return pdFALSE;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		ulFallbackBaudRate = huart3.Init.BaudRate;
+		ulFallbackHwFlowCtl = huart3.Init.HwFlowCtl;
+		( void ) prvConfigureUART( ulBaudRate, ulHwFlowCtl );
+		xBaudPending = pdTRUE;
+	}
+	taskEXIT_CRITICAL();
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvConfigCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	static const char * const pcLabels[] = { "page", "used", "size", "keys", "compactions", "erase-pending" };
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	const char *pcParameter;
+	BaseType_t xParameterStringLength, xLength;
+	char cKey[ configstoreMAX_KEY_LENGTH + 1 ], cValue[ configstoreMAX_VALUE_LENGTH + 1 ];
+	ConfigStoreStats_t xStats;
+	uint32_t ulValues[ 6 ];
+	UBaseType_t uxRow;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( pcParameter == NULL )
+	{
+		vConfigStoreGetStats( &xStats );
+		ulValues[ 0 ] = ( uint32_t ) xStats.uxActivePage;
+		ulValues[ 1 ] = ( uint32_t ) xStats.xUsed;
+		ulValues[ 2 ] = ( uint32_t ) xStats.xSize;
+		ulValues[ 3 ] = ( uint32_t ) xStats.uxKeys;
+		ulValues[ 4 ] = xStats.ulCompactions;
+		ulValues[ 5 ] = ( uint32_t ) xStats.xErasePending;
+
+		for( uxRow = 0; uxRow < ( sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ); uxRow++ )
+		{
+			if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+			{
+				vCommandWriteString( &xWriter, pcLabels[ uxRow ] );
+				vCommandWriteChar( &xWriter, '\t' );
+			}
+			else
+			{
+				vCommandWriteStringPadded( &xWriter, pcLabels[ uxRow ], 16 );
+			}
+			vCommandWriteUnsigned( &xWriter, ulValues[ uxRow ], 0 );
+			vCommandWriteString( &xWriter, "\r\n" );
+		}
+		return pdFALSE;
+	}
+
+	if( ( xParameterStringLength == 4 ) && ( strncmp( pcParameter, "list", 4 ) == 0 ) )
+	{
+		/* One key is output per call.  uxIndex is the position in the
+		index of the store. */
+		if( pxState->xStep == 0 )
+		{
+			pxState->uxIndex = 0;
+			pxState->xStep = 1;
+		}
+
+		if( xConfigStoreNext( &( pxState->uxIndex ), cKey, sizeof( cKey ), cValue, sizeof( cValue ) ) == pdFALSE )
+		{
+			return pdFALSE;
+		}
+
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, cKey );
+			vCommandWriteChar( &xWriter, '\t' );
+		}
+		else
+		{
+			vCommandWriteStringPadded( &xWriter, cKey, configstoreMAX_KEY_LENGTH + 2 );
+		}
+		vCommandWriteString( &xWriter, cValue );
+		vCommandWriteString( &xWriter, "\r\n" );
+		return pdTRUE;
+	}
+
+	/* Everything else takes a key, which the store wants NULL terminated. */
+	xLength = xParameterStringLength;
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+	if( ( pcParameter == NULL ) || ( xParameterStringLength > configstoreMAX_KEY_LENGTH ) )
+	{
+		vCommandWriteString( &xWriter, "Expected a key of up to " );
+		vCommandWriteUnsigned( &xWriter, configstoreMAX_KEY_LENGTH, 0 );
+		vCommandWriteString( &xWriter, " characters\r\n" );
+		return pdFALSE;
+	}
+	memcpy( cKey, pcParameter, xParameterStringLength );
+	cKey[ xParameterStringLength ] = 0x00;
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+	if( ( xLength == 3 ) && ( strncmp( pcParameter, "get", 3 ) == 0 ) )
+	{
+		if( xConfigStoreGet( cKey, cValue, sizeof( cValue ) ) == pdFAIL )
+		{
+			vCommandWriteString( &xWriter, "Not set\r\n" );
+		}
+		else
+		{
+			vCommandWriteString( &xWriter, cValue );
+			vCommandWriteString( &xWriter, "\r\n" );
+		}
+	}
+	else if( ( xLength == 3 ) && ( strncmp( pcParameter, "set", 3 ) == 0 ) )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 3, &xParameterStringLength );
+		if( ( pcParameter == NULL ) || ( xParameterStringLength > configstoreMAX_VALUE_LENGTH ) )
+		{
+			vCommandWriteString( &xWriter, "Expected a value of up to " );
+			vCommandWriteUnsigned( &xWriter, configstoreMAX_VALUE_LENGTH, 0 );
+			vCommandWriteString( &xWriter, " characters\r\n" );
+			return pdFALSE;
+		}
+		memcpy( cValue, pcParameter, xParameterStringLength );
+		cValue[ xParameterStringLength ] = 0x00;
+
+		vCommandWriteString( &xWriter, ( xConfigStoreSet( cKey, cValue ) == pdPASS ) ? "Saved\r\n" : "Could not save, the store is full\r\n" );
+	}
+	else if( ( xLength == 6 ) && ( strncmp( pcParameter, "delete", 6 ) == 0 ) )
+	{
+		if( xConfigStoreGet( cKey, cValue, sizeof( cValue ) ) == pdFAIL )
+		{
+			vCommandWriteString( &xWriter, "Not set\r\n" );
+		}
+		else
+		{
+			vCommandWriteString( &xWriter, ( xConfigStoreSet( cKey, NULL ) == pdPASS ) ? "Deleted\r\n" : "Could not delete\r\n" );
+		}
+	}
+	else
+	{
+		vCommandWriteString( &xWriter, "Expected get, set, delete or list\r\n" );
+	}
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvUploadCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	static const char * const pcLabels[] = { "state", "length", "received", "programmed", "erased", "maximum-length", "install-pending" };
+	static const char * const pcStates[] = { "idle", "receiving", "committed", "failed" };
+	CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	FirmwareUpdateStatus_t xStatus;
+	uint32_t ulValues[ 7 ], ulLength, ulCRC;
+	UBaseType_t uxRow;
+	char *pcEnd;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( pcParameter == NULL )
+	{
+		vFirmwareUpdateGetStatus( &xStatus );
+		ulValues[ 1 ] = xStatus.ulLength;
+		ulValues[ 2 ] = xStatus.ulReceived;
+		ulValues[ 3 ] = xStatus.ulProgrammed;
+		ulValues[ 4 ] = xStatus.ulErased;
+		ulValues[ 5 ] = xStatus.ulMaximumLength;
+		ulValues[ 6 ] = ( uint32_t ) xStatus.xInstallPending;
+
+		for( uxRow = 0; uxRow < ( sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ); uxRow++ )
+		{
+			if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+			{
+				vCommandWriteString( &xWriter, pcLabels[ uxRow ] );
+				vCommandWriteChar( &xWriter, '\t' );
+			}
+			else
+			{
+				vCommandWriteStringPadded( &xWriter, pcLabels[ uxRow ], 16 );
+			}
+
+			if( uxRow == 0 )
+			{
+				vCommandWriteString( &xWriter, pcStates[ xStatus.eState ] );
+			}
+			else
+			{
+				vCommandWriteUnsigned( &xWriter, ulValues[ uxRow ], 0 );
+			}
+			vCommandWriteString( &xWriter, "\r\n" );
+		}
+		return pdFALSE;
+	}
+
+	if( ( xParameterStringLength == 5 ) && ( strncmp( pcParameter, "begin", 5 ) == 0 ) )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+		ulLength = ( pcParameter != NULL ) ? strtoul( pcParameter, &pcEnd, 0 ) : 0;
+		if( ( pcParameter == NULL ) || ( pcEnd != ( pcParameter + xParameterStringLength ) ) )
+		{
+			vCommandWriteString( &xWriter, "Expected the length of the image\r\n" );
+			return pdFALSE;
+		}
+
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 3, &xParameterStringLength );
+		ulCRC = ( pcParameter != NULL ) ? strtoul( pcParameter, &pcEnd, 16 ) : 0;
+		if( ( pcParameter == NULL ) || ( pcEnd != ( pcParameter + xParameterStringLength ) ) )
+		{
+			vCommandWriteString( &xWriter, "Expected the CRC-32 of the image in hex\r\n" );
+			return pdFALSE;
+		}
+
+		if( xFirmwareUpdateBegin( ulLength, ulCRC ) != pdPASS )
+		{
+			vCommandWriteString( &xWriter, "The image has to be 1 to " );
+			vFirmwareUpdateGetStatus( &xStatus );
+			vCommandWriteUnsigned( &xWriter, xStatus.ulMaximumLength, 0 );
+			vCommandWriteString( &xWriter, " bytes\r\n" );
+			return pdFALSE;
+		}
+
+		vCommandWriteString( &xWriter, "Send the image\r\n" );
+	}
+	else if( ( xParameterStringLength == 6 ) && ( strncmp( pcParameter, "commit", 6 ) == 0 ) )
+	{
+		vCommandWriteString( &xWriter, ( xFirmwareUpdateCommit() == pdPASS ) ? "The image is installed on the next reset\r\n" : "The image is incomplete or its CRC is wrong\r\n" );
+	}
+	else if( ( xParameterStringLength == 5 ) && ( strncmp( pcParameter, "abort", 5 ) == 0 ) )
+	{
+		vFirmwareUpdateAbort();
+		vCommandWriteString( &xWriter, "Upload aborted\r\n" );
+	}
+	else if( ( xParameterStringLength == 5 ) && ( strncmp( pcParameter, "reset", 5 ) == 0 ) )
+	{
+		/* The message is sent before the reset, on the next call. */
+		if( pxState->xStep == 0 )
+		{
+			vCommandWriteString( &xWriter, "Resetting\r\n" );
+			pxState->xStep = 1;
+			return pdTRUE;
+		}
+
+		vTaskDelay( cmdUPLOAD_RESET_DELAY );
+		NVIC_SystemReset();
+	}
+	else
+	{
+		vCommandWriteString( &xWriter, "Expected begin, commit, abort or reset\r\n" );
+	}
+
+	return pdFALSE;
+}
+
+static portBASE_TYPE prvGovernorCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	static const char * const pcLabels[] = { "budget-us", "commands", "throttled", "longest-us" };
+	const char *pcParameter;
+	BaseType_t xParameterStringLength;
+	CommandGovernorStats_t xStats;
+	uint32_t ulValues[ 4 ], ulBudget;
+	UBaseType_t uxRow;
+	char *pcEnd;
+	CommandWriter_t xWriter;
+
+	configASSERT( pcWriteBuffer );
+	vCommandWriterInit( &xWriter, pcWriteBuffer, xWriteBufferLen );
+
+	pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+	if( pcParameter != NULL )
+	{
+		if( ( xParameterStringLength != 6 ) || ( strncmp( pcParameter, "budget", 6 ) != 0 ) )
+		{
+			vCommandWriteString( &xWriter, "Expected budget\r\n" );
+			return pdFALSE;
+		}
+
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xParameterStringLength );
+		ulBudget = ( pcParameter != NULL ) ? strtoul( pcParameter, &pcEnd, 0 ) : 0;
+		if( ( pcParameter == NULL ) || ( pcEnd != ( pcParameter + xParameterStringLength ) ) )
+		{
+			vCommandWriteString( &xWriter, "Expected the budget in microseconds\r\n" );
+			return pdFALSE;
+		}
+
+		vCommandGovernorSetBudget( ulBudget );
+	}
+
+	vCommandGovernorGetStats( &xStats );
+	ulValues[ 0 ] = xStats.ulBudget;
+	ulValues[ 1 ] = xStats.ulCommands;
+	ulValues[ 2 ] = xStats.ulThrottled;
+	ulValues[ 3 ] = xStats.ulLongest;
+
+	for( uxRow = 0; uxRow < ( sizeof( pcLabels ) / sizeof( pcLabels[ 0 ] ) ); uxRow++ )
+	{
+		if( FreeRTOS_CLIIsMachineReadable() != pdFALSE )
+		{
+			vCommandWriteString( &xWriter, pcLabels[ uxRow ] );
+			vCommandWriteChar( &xWriter, '\t' );
+		}
+		else
+		{
+			vCommandWriteStringPadded( &xWriter, pcLabels[ uxRow ], 12 );
+		}
+		vCommandWriteUnsigned( &xWriter, ulValues[ uxRow ], 0 );
+		vCommandWriteString( &xWriter, "\r\n" );
+	}
+
+	return pdFALSE;
+}
+
+void CommandLineInterfaceStart( uint16_t usStackSize, unsigned portBASE_TYPE uxPriority )
+{
+#if( configCOMMAND_INT_STATIC_COMMANDS == 0 )
+	/* When the command table is built by the linker there is nothing to
+	register. */
+	FreeRTOS_CLIRegisterCommand( &xTaskStats );
+	FreeRTOS_CLIRegisterCommand( &xRunTimeStats );
+	FreeRTOS_CLIRegisterCommand( &xHeapStats );
+	FreeRTOS_CLIRegisterCommand( &xStackStats );
+	FreeRTOS_CLIRegisterCommand( &xPoolStats );
+	FreeRTOS_CLIRegisterCommand( &xRun );
+	FreeRTOS_CLIRegisterCommand( &xThreeParameterEcho );
+	FreeRTOS_CLIRegisterCommand( &xParameterEcho );
+	FreeRTOS_CLIRegisterCommand( &xLatency );
+	FreeRTOS_CLIRegisterCommand( &xTrace );
+	FreeRTOS_CLIRegisterCommand( &xWatch );
+	FreeRTOS_CLIRegisterCommand( &xBench );
+	FreeRTOS_CLIRegisterCommand( &xClock );
+	FreeRTOS_CLIRegisterCommand( &xBaud );
+	FreeRTOS_CLIRegisterCommand( &xConfig );
+	FreeRTOS_CLIRegisterCommand( &xUpload );
+	FreeRTOS_CLIRegisterCommand( &xGovernor );
+#endif
+
+	/* Create that task that handles the console itself. */
+	xTaskCreate( 	prvUARTCommandConsoleTask,			/* The task that implements the command console. */
+					"CLI",								/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+					usStackSize,						/* The size of the stack allocated to the task. */
+					NULL,								/* The parameter is not used, so NULL is passed. */
+					uxPriority,							/* The priority allocated to the task. */
+					NULL );								/* A handle is not required, so just pass NULL. */
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	if (huart->Instance == USART3)
+	{
+		/* Size is the position the DMA stream has written up to within the
+		circular buffer.  It is reported on the idle line, half transfer and
+		transfer complete events, and wraps back to the start of the buffer
+		after the transfer complete event. */
+		vLatencyUARTCallback();
+		if( Size >= xRxDmaPosition )
+		{
+			ulRxDmaWritten += ( uint32_t ) ( Size - xRxDmaPosition );
+		}
+		else
+		{
+			ulRxDmaWritten += ( uint32_t ) ( ( cmdRX_DMA_BUFFER_SIZE - xRxDmaPosition ) + Size );
+		}
+		xRxDmaPosition = ( ( size_t ) Size ) % cmdRX_DMA_BUFFER_SIZE;
+		xRxDmaHead = xRxDmaPosition;
+
+		/* Give the semaphore to unblock the task so it can drain everything
+		received up to xRxDmaHead in one go.  If a task is unblocked, and the
+		unblocked task has a priority above the currently running task, then
+		xHigherPriorityTaskWoken will be set to pdTRUE inside the
+		xSemaphoreGiveFromISR() function. */
+		xSemaphoreGiveFromISR( xRxCompleteSemaphore, &xHigherPriorityTaskWoken );
+
+		/* portEND_SWITCHING_ISR() or portYIELD_FROM_ISR() can be used here. */
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	if (huart->Instance == USART3)
+	{
+		/* An overrun, framing or noise error aborts the DMA reception.  Ask the
+		task to restart it. */
+		vTraceLog( "USART3 error 0x%x", huart->ErrorCode, 0, 0, 0 );
+		xRxRestartRequired = pdTRUE;
+		xSemaphoreGiveFromISR( xRxCompleteSemaphore, &xHigherPriorityTaskWoken );
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}
+}
+
+/* Must be called from the TX complete interrupt or with that interrupt
+masked. */
+static void prvStartTransmission( void )
+{
+size_t xHead = xTxHead, xTail = xTxTail, xLength;
+const TxReference_t *pxReference = NULL;
+
+	if( xTxInFlight != 0 )
+	{
+		return;
+	}
+
+	/* The ring buffer is only sent up to the next reference. */
+	if( xTxReferenceTail != xTxReferenceHead )
+	{
+		pxReference = &( xTxReferences[ xTxReferenceTail ] );
+		xHead = pxReference->xRingPosition;
+	}
+
+	if( ( pxReference != NULL ) && ( xHead == xTail ) )
+	{
+		/* Everything queued before the reference has been sent.  A long
+		reference is sent by several transfers. */
+		xLength = pxReference->xLength - xTxReferenceSent;
+		if( xLength > UINT16_MAX )
+		{
+			xLength = UINT16_MAX;
+		}
+
+		xTxInFlight = xLength;
+		xTxInFlightReference = pdTRUE;
+
+		if( HAL_UART_Transmit_DMA( &huart3, ( uint8_t * ) &( pxReference->pucData[ xTxReferenceSent ] ), ( uint16_t ) xLength ) != HAL_OK )
+		{
+			xTxInFlight = 0;
+			xTxInFlightReference = pdFALSE;
+		}
+	}
+	else if( xHead != xTail )
+	{
+		/* Send up to the head, or up to the end of the buffer if the data
+		wraps.  The wrapped part is sent by the next transfer. */
+		if( xHead > xTail )
+		{
+			xLength = xHead - xTail;
+		}
+		else
+		{
+			xLength = cmdTX_BUFFER_SIZE - xTail;
+		}
 
-/* Dimensions the buffer into which input characters are placed. */
-#define cmdMAX_INPUT_SIZE		50
+		xTxInFlight = xLength;
 
-/* The maximum time in ticks to wait for the UART access mutex. */
-#define cmdMAX_MUTEX_WAIT		( 200 / portTICK_PERIOD_MS )
+		if( HAL_UART_Transmit_DMA( &huart3, &ucTxBuffer[ xTail ], ( uint16_t ) xLength ) != HAL_OK )
+		{
+			xTxInFlight = 0;
+		}
+	}
+}
 
-/* Characters are only ever received slowly on the CLI so it is ok to pass
-received characters from the UART interrupt to the task on a queue.  This sets
-the length of the queue used for that purpose. */
-#define cmdRXED_CHARS_QUEUE_LENGTH			( 10 )
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-/* DEL acts as a backspace. */
-#define cmdASCII_DEL		( 0x7F )
+	if (huart->Instance == USART3)
+	{
+		/* Release the space used by the transfer that just completed and
+		chain the next transfer if more output was queued meanwhile. */
+		if( xTxInFlightReference != pdFALSE )
+		{
+			xTxReferenceSent += xTxInFlight;
+			if( xTxReferenceSent == xTxReferences[ xTxReferenceTail ].xLength )
+			{
+				xTxReferenceSent = 0;
+				xTxReferenceTail = ( xTxReferenceTail + 1 ) % cmdTX_REFERENCES;
+			}
+			xTxInFlightReference = pdFALSE;
+		}
+		else
+		{
+			xTxTail = ( xTxTail + xTxInFlight ) % cmdTX_BUFFER_SIZE;
+		}
+		xTxInFlight = 0;
+		prvStartTransmission();
 
-/* Const messages output by the command console. */
-static char * const pcWelcomeMessage = "\r\n\r\nFreeRTOS command server.\r\nType Help to view a list of registered commands.\r\n\r\n>";
-static const char * const pcEndOfOutputMessage = "\r\n[Press ENTER to execute the previous command again]\r\n>";
-static const char * const pcNewLine = "\r\n";
+		/* Give the semaphore  to unblock the task if it is waiting for space
+		in the ring buffer, or in the queue of references.  If a task is unblocked, and the unblocked task has a
+		priority above the currently running task, then xHigherPriorityTaskWoken
+		will be set to pdTRUE inside the xSemaphoreGiveFromISR() function. */
+		xSemaphoreGiveFromISR( xTxCompleteSemaphore, &xHigherPriorityTaskWoken );
 
-extern UART_HandleTypeDef huart3;
+		/* portEND_SWITCHING_ISR() or portYIELD_FROM_ISR() can be used here. */
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}
+}
 
-/* This semaphore is used to allow the task to wait for a Tx to complete
-without wasting any CPU time. */
-static SemaphoreHandle_t xTxCompleteSemaphore = NULL;
+static void prvFlushOutput( void )
+{
+	taskENTER_CRITICAL();
+	{
+		prvStartTransmission();
+	}
+	taskEXIT_CRITICAL();
+}
 
-/* This semaphore is sued to allow the task to wait for an Rx to complete
-without wasting any CPU time. */
-static SemaphoreHandle_t xRxCompleteSemaphore = NULL;
+static BaseType_t prvSendBuffer( const char * pcBuffer, size_t xBufferLength )
+{
+size_t xHead, xSpace, xChunk;
+BaseType_t xReturn = pdPASS;
 
-static void prvUARTCommandConsoleTask( void *pvParameters );
+	while( xBufferLength > 0 )
+	{
+		xHead = xTxHead;
 
-/*
- * Implements the run-time-stats command.
- */
-static portBASE_TYPE prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+		/* One byte is always left unused so a full ring can be told apart
+		from an empty one. */
+		xSpace = ( xTxTail + cmdTX_BUFFER_SIZE - xHead - 1 ) % cmdTX_BUFFER_SIZE;
 
-/*
- * Implements the task-stats command.
- */
-static portBASE_TYPE prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+		if( xSpace == 0 )
+		{
+			/* The ring buffer is full.  Make sure it is being drained then wait
+			for the current transfer to complete. */
+			prvFlushOutput();
+
+			if( xSemaphoreTake( xTxCompleteSemaphore, cmdMAX_TX_WAIT ) != pdPASS )
+			{
+				/* The UART is not making progress.  Drop the rest of the
+				output rather than blocking the console indefinitely. */
+				ulTxDroppedBytes += xBufferLength;
+				xReturn = pdFAIL;
+				break;
+			}
 
-/*
- * Implements the echo-three-parameters command.
- */
-static portBASE_TYPE prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+			continue;
+		}
 
-/*
- * Implements the echo-parameters command.
- */
-static portBASE_TYPE prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+		/* Copy as much as fits before the end of the buffer, the rest is copied
+		on the next iteration. */
+		xChunk = cmdTX_BUFFER_SIZE - xHead;
+		if( xChunk > xSpace )
+		{
+			xChunk = xSpace;
+		}
+		if( xChunk > xBufferLength )
+		{
+			xChunk = xBufferLength;
+		}
 
+		memcpy( &ucTxBuffer[ xHead ], pcBuffer, xChunk );
+		xTxHead = ( xHead + xChunk ) % cmdTX_BUFFER_SIZE;
 
-/* Structure that defines the "run-time-stats" command line command.   This
-generates a table that shows how much run time each task has */
-static const CLI_Command_Definition_t xRunTimeStats =
-{
-	"run-time-stats", /* The command string to type. */
-	"\r\nrun-time-stats:\r\n Displays a table showing how much processing time each FreeRTOS task has used\r\n",
-	prvRunTimeStatsCommand, /* The function to run. */
-	0 /* No parameters are expected. */
-};
+		pcBuffer += xChunk;
+		xBufferLength -= xChunk;
+	}
 
-/* Structure that defines the "task-stats" command line command.  This generates
-a table that gives information on each task in the system. */
-static const CLI_Command_Definition_t xTaskStats =
-{
-	"task-stats", /* The command string to type. */
-	"\r\ntask-stats:\r\n Displays a table showing the state of each FreeRTOS task\r\n",
-	prvTaskStatsCommand, /* The function to run. */
-	0 /* No parameters are expected. */
-};
+	return xReturn;
+}
 
-/* Structure that defines the "echo_3_parameters" command line command.  This
-takes exactly three parameters that the command simply echos back one at a
-time. */
-static const CLI_Command_Definition_t xThreeParameterEcho =
+static BaseType_t prvSendReference( const char * pcBuffer, size_t xBufferLength )
 {
-	"echo-3-parameters",
-	"\r\necho-3-parameters <param1> <param2> <param3>:\r\n Expects three parameters, echos each in turn\r\n",
-	prvThreeParameterEchoCommand, /* The function to run. */
-	3 /* Three parameters are expected, which can take any value. */
-};
+size_t xNext;
 
-/* Structure that defines the "echo_parameters" command line command.  This
-takes a variable number of parameters that the command simply echos back one at
-a time. */
-static const CLI_Command_Definition_t xParameterEcho =
-{
-	"echo-parameters",
-	"\r\necho-parameters <...>:\r\n Take variable number of parameters, echos each in turn\r\n",
-	prvParameterEchoCommand, /* The function to run. */
-	-1 /* The user can enter any number of commands. */
-};
+	if( xBufferLength < cmdTX_MIN_REFERENCE )
+	{
+		return prvSendBuffer( pcBuffer, xBufferLength );
+	}
 
-static portBASE_TYPE prvTaskStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
-{
-	const char *const pcHeader =
-			"Task          State  Priority  Stack	#\r\n************************************************\r\n";
-	// Make sure the write buffer does not contain a string.
+	/* One entry is always left unused, as in the ring buffer. */
+	xNext = ( xTxReferenceHead + 1 ) % cmdTX_REFERENCES;
+	while( xNext == xTxReferenceTail )
+	{
+		prvFlushOutput();
+
+		if( xSemaphoreTake( xTxCompleteSemaphore, cmdMAX_TX_WAIT ) != pdPASS )
+		{
+			ulTxDroppedBytes += xBufferLength;
+			return pdFAIL;
+		}
+	}
 
-	/* Remove compile time warnings about unused parameters, and check the
-	 write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	 write buffer length is adequate, so does not check for buffer overflows. */
-	(void) pcCommandString;
-	(void) xWriteBufferLen;
+	/* The DMA stream reads the data from memory, so data in cacheable RAM
+	has to be written back first.  Constants in flash are never in the cache
+	dirty. */
+	if( ( ( uint32_t ) pcBuffer < FLASH_BASE ) || ( ( uint32_t ) pcBuffer > FLASH_END ) )
+	{
+		SCB_CleanDCache_by_Addr( ( uint32_t * ) ( ( uint32_t ) pcBuffer & ~31UL ), ( int32_t ) ( xBufferLength + ( ( uint32_t ) pcBuffer & 31UL ) ) );
+	}
 
-	/* Generate a table of task stats. */
-	strcpy( pcWriteBuffer, pcHeader );
-	vTaskList( pcWriteBuffer + strlen( pcHeader ) );
+	xTxReferences[ xTxReferenceHead ].pucData = ( const uint8_t * ) pcBuffer;
+	xTxReferences[ xTxReferenceHead ].xLength = xBufferLength;
+	xTxReferences[ xTxReferenceHead ].xRingPosition = xTxHead;
+	xTxReferenceHead = xNext;
 
-	/* There is no more data to return after this single string, so return
-	 pdFALSE. */
-	return pdFALSE;
+	return pdPASS;
 }
 
-static portBASE_TYPE prvRunTimeStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static void prvStartReception( void )
 {
-	const char * const pcHeader = "Task            Abs Time      % Time\r\n****************************************\r\n";
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
+HAL_StatusTypeDef xStatus;
 
-	/* Generate a table of task stats. */
-	strcpy( pcWriteBuffer, pcHeader );
-	vTaskGetRunTimeStats( pcWriteBuffer + strlen( pcHeader ) );
+	/* Errors the HAL does not treat as fatal leave the reception running, in
+	which case it would refuse to start it again. */
+	( void ) HAL_UART_AbortReceive( &huart3 );
 
-	/* There is no more data to return after this single string, so return
-	pdFALSE. */
-	return pdFALSE;
+	xRxDmaHead = 0;
+	xRxDmaTail = 0;
+	xRxDmaPosition = 0;
+	ulRxDmaWritten = 0;
+	ulRxConsumed = 0;
+	xRxRestartRequired = pdFALSE;
+
+	xStatus = HAL_UARTEx_ReceiveToIdle_DMA( &huart3, ucRxDmaBuffer, sizeof( ucRxDmaBuffer ) );
+	if( xStatus != HAL_OK )
+	{
+		vTraceLog( "USART3 RX start failed %u", ( uint32_t ) xStatus, 0, 0, 0 );
+		xRxRestartRequired = pdTRUE;
+	}
 }
 
-static portBASE_TYPE prvThreeParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static BaseType_t prvWaitForOutputIdle( TickType_t xTicksToWait )
 {
-	const char *pcParameter;
-	portBASE_TYPE xParameterStringLength, xReturn;
-	static portBASE_TYPE lParameterNumber = 0;
+TimeOut_t xTimeOut;
 
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
+	prvFlushOutput();
 
-	if( lParameterNumber == 0 )
+	vTaskSetTimeOutState( &xTimeOut );
+	while( ( xTxHead != xTxTail ) || ( xTxReferenceHead != xTxReferenceTail ) || ( xTxInFlight != 0 ) ||
+		   ( __HAL_UART_GET_FLAG( &huart3, UART_FLAG_TC ) == RESET ) )
 	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "The three parameters were:\r\n" );
-
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		lParameterNumber = 1L;
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+		{
+			return pdFAIL;
+		}
 
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
+		vTaskDelay( 1 );
 	}
-	else
-	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-							(
-								pcCommandString,		/* The command string itself. */
-								lParameterNumber,		/* Return the next parameter. */
-								&xParameterStringLength	/* Store the parameter string length. */
-							);
 
-		/* Sanity check something was returned. */
-		configASSERT( pcParameter );
+	return pdPASS;
+}
 
-		/* Return the parameter string. */
-		memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-		sprintf( pcWriteBuffer, "%d: ", ( int ) lParameterNumber );
-		strncat( pcWriteBuffer, pcParameter, xParameterStringLength );
-		strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
+void vCommandLineInterfaceClockChanged( void )
+{
+	/* Called from main() before MX_USART3_UART_Init() too. */
+	if( huart3.gState == HAL_UART_STATE_RESET )
+	{
+		return;
+	}
 
-		/* If this is the last of the three parameters then there are no more
-		strings to return after this one. */
-		if( lParameterNumber == 3L )
-		{
-			/* If this is the last of the three parameters then there are no more
-			strings to return after this one. */
-			xReturn = pdFALSE;
-			lParameterNumber = 0L;
-		}
-		else
+	/* A fast rate may not be reachable from a slower PCLK1.  The rate set up
+	by MX_USART3_UART_Init() always is. */
+	taskENTER_CRITICAL();
+	{
+		if( prvConfigureUART( huart3.Init.BaudRate, huart3.Init.HwFlowCtl ) != pdPASS )
 		{
-			/* There are more parameters to return after this one. */
-			xReturn = pdTRUE;
-			lParameterNumber++;
+			( void ) prvConfigureUART( 115200, UART_HWCONTROL_NONE );
 		}
 	}
-
-	return xReturn;
+	taskEXIT_CRITICAL();
 }
 
-static portBASE_TYPE prvParameterEchoCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static BaseType_t prvCalculateBaudRate( uint32_t ulBaudRate, uint32_t *pulBRR, uint32_t *pulOverSampling )
 {
-	const char *pcParameter;
-	portBASE_TYPE xParameterStringLength, xReturn;
-	static portBASE_TYPE lParameterNumber = 0;
+uint32_t ulClock = HAL_RCC_GetPCLK1Freq(), ulDivider, ulActual, ulError;
+UBaseType_t uxOverSampling;
 
-	/* Remove compile time warnings about unused parameters, and check the
-	write buffer is not NULL.  NOTE - for simplicity, this example assumes the
-	write buffer length is adequate, so does not check for buffer overflows. */
-	( void ) pcCommandString;
-	( void ) xWriteBufferLen;
-	configASSERT( pcWriteBuffer );
-
-	if( lParameterNumber == 0 )
+	if( ulBaudRate == 0 )
 	{
-		/* The first time the function is called after the command has been
-		entered just a header string is returned. */
-		sprintf( pcWriteBuffer, "The parameters were:\r\n" );
-
-		/* Next time the function is called the first parameter will be echoed
-		back. */
-		lParameterNumber = 1L;
-
-		/* There is more data to be returned as no parameters have been echoed
-		back yet. */
-		xReturn = pdPASS;
+		return pdFAIL;
 	}
-	else
+
+	/* USARTDIV is the UART clock, times 2 for 8x oversampling, divided by the
+	baud rate, and must be at least 16 in both cases. */
+	for( uxOverSampling = 16; uxOverSampling >= 8; uxOverSampling -= 8 )
 	{
-		/* Obtain the parameter string. */
-		pcParameter = FreeRTOS_CLIGetParameter
-							(
-								pcCommandString,		/* The command string itself. */
-								lParameterNumber,		/* Return the next parameter. */
-								&xParameterStringLength	/* Store the parameter string length. */
-							);
+		ulDivider = ( ( ulClock * ( 16 / uxOverSampling ) ) + ( ulBaudRate / 2 ) ) / ulBaudRate;
+		if( ulDivider < 16 )
+		{
+			continue;
+		}
 
-		if( pcParameter != NULL )
+		ulActual = ( ulClock * ( 16 / uxOverSampling ) ) / ulDivider;
+		ulError = ( ulActual > ulBaudRate ) ? ( ulActual - ulBaudRate ) : ( ulBaudRate - ulActual );
+		if( ( ulError / ( ( ulBaudRate / 1000UL ) + 1 ) ) > cmdBAUD_MAX_ERROR )
 		{
-			/* Return the parameter string. */
-			memset( pcWriteBuffer, 0x00, xWriteBufferLen );
-			sprintf( pcWriteBuffer, "%d: ", ( int ) lParameterNumber );
-			strncat( pcWriteBuffer, pcParameter, xParameterStringLength );
-			strncat( pcWriteBuffer, "\r\n", strlen( "\r\n" ) );
+			continue;
+		}
 
-			/* There might be more parameters to return after this one. */
-			xReturn = pdTRUE;
-			lParameterNumber++;
+		if( uxOverSampling == 16 )
+		{
+			*pulBRR = ulDivider;
+			*pulOverSampling = UART_OVERSAMPLING_16;
 		}
 		else
 		{
-			/* No more parameters were found.  Make sure the write buffer does
-			not contain a valid string. */
-			pcWriteBuffer[ 0 ] = 0x00;
-
-			/* No more data to return. */
-			xReturn = pdFALSE;
-
-			/* Start over the next time this command is executed. */
-			lParameterNumber = 0;
+			/* With 8x oversampling the fraction is three bits, right
+			aligned. */
+			*pulBRR = ( ulDivider & 0xFFF0UL ) | ( ( ulDivider & 0x000FUL ) >> 1 );
+			*pulOverSampling = UART_OVERSAMPLING_8;
 		}
+		return pdPASS;
 	}
 
-	return xReturn;
+	return pdFAIL;
 }
 
-void CommandLineInterfaceStart( uint16_t usStackSize, unsigned portBASE_TYPE uxPriority )
+static BaseType_t prvConfigureUART( uint32_t ulBaudRate, uint32_t ulHwFlowCtl )
 {
-	FreeRTOS_CLIRegisterCommand( &xTaskStats );
-	FreeRTOS_CLIRegisterCommand( &xRunTimeStats );
-	FreeRTOS_CLIRegisterCommand( &xThreeParameterEcho );
-	FreeRTOS_CLIRegisterCommand( &xParameterEcho );
+uint32_t ulBRR, ulOverSampling;
+GPIO_InitTypeDef xGPIOInit = { 0 };
 
-	/* Create that task that handles the console itself. */
-	xTaskCreate( 	prvUARTCommandConsoleTask,			/* The task that implements the command console. */
-					"CLI",								/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
-					usStackSize,						/* The size of the stack allocated to the task. */
-					NULL,								/* The parameter is not used, so NULL is passed. */
-					uxPriority,							/* The priority allocated to the task. */
-					NULL );								/* A handle is not required, so just pass NULL. */
+	if( prvCalculateBaudRate( ulBaudRate, &ulBRR, &ulOverSampling ) != pdPASS )
+	{
+		return pdFAIL;
+	}
+
+	if( ( ulHwFlowCtl == UART_HWCONTROL_RTS_CTS ) && ( huart3.Init.HwFlowCtl != UART_HWCONTROL_RTS_CTS ) )
+	{
+		/* CTS is pulled up, so transmission stops, and the switch is not
+		confirmed, if nothing drives it. */
+		xGPIOInit.Pin = cmdUART_CTS_PIN | cmdUART_RTS_PIN;
+		xGPIOInit.Mode = GPIO_MODE_AF_PP;
+		xGPIOInit.Pull = GPIO_PULLUP;
+		xGPIOInit.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+		xGPIOInit.Alternate = GPIO_AF7_USART3;
+		HAL_GPIO_Init( cmdUART_FLOW_CONTROL_PORT, &xGPIOInit );
+	}
+	else if( ( ulHwFlowCtl != UART_HWCONTROL_RTS_CTS ) && ( huart3.Init.HwFlowCtl == UART_HWCONTROL_RTS_CTS ) )
+	{
+		HAL_GPIO_DeInit( cmdUART_FLOW_CONTROL_PORT, cmdUART_CTS_PIN | cmdUART_RTS_PIN );
+	}
+
+	/* USART3 is clocked by PCLK1, see HAL_UART_MspInit().  BRR, OVER8 and the
+	flow control bits can only be written while the UART is disabled, which
+	does not stop the DMA streams.  Characters received during the switch are
+	garbage, the errors they cause restart the reception. */
+	__HAL_UART_DISABLE( &huart3 );
+	MODIFY_REG( huart3.Instance->CR1, USART_CR1_OVER8, ulOverSampling );
+	MODIFY_REG( huart3.Instance->CR3, USART_CR3_RTSE | USART_CR3_CTSE, ulHwFlowCtl );
+	huart3.Instance->BRR = ulBRR;
+	__HAL_UART_ENABLE( &huart3 );
+
+	huart3.Init.BaudRate = ulBaudRate;
+	huart3.Init.OverSampling = ulOverSampling;
+	huart3.Init.HwFlowCtl = ulHwFlowCtl;
+
+	return pdPASS;
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+static void prvBaudFallbackCallback( TimerHandle_t xTimer )
 {
-	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+BaseType_t xReverted = pdFALSE;
 
-	if (huart->Instance == USART3)
-	{
-		/* Give the semaphore  to unblock any tasks that might be waiting for an Rx
-		to complete.  If a task is unblocked, and the unblocked task has a priority
-		above the currently running task, then xHigherPriorityTaskWoken will be set
-		to pdTRUE inside the xSemaphoreGiveFromISR() function. */
-		xSemaphoreGiveFromISR( xRxCompleteSemaphore, &xHigherPriorityTaskWoken );
+	( void ) xTimer;
 
-		/* portEND_SWITCHING_ISR() or portYIELD_FROM_ISR() can be used here. */
-		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	taskENTER_CRITICAL();
+	{
+		if( xBaudPending != pdFALSE )
+		{
+			xBaudPending = pdFALSE;
+			xReverted = prvConfigureUART( ulFallbackBaudRate, ulFallbackHwFlowCtl );
+		}
+	}
+	taskEXIT_CRITICAL();
 
+	if( xReverted != pdFALSE )
+	{
+		vTraceLog( "USART3 back to %u baud", ulFallbackBaudRate, 0, 0, 0 );
+		xBaudReverted = pdTRUE;
+		( void ) xSemaphoreGive( xRxCompleteSemaphore );
 	}
 }
 
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+static void prvCheckBaudConfirmation( const uint8_t *pucData, size_t xLength )
 {
-	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-
-	if (huart->Instance == USART3)
+	if( ( xBaudPending == pdFALSE ) || ( memchr( pucData, '\r', xLength ) == NULL ) )
 	{
-		/* Give the semaphore  to unblock any tasks that might be waiting for a Tx
-		to complete.  If a task is unblocked, and the unblocked task has a priority
-		above the currently running task, then xHigherPriorityTaskWoken will be set
-		to pdTRUE inside the xSemaphoreGiveFromISR() function. */
-		xSemaphoreGiveFromISR( xTxCompleteSemaphore, &xHigherPriorityTaskWoken );
+		return;
+	}
 
-		/* portEND_SWITCHING_ISR() or portYIELD_FROM_ISR() can be used here. */
-		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	taskENTER_CRITICAL();
+	{
+		xBaudPending = pdFALSE;
 	}
+	taskEXIT_CRITICAL();
+
+	/* A late expiry finds nothing pending. */
+	xTimerStop( xBaudFallbackTimer, 0 );
 }
 
-static void prvSendBuffer(const char * pcBuffer, size_t xBufferLength )
+static BaseType_t prvUARTWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
 {
-	const TickType_t xBlockMax100ms = 100UL / portTICK_PERIOD_MS;
+	( void ) pvTransport;
+	return prvSendBuffer( pcBuffer, xBufferLength );
+}
+/*-----------------------------------------------------------*/
 
-	if( xBufferLength > 0 )
-	{
-		HAL_UART_Transmit_IT(&huart3, (uint8_t*)pcBuffer, xBufferLength);
-		/* Wait for the Tx to complete so the buffer can be reused without
-		corrupting the data that is being sent. */
-		xSemaphoreTake( xTxCompleteSemaphore, xBlockMax100ms );
-	}
+static void prvUARTFlush( void *pvTransport )
+{
+	( void ) pvTransport;
+	prvFlushOutput();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUARTWriteReference( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
+{
+	( void ) pvTransport;
+	return prvSendReference( pcBuffer, xBufferLength );
 }
+/*-----------------------------------------------------------*/
 
 static void prvUARTCommandConsoleTask( void *pvParameters )
 {
-	char cRxedChar, *pcOutputString;
-	uint8_t ucInputIndex = 0;
-	static char cInputString[cmdMAX_INPUT_SIZE], cLastInputString[cmdMAX_INPUT_SIZE];
-	portBASE_TYPE xReturned;
+	static const char * const pcBaudRevertedMessage = "\r\nThe new baud rate was not confirmed\r\n";
+	size_t xRxHead;
+	uint32_t ulRxWritten;
+	BaseType_t xReceived;
 
 	(void) pvParameters;
 
@@ -378,80 +2860,85 @@ static void prvUARTCommandConsoleTask( void *pvParameters )
 	xSemaphoreTake( xTxCompleteSemaphore, 0 );
 	xSemaphoreTake( xRxCompleteSemaphore, 0 );
 
-	/* Obtain the address of the output buffer.  Note there is no mutual
-	 exclusion on this buffer as it is assumed only one command console
-	 interface will be used at any one time. */
-	pcOutputString = FreeRTOS_CLIGetOutputBuffer();
+	/* The UART console generates its output into the buffer provided by the
+	command interpreter.  Consoles on other transports bring their own buffers,
+	so they can run at the same time as this one. */
+	vCommandConsoleInit(&xUARTConsole, &xUARTTransport, NULL,
+			FreeRTOS_CLIGetOutputBuffer(), configCOMMAND_INT_MAX_OUTPUT_SIZE);
+
+	/* The UART passes every byte value through, so test clients can use the
+	framed protocol on it. */
+	vCommandConsoleEnableFrames(&xUARTConsole);
 
 	/* Send the welcome message. */
-	prvSendBuffer(pcWelcomeMessage, strlen(pcWelcomeMessage));
+	vCommandConsoleStart(&xUARTConsole);
+
+	/* The DMA stream runs continuously from now on, so characters that arrive
+	while a command is executing are not lost. */
+	prvStartReception();
 
 	for (;;) {
-		/* Wait for the next character to arrive.  A semaphore is used to
-		 ensure no CPU time is used until data has arrived. */
-		// Receive interrupt and give semaphore. //usart_read_buffer_job(&xCDCUsart, (uint8_t*) &cRxedChar, sizeof(cRxedChar));
-		HAL_UART_Receive_IT(&huart3, (uint8_t*)&cRxedChar, sizeof(cRxedChar));
-		if (xSemaphoreTake(xRxCompleteSemaphore, portMAX_DELAY) == pdPASS) {
-			/* Echo the character back. */
-			prvSendBuffer(&cRxedChar, sizeof(cRxedChar));
-
-			/* Was it the end of the line? */
-			if (cRxedChar == '\n' || cRxedChar == '\r') {
-				/* Just to space the output from the input. */
-				prvSendBuffer(pcNewLine, strlen(pcNewLine));
-
-				/* See if the command is empty, indicating that the last command is
-				 to be executed again. */
-				if (ucInputIndex == 0) {
-					/* Copy the last command back into the input string. */
-					strcpy(cInputString, cLastInputString);
-				}
+		/* Wait for characters to arrive.  A semaphore is used to ensure no CPU
+		 time is used until data has arrived, and it is given once per burst
+		 rather than once per character. */
+		xReceived = xSemaphoreTake(xRxCompleteSemaphore,
+				(xRxRestartRequired != pdFALSE) ? cmdRX_RESTART_DELAY : portMAX_DELAY);
+
+		if (xRxRestartRequired != pdFALSE) {
+			/* The reception was aborted by a UART error, or could not be
+			 started last time.  Anything still in the buffer is suspect, so
+			 discard it. */
+			vCommandConsoleInputLost(&xUARTConsole);
+			prvStartReception();
+			continue;
+		}
 
-				/* Pass the received command to the command interpreter.  The
-				 command interpreter is called repeatedly until it returns pdFALSE
-				 (indicating there is no more output) as it might generate more than
-				 one string. */
-				do {
-					/* Get the next output string from the command interpreter. */
-					xReturned = FreeRTOS_CLIProcessCommand(cInputString,
-							pcOutputString, configCOMMAND_INT_MAX_OUTPUT_SIZE);
-
-					/* Write the generated string to the UART. */
-					prvSendBuffer(pcOutputString, strlen(pcOutputString));
-
-				} while (xReturned != pdFALSE);
-
-				/* All the strings generated by the input command have been sent.
-				 Clear the input	string ready to receive the next command.  Remember
-				 the command that was just processed first in case it is to be
-				 processed again. */
-				strcpy(cLastInputString, cInputString);
-				ucInputIndex = 0;
-				memset(cInputString, 0x00, cmdMAX_INPUT_SIZE);
-
-				prvSendBuffer(pcEndOfOutputMessage, strlen(pcEndOfOutputMessage));
-			} else {
-				if (cRxedChar == '\r') {
-					/* Ignore the character. */
-				} else if ((cRxedChar == '\b') || (cRxedChar == cmdASCII_DEL)) {
-					/* Backspace was pressed.  Erase the last character in the
-					 string - if any. */
-					if (ucInputIndex > 0) {
-						ucInputIndex--;
-						cInputString[ucInputIndex] = '\0';
-					}
-				} else {
-					/* A character was entered.  Add it to the string
-					 entered so far.  When a \n is entered the complete
-					 string will be passed to the command interpreter. */
-					if ((cRxedChar >= ' ') && (cRxedChar <= '~')) {
-						if (ucInputIndex < cmdMAX_INPUT_SIZE) {
-							cInputString[ucInputIndex] = cRxedChar;
-							ucInputIndex++;
-						}
-					}
-				}
-			}
+		if (xBaudReverted != pdFALSE) {
+			/* The fallback timer put the old baud rate back.  Any characters
+			 received with it are read as usual. */
+			xBaudReverted = pdFALSE;
+			(void) xCommandConsoleWriteBackground(&xUARTConsole, xUARTConsole.ulGeneration, pcBaudRevertedMessage,
+					strlen(pcBaudRevertedMessage));
+		}
+
+		if (xReceived != pdPASS) {
+			continue;
+		}
+		vLatencyUARTTaskResumed();
+
+		taskENTER_CRITICAL();
+		{
+			xRxHead = xRxDmaHead;
+			ulRxWritten = ulRxDmaWritten;
+		}
+		taskEXIT_CRITICAL();
+
+		if ((ulRxWritten - ulRxConsumed) >= cmdRX_DMA_BUFFER_SIZE) {
+			/* The DMA stream has gone round the buffer past characters that
+			 were not processed yet, so what is left of them is mixed with
+			 newer ones.  Drop it all, along with any frame they were part
+			 of. */
+			vTraceLog("USART3 RX overrun, %u characters dropped", ulRxWritten - ulRxConsumed, 0, 0, 0);
+			xRxDmaTail = xRxHead;
+			ulRxConsumed = ulRxWritten;
+			vCommandConsoleInputLost(&xUARTConsole);
+			continue;
+		}
+		ulRxConsumed = ulRxWritten;
+
+		/* Pass everything the DMA stream has written so far to the console,
+		 in two parts if the data wraps around the end of the buffer. */
+		if (xRxHead < xRxDmaTail) {
+			prvCheckBaudConfirmation(&ucRxDmaBuffer[xRxDmaTail], cmdRX_DMA_BUFFER_SIZE - xRxDmaTail);
+			vCommandConsoleInput(&xUARTConsole, (const char *) &ucRxDmaBuffer[xRxDmaTail],
+					cmdRX_DMA_BUFFER_SIZE - xRxDmaTail);
+			xRxDmaTail = 0;
+		}
+		if (xRxHead > xRxDmaTail) {
+			prvCheckBaudConfirmation(&ucRxDmaBuffer[xRxDmaTail], xRxHead - xRxDmaTail);
+			vCommandConsoleInput(&xUARTConsole, (const char *) &ucRxDmaBuffer[xRxDmaTail],
+					xRxHead - xRxDmaTail);
+			xRxDmaTail = xRxHead;
 		}
 	}
 }
@@ -0,0 +1,357 @@
+/*
+ * CommandWatch.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandWatch.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "timers.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+#include "CommandWorker.h"
+
+/* Room for the header that starts the output of an execution, which holds the
+command line, and the index of a row. */
+#define watchPREFIX_SIZE		( cmdMAX_INPUT_SIZE + 48 )
+
+/* A console watching a command.  The members are shared by the task of the
+console, which starts and stops the watch, the timer service task, which starts
+each execution, and the worker task executing it, so are only changed in
+critical sections. */
+typedef struct xCOMMAND_WATCH
+{
+	CommandConsole_t *pxConsole;			/* NULL if the watch is not in use. */
+	uint32_t ulGeneration;					/* The generation of the console when the watch was started. */
+	uint32_t ulStart;						/* Incremented each time the watch is started, so output of an execution started for an earlier command is recognised. */
+	uint32_t ulExecutionStart;				/* ulStart when the execution in progress was started. */
+	uint32_t ulExecutions;					/* The number of executions started since the watch was started, shown in the headers. */
+	BaseType_t xExecuting;
+	BaseType_t xHeaderSent;					/* Set once the execution in progress has sent its header. */
+	UBaseType_t uxRow;						/* The output string of the execution in progress. */
+	UBaseType_t uxRows;						/* The number of entries of ulRowHashes that are valid. */
+	uint32_t ulRowHashes[ watchMAX_ROWS ];	/* The hash of each output string of the last execution. */
+	char cCommandLine[ cmdMAX_INPUT_SIZE ];
+	char cPrefix[ watchPREFIX_SIZE ];		/* Only used by the worker task executing the command. */
+	TimerHandle_t xTimer;
+	StaticTimer_t xTimerBuffer;
+} CommandWatch_t;
+
+static CommandWatch_t xWatches[ watchMAX_WATCHES ];
+
+/*
+ * The timer callback that starts an execution of the watched command.
+ */
+static void prvWatchTimerCallback( TimerHandle_t xTimer );
+
+/*
+ * The worker sink functions, see CommandWorker.h.
+ */
+static BaseType_t prvWatchOutput( void *pvContext, const char *pcOutput, size_t xOutputLength );
+static void prvWatchFinished( void *pvContext, BaseType_t xOutputDropped );
+
+/*
+ * Return the watch of pxConsole, or NULL if it has none.
+ */
+static CommandWatch_t *prvFindWatch( CommandConsole_t *pxConsole );
+
+/*
+ * 32-bit FNV-1a hash of an output string.
+ */
+static uint32_t prvHash( const char *pcOutput, size_t xOutputLength );
+
+static const CommandWorkerSink_t xWatchSink = { prvWatchOutput, prvWatchFinished };
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandWatchStart( CommandConsole_t *pxConsole, uint32_t ulPeriodMs, const char *pcCommandLine )
+{
+CommandWatch_t *pxWatch;
+UBaseType_t x;
+TickType_t xPeriod;
+
+	if( ulPeriodMs < watchMIN_PERIOD_MS )
+	{
+		ulPeriodMs = watchMIN_PERIOD_MS;
+	}
+	xPeriod = pdMS_TO_TICKS( ulPeriodMs );
+
+	taskENTER_CRITICAL();
+	{
+		pxWatch = prvFindWatch( pxConsole );
+		for( x = 0; ( pxWatch == NULL ) && ( x < watchMAX_WATCHES ); x++ )
+		{
+			if( xWatches[ x ].pxConsole == NULL )
+			{
+				pxWatch = &( xWatches[ x ] );
+			}
+		}
+
+		if( pxWatch != NULL )
+		{
+			pxWatch->pxConsole = pxConsole;
+			pxWatch->ulGeneration = pxConsole->ulGeneration;
+			pxWatch->ulStart++;
+			pxWatch->ulExecutions = 0;
+			pxWatch->uxRows = 0;
+			strncpy( pxWatch->cCommandLine, pcCommandLine, cmdMAX_INPUT_SIZE - 1 );
+			pxWatch->cCommandLine[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( pxWatch == NULL )
+	{
+		return pdFAIL;
+	}
+
+	/* Only the task of a console in use changes its watch, so the timer is not
+	created twice. */
+	if( pxWatch->xTimer == NULL )
+	{
+		pxWatch->xTimer = xTimerCreateStatic( "Watch", xPeriod, pdTRUE, pxWatch, prvWatchTimerCallback, &( pxWatch->xTimerBuffer ) );
+		configASSERT( pxWatch->xTimer );
+	}
+
+	/* Changing the period also starts the timer. */
+	( void ) xTimerChangePeriod( pxWatch->xTimer, xPeriod, portMAX_DELAY );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandWatchStop( CommandConsole_t *pxConsole )
+{
+CommandWatch_t *pxWatch;
+
+	taskENTER_CRITICAL();
+	{
+		pxWatch = prvFindWatch( pxConsole );
+		if( pxWatch != NULL )
+		{
+			pxWatch->pxConsole = NULL;
+			pxWatch->ulStart++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( pxWatch == NULL )
+	{
+		return pdFAIL;
+	}
+
+	( void ) xTimerStop( pxWatch->xTimer, portMAX_DELAY );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWatchTimerCallback( TimerHandle_t xTimer )
+{
+CommandWatch_t *pxWatch = ( CommandWatch_t * ) pvTimerGetTimerID( xTimer );
+CommandConsole_t *pxConsole;
+BaseType_t xExecute = pdFALSE;
+
+	taskENTER_CRITICAL();
+	{
+		pxConsole = pxWatch->pxConsole;
+		if( ( pxConsole != NULL ) && ( pxConsole->ulGeneration != pxWatch->ulGeneration ) )
+		{
+			/* The connection the command was watched for has gone. */
+			pxWatch->pxConsole = NULL;
+			pxWatch->ulStart++;
+			pxConsole = NULL;
+		}
+
+		if( ( pxConsole != NULL ) && ( pxWatch->xExecuting == pdFALSE ) )
+		{
+			pxWatch->xExecuting = pdTRUE;
+			pxWatch->xHeaderSent = pdFALSE;
+			pxWatch->ulExecutionStart = pxWatch->ulStart;
+			pxWatch->ulExecutions++;
+			pxWatch->uxRow = 0;
+			xExecute = pdTRUE;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( pxConsole == NULL )
+	{
+		/* The timer service task must not block. */
+		( void ) xTimerStop( xTimer, 0 );
+	}
+	else if( xExecute != pdFALSE )
+	{
+		/* The command line is copied into the job, so it does not matter if
+		the watch is changed while the command executes. */
+		if( xCommandWorkerSubmitToSink( pxConsole, pxWatch->cCommandLine, &xWatchSink, pxWatch ) != pdPASS )
+		{
+			/* Try again next period. */
+			pxWatch->xExecuting = pdFALSE;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWatchOutput( void *pvContext, const char *pcOutput, size_t xOutputLength )
+{
+CommandWatch_t *pxWatch = ( CommandWatch_t * ) pvContext;
+CommandConsole_t *pxConsole;
+uint32_t ulHash = prvHash( pcOutput, xOutputLength ), ulGeneration, ulExecution = 0;
+UBaseType_t uxRow = 0;
+BaseType_t xSend = pdFALSE, xHeader = pdFALSE;
+size_t xPrefixLength = 0;
+
+	taskENTER_CRITICAL();
+	{
+		pxConsole = pxWatch->pxConsole;
+		ulGeneration = pxWatch->ulGeneration;
+		if( ( pxConsole != NULL ) && ( pxWatch->ulExecutionStart == pxWatch->ulStart ) )
+		{
+			if( pxWatch->uxRow < watchMAX_ROWS )
+			{
+				/* Each row is compared with the same row of the last
+				execution, which has not been overwritten yet. */
+				if( ( pxWatch->uxRow >= pxWatch->uxRows ) || ( pxWatch->ulRowHashes[ pxWatch->uxRow ] != ulHash ) )
+				{
+					xSend = pdTRUE;
+				}
+				pxWatch->ulRowHashes[ pxWatch->uxRow ] = ulHash;
+			}
+			else
+			{
+				xSend = pdTRUE;
+			}
+
+			/* The first row sent by an execution is preceded by a header, so
+			the terminal shows where each execution starts.  The command line
+			is copied while it cannot change. */
+			if( ( xSend != pdFALSE ) && ( pxWatch->xHeaderSent == pdFALSE ) )
+			{
+				pxWatch->xHeaderSent = pdTRUE;
+				xHeader = pdTRUE;
+				ulExecution = pxWatch->ulExecutions;
+				xPrefixLength = ( size_t ) snprintf( pxWatch->cPrefix, sizeof( pxWatch->cPrefix ), "\r\n-- %s, execution %u --\r\n",
+													 pxWatch->cCommandLine, ( unsigned int ) ulExecution );
+			}
+
+			uxRow = pxWatch->uxRow;
+			pxWatch->uxRow++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xSend == pdFALSE )
+	{
+		return pdPASS;
+	}
+
+	/* Each row is preceded by its index, so a row sent on its own can be
+	matched with the row it replaces. */
+	if( ( xHeader == pdFALSE ) || ( xPrefixLength >= sizeof( pxWatch->cPrefix ) ) )
+	{
+		xPrefixLength = 0;
+	}
+	snprintf( &( pxWatch->cPrefix[ xPrefixLength ] ), sizeof( pxWatch->cPrefix ) - xPrefixLength, "%3u| ", ( unsigned int ) ( uxRow + 1 ) );
+
+	return xCommandConsoleWriteBackgroundPrefixed( pxConsole, ulGeneration, pxWatch->cPrefix, pcOutput, xOutputLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWatchFinished( void *pvContext, BaseType_t xOutputDropped )
+{
+CommandWatch_t *pxWatch = ( CommandWatch_t * ) pvContext;
+CommandConsole_t *pxConsole = NULL;
+UBaseType_t uxFirstGone = 0, uxLastGone = 0;
+uint32_t ulGeneration = 0;
+size_t xLength = 0;
+
+	taskENTER_CRITICAL();
+	{
+		if( pxWatch->ulExecutionStart == pxWatch->ulStart )
+		{
+			/* Rows the last execution sent that this one did not are still on
+			the terminal, so say they have gone. */
+			if( ( xOutputDropped == pdFALSE ) && ( pxWatch->uxRow < pxWatch->uxRows ) )
+			{
+				pxConsole = pxWatch->pxConsole;
+				ulGeneration = pxWatch->ulGeneration;
+				uxFirstGone = pxWatch->uxRow + 1;
+				uxLastGone = pxWatch->uxRows;
+
+				if( pxWatch->xHeaderSent == pdFALSE )
+				{
+					pxWatch->xHeaderSent = pdTRUE;
+					xLength = ( size_t ) snprintf( pxWatch->cPrefix, sizeof( pxWatch->cPrefix ), "\r\n-- %s, execution %u --\r\n",
+												   pxWatch->cCommandLine, ( unsigned int ) pxWatch->ulExecutions );
+				}
+			}
+
+			/* If output was dropped the terminal no longer shows what the
+			hashes say it does, so send everything again next time. */
+			pxWatch->uxRows = ( xOutputDropped != pdFALSE ) ? 0 : pxWatch->uxRow;
+			if( pxWatch->uxRows > watchMAX_ROWS )
+			{
+				pxWatch->uxRows = watchMAX_ROWS;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	/* The prefix is still only used by this execution, as the next cannot
+	start until xExecuting is cleared. */
+	if( pxConsole != NULL )
+	{
+		if( xLength >= sizeof( pxWatch->cPrefix ) )
+		{
+			xLength = 0;
+		}
+		snprintf( &( pxWatch->cPrefix[ xLength ] ), sizeof( pxWatch->cPrefix ) - xLength, "-- rows %u to %u are gone --\r\n",
+				  ( unsigned int ) uxFirstGone, ( unsigned int ) uxLastGone );
+		( void ) xCommandConsoleWriteBackground( pxConsole, ulGeneration, pxWatch->cPrefix, strlen( pxWatch->cPrefix ) );
+	}
+
+	taskENTER_CRITICAL();
+	{
+		pxWatch->xExecuting = pdFALSE;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static CommandWatch_t *prvFindWatch( CommandConsole_t *pxConsole )
+{
+UBaseType_t x;
+
+	for( x = 0; x < watchMAX_WATCHES; x++ )
+	{
+		if( xWatches[ x ].pxConsole == pxConsole )
+		{
+			return &( xWatches[ x ] );
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHash( const char *pcOutput, size_t xOutputLength )
+{
+uint32_t ulHash = 2166136261UL;
+size_t x;
+
+	for( x = 0; x < xOutputLength; x++ )
+	{
+		ulHash ^= ( uint8_t ) pcOutput[ x ];
+		ulHash *= 16777619UL;
+	}
+
+	return ulHash;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,167 @@
+/*
+ * CommandWorker.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandWorker.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "queue.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+#include "BlockPool.h"
+#include "MemoryLayout.h"
+
+/* A background command.  Each has its own session and output buffer, so it
+can run at the same time as the console and the other background commands. */
+typedef struct xCOMMAND_JOB
+{
+	CommandConsole_t *pxConsole;
+	uint32_t ulGeneration;				/* The generation of the console when the command was started. */
+	const CommandWorkerSink_t *pxSink;	/* Where the output goes, NULL for the console. */
+	void *pvSinkContext;
+	CLI_Session_t xSession;
+	char cCommandLine[ cmdMAX_INPUT_SIZE ];
+	char cOutputBuffer[ workerOUTPUT_SIZE ];
+} CommandJob_t;
+
+/* A job is allocated from the largest block class, so every submission would
+fail if it did not fit.  The size of the array is negative if it does not. */
+typedef char CommandJobFitsBlockPool_t[ ( sizeof( CommandJob_t ) <= poolLARGEST_BLOCK_SIZE ) ? 1 : -1 ];
+
+static QueueHandle_t xJobQueue = NULL;
+static StaticQueue_t xJobQueueBuffer;
+static uint8_t ucJobQueueStorage[ workerQUEUE_LENGTH * sizeof( CommandJob_t * ) ];
+
+static StaticTask_t xWorkerTasks[ workerTASKS ] memoryDTCM_BSS;
+static StackType_t xWorkerStacks[ workerTASKS ][ workerSTACK_SIZE ] memoryDTCM_BSS;
+
+/*
+ * The task that executes background commands taken from xJobQueue.
+ */
+static void prvCommandWorkerTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+void CommandWorkerStart( unsigned portBASE_TYPE uxPriority )
+{
+char cTaskName[ configMAX_TASK_NAME_LEN ];
+UBaseType_t x;
+
+	xJobQueue = xQueueCreateStatic( workerQUEUE_LENGTH, sizeof( CommandJob_t * ), ucJobQueueStorage, &xJobQueueBuffer );
+	configASSERT( xJobQueue );
+
+	for( x = 0; x < workerTASKS; x++ )
+	{
+		snprintf( cTaskName, sizeof( cTaskName ), "Worker%u", ( unsigned ) x );
+		xTaskCreateStatic( 	prvCommandWorkerTask,			/* The task that executes background commands. */
+							cTaskName,						/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+							workerSTACK_SIZE,				/* The size of the stack allocated to the task. */
+							NULL,							/* The parameter is not used, so NULL is passed. */
+							uxPriority,						/* The priority allocated to the task. */
+							xWorkerStacks[ x ],				/* The stack of the task. */
+							&xWorkerTasks[ x ] );			/* The task control block. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandWorkerSubmit( CommandConsole_t *pxConsole, const char *pcCommandLine )
+{
+	return xCommandWorkerSubmitToSink( pxConsole, pcCommandLine, NULL, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xCommandWorkerSubmitToSink( CommandConsole_t *pxConsole, const char *pcCommandLine, const CommandWorkerSink_t *pxSink, void *pvContext )
+{
+CommandJob_t *pxJob;
+
+	if( xJobQueue == NULL )
+	{
+		return pdFAIL;
+	}
+
+	pxJob = ( CommandJob_t * ) pvBlockPoolAllocate( sizeof( CommandJob_t ) );
+	if( pxJob == NULL )
+	{
+		return pdFAIL;
+	}
+
+	pxJob->pxConsole = pxConsole;
+	pxJob->ulGeneration = pxConsole->ulGeneration;
+	pxJob->pxSink = pxSink;
+	pxJob->pvSinkContext = pvContext;
+	strncpy( pxJob->cCommandLine, pcCommandLine, cmdMAX_INPUT_SIZE - 1 );
+	pxJob->cCommandLine[ cmdMAX_INPUT_SIZE - 1 ] = '\0';
+	FreeRTOS_CLISessionInit( &( pxJob->xSession ), pxJob->cOutputBuffer, sizeof( pxJob->cOutputBuffer ) );
+	FreeRTOS_CLISetSessionOwner( &( pxJob->xSession ), pxConsole );
+
+	if( xQueueSend( xJobQueue, &pxJob, 0 ) != pdPASS )
+	{
+		vBlockPoolFree( pxJob );
+		return pdFAIL;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCommandWorkerTask( void *pvParameters )
+{
+CommandJob_t *pxJob;
+BaseType_t xReturned, xWritten, xOutputDropped;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if( xQueueReceive( xJobQueue, &pxJob, portMAX_DELAY ) != pdPASS )
+		{
+			continue;
+		}
+
+		/* As prvExecuteLine() in CommandConsole.c, but each output string is
+		written under the lock of the console, so it does not get mixed up
+		with what the console itself is writing.  The command runs to the end
+		even if its console was initialised again, so it can free whatever it
+		allocated. */
+		xOutputDropped = pdFALSE;
+		do
+		{
+			pxJob->cOutputBuffer[ 0 ] = 0x00;
+			xReturned = FreeRTOS_CLIProcessSessionCommand( &( pxJob->xSession ), pxJob->cCommandLine );
+
+			if( pxJob->cOutputBuffer[ 0 ] != 0x00 )
+			{
+				if( pxJob->pxSink != NULL )
+				{
+					xWritten = pxJob->pxSink->pxOutput( pxJob->pvSinkContext, pxJob->cOutputBuffer, strlen( pxJob->cOutputBuffer ) );
+				}
+				else
+				{
+					xWritten = xCommandConsoleWriteBackground( pxJob->pxConsole, pxJob->ulGeneration, pxJob->cOutputBuffer, strlen( pxJob->cOutputBuffer ) );
+				}
+
+				if( xWritten != pdPASS )
+				{
+					xOutputDropped = pdTRUE;
+				}
+			}
+		} while( xReturned != pdFALSE );
+
+		if( pxJob->pxSink != NULL )
+		{
+			pxJob->pxSink->pxFinished( pxJob->pvSinkContext, xOutputDropped );
+		}
+		else
+		{
+			vCommandConsoleBackgroundFinished( pxJob->pxConsole, pxJob->ulGeneration, xOutputDropped );
+		}
+		vBlockPoolFree( pxJob );
+	}
+}
@@ -0,0 +1,207 @@
+/*
+ * CommandWriter.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "CommandWriter.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* Enough characters for a 32-bit number in decimal, with a sign and a decimal
+point. */
+#define writerMAX_DIGITS		12
+
+/*
+ * Append the xLength characters at pcCharacters, or as many as fit.
+ */
+static void prvWrite( CommandWriter_t *pxWriter, const char *pcCharacters, size_t xLength );
+
+/*
+ * Append uxCount spaces.
+ */
+static void prvWritePadding( CommandWriter_t *pxWriter, UBaseType_t uxCount );
+
+/*
+ * Append the xLength characters at pcDigits right aligned in uxWidth columns.
+ */
+static void prvWriteAligned( CommandWriter_t *pxWriter, const char *pcDigits, size_t xLength, UBaseType_t uxWidth );
+
+/*-----------------------------------------------------------*/
+
+void vCommandWriterInit( CommandWriter_t *pxWriter, char *pcBuffer, size_t xBufferLength )
+{
+	configASSERT( pxWriter );
+	configASSERT( pcBuffer );
+	configASSERT( xBufferLength > 0 );
+
+	pxWriter->pcBuffer = pcBuffer;
+	pxWriter->xBufferLength = xBufferLength;
+	pxWriter->xPosition = 0;
+	pxWriter->xTruncated = pdFALSE;
+	pcBuffer[ 0 ] = '\0';
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteString( CommandWriter_t *pxWriter, const char *pcString )
+{
+	prvWrite( pxWriter, pcString, strlen( pcString ) );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteStringN( CommandWriter_t *pxWriter, const char *pcString, size_t xLength )
+{
+size_t x;
+
+	/* Stop early if the string is shorter than xLength. */
+	for( x = 0; ( x < xLength ) && ( pcString[ x ] != '\0' ); x++ )
+	{
+	}
+
+	prvWrite( pxWriter, pcString, x );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteStringPadded( CommandWriter_t *pxWriter, const char *pcString, UBaseType_t uxWidth )
+{
+size_t xLength = strlen( pcString );
+
+	prvWrite( pxWriter, pcString, xLength );
+	if( xLength < uxWidth )
+	{
+		prvWritePadding( pxWriter, uxWidth - ( UBaseType_t ) xLength );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteChar( CommandWriter_t *pxWriter, char cCharacter )
+{
+	prvWrite( pxWriter, &cCharacter, 1 );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteUnsigned( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxWidth )
+{
+	vCommandWriteFixed( pxWriter, ulValue, 0, uxWidth );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteSigned( CommandWriter_t *pxWriter, int32_t lValue, UBaseType_t uxWidth )
+{
+char cDigits[ writerMAX_DIGITS ];
+char *pcDigit = &( cDigits[ writerMAX_DIGITS ] );
+uint32_t ulMagnitude;
+
+	/* Negate as unsigned so the most negative value does not overflow. */
+	ulMagnitude = ( lValue < 0 ) ? ( 0UL - ( uint32_t ) lValue ) : ( uint32_t ) lValue;
+
+	do
+	{
+		*( --pcDigit ) = ( char ) ( '0' + ( ulMagnitude % 10UL ) );
+		ulMagnitude /= 10UL;
+	} while( ulMagnitude > 0 );
+
+	if( lValue < 0 )
+	{
+		*( --pcDigit ) = '-';
+	}
+
+	prvWriteAligned( pxWriter, pcDigit, ( size_t ) ( &( cDigits[ writerMAX_DIGITS ] ) - pcDigit ), uxWidth );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteHex( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxDigits )
+{
+static const char cHexDigits[] = "0123456789ABCDEF";
+char cDigits[ 8 ];
+UBaseType_t uxCount = 0;
+
+	do
+	{
+		cDigits[ 7 - uxCount ] = cHexDigits[ ulValue & 0x0FUL ];
+		ulValue >>= 4;
+		uxCount++;
+	} while( ( ulValue > 0 ) || ( ( uxCount < uxDigits ) && ( uxCount < 8 ) ) );
+
+	/* Leading zeros past the eight digits of the number. */
+	while( uxDigits > 8 )
+	{
+		prvWrite( pxWriter, "0", 1 );
+		uxDigits--;
+	}
+
+	prvWrite( pxWriter, &( cDigits[ 8 - uxCount ] ), uxCount );
+}
+/*-----------------------------------------------------------*/
+
+void vCommandWriteFixed( CommandWriter_t *pxWriter, uint32_t ulValue, UBaseType_t uxDecimals, UBaseType_t uxWidth )
+{
+char cDigits[ writerMAX_DIGITS ];
+char *pcDigit = &( cDigits[ writerMAX_DIGITS ] );
+UBaseType_t uxDigits = 0;
+
+	configASSERT( uxDecimals < ( writerMAX_DIGITS - 2 ) );
+
+	/* Generate the digits from the least significant, putting the decimal
+	point in after uxDecimals of them.  There is always a digit before the
+	point. */
+	do
+	{
+		*( --pcDigit ) = ( char ) ( '0' + ( ulValue % 10UL ) );
+		ulValue /= 10UL;
+		uxDigits++;
+
+		if( uxDigits == uxDecimals )
+		{
+			*( --pcDigit ) = '.';
+		}
+	} while( ( ulValue > 0 ) || ( uxDigits <= uxDecimals ) );
+
+	prvWriteAligned( pxWriter, pcDigit, ( size_t ) ( &( cDigits[ writerMAX_DIGITS ] ) - pcDigit ), uxWidth );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWrite( CommandWriter_t *pxWriter, const char *pcCharacters, size_t xLength )
+{
+size_t xSpace = pxWriter->xBufferLength - pxWriter->xPosition - 1;
+
+	if( xLength > xSpace )
+	{
+		xLength = xSpace;
+		pxWriter->xTruncated = pdTRUE;
+	}
+
+	memcpy( &( pxWriter->pcBuffer[ pxWriter->xPosition ] ), pcCharacters, xLength );
+	pxWriter->xPosition += xLength;
+	pxWriter->pcBuffer[ pxWriter->xPosition ] = '\0';
+}
+/*-----------------------------------------------------------*/
+
+static void prvWritePadding( CommandWriter_t *pxWriter, UBaseType_t uxCount )
+{
+size_t xSpace = pxWriter->xBufferLength - pxWriter->xPosition - 1;
+
+	if( uxCount > xSpace )
+	{
+		uxCount = ( UBaseType_t ) xSpace;
+		pxWriter->xTruncated = pdTRUE;
+	}
+
+	memset( &( pxWriter->pcBuffer[ pxWriter->xPosition ] ), ' ', uxCount );
+	pxWriter->xPosition += uxCount;
+	pxWriter->pcBuffer[ pxWriter->xPosition ] = '\0';
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteAligned( CommandWriter_t *pxWriter, const char *pcDigits, size_t xLength, UBaseType_t uxWidth )
+{
+	if( xLength < uxWidth )
+	{
+		prvWritePadding( pxWriter, uxWidth - ( UBaseType_t ) xLength );
+	}
+
+	prvWrite( pxWriter, pcDigits, xLength );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,629 @@
+/*
+ * ConfigStore.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "ConfigStore.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "semphr.h"
+
+#include "FlashAccess.h"
+#include "CommandFrame.h"
+
+/* The layout of a page.  The header is written once in three steps, each
+word only once: the magic and sequence number when the page starts receiving
+records, then the active mark once they have all been copied.  The records
+follow. */
+#define storeMAGIC					0x31474643UL		/* "CFG1" */
+#define storeMAGIC_OFFSET			0
+#define storeSEQUENCE_OFFSET		4
+#define storeACTIVE_OFFSET			8
+#define storeACTIVE					0x00000000UL
+#define storeFIRST_RECORD			16
+
+/* Each record is a header word followed by the key and the value, padded with
+0xFF to a whole number of words.  The header holds the key length in bits 0 to
+7, the value length in bits 8 to 15, and a CRC of the lengths, key and value in
+bits 16 to 31.  A value length of storeDELETED marks a deleted key.  An erased
+header word ends the log. */
+#define storeDELETED				0xFF
+#define storeERASED					0xFFFFFFFFUL
+#define storeRECORD_SIZE( xKey, xValue )	( ( 4 + ( xKey ) + ( xValue ) + 3 ) & ~( size_t ) 3 )
+
+/* The index is an open addressing hash table of the page offsets of the latest
+records.  Offsets below storeFIRST_RECORD are never records. */
+#define storeINDEX_SLOTS			( configstoreMAX_KEYS * 2 )
+#define storeSLOT_EMPTY				0x0000
+#define storeSLOT_REMOVED			0x0001
+
+/* Defined by the linker script.  Each page is a flash sector. */
+extern const uint8_t _sconfig_store[];
+
+typedef struct xSTORE_SLOT
+{
+	uint16_t usOffset;
+	uint16_t usHash;
+} StoreSlot_t;
+
+static StoreSlot_t xIndex[ storeINDEX_SLOTS ];
+static UBaseType_t uxKeys = 0;
+
+static UBaseType_t uxActivePage = 0;
+static size_t xWriteOffset = storeFIRST_RECORD;
+static uint32_t ulSequence = 0;
+
+/* Set when the inactive page has to be erased before it can be used. */
+static BaseType_t xErasePending = pdFALSE;
+
+static SemaphoreHandle_t xStoreMutex = NULL;
+static StaticSemaphore_t xStoreMutexBuffer;
+static TaskHandle_t xEraseTask = NULL;
+static StaticTask_t xEraseTaskBuffer;
+static StackType_t xEraseTaskStack[ configMINIMAL_STACK_SIZE ];
+
+/*
+ * The task that erases the inactive page after a compaction.
+ */
+static void prvEraseTask( void *pvParameters );
+
+static const uint8_t *prvPage( UBaseType_t uxPage );
+static uint32_t prvReadWord( UBaseType_t uxPage, size_t xOffset );
+
+/*
+ * Program xLength bytes at xOffset of uxPage, which must be word aligned.  The
+ * last word is padded with 0xFF.
+ */
+static BaseType_t prvProgram( UBaseType_t uxPage, size_t xOffset, const uint8_t *pucData, size_t xLength );
+static BaseType_t prvProgramWord( UBaseType_t uxPage, size_t xOffset, uint32_t ulWord );
+static BaseType_t prvErasePage( UBaseType_t uxPage );
+static BaseType_t prvPageIsErased( UBaseType_t uxPage );
+
+/*
+ * Rebuild the index from the records of the active page, and find where the
+ * next record goes.
+ */
+static void prvScanPage( void );
+
+/*
+ * Return the index slot that holds pcKey, or the slot it should be added to,
+ * or -1 if it is not there and the index is full.
+ */
+static int32_t prvFindSlot( const char *pcKey, size_t xKeyLength, uint16_t usHash );
+static uint16_t prvHash( const char *pcKey, size_t xKeyLength );
+static uint16_t prvRecordCRC( uint32_t ulLengths, const uint8_t *pucData, size_t xLength );
+
+/*
+ * Append a record to the active page, compacting first if it does not fit, and
+ * update the index.
+ */
+static BaseType_t prvAppend( const char *pcKey, size_t xKeyLength, const char *pcValue, size_t xValueLength );
+
+/*
+ * Copy the live records to the inactive page and make it the active one.
+ */
+static BaseType_t prvCompact( void );
+
+/*-----------------------------------------------------------*/
+
+void ConfigStoreStart( unsigned long uxPriority )
+{
+BaseType_t xValid[ 2 ];
+UBaseType_t uxPage;
+
+	xStoreMutex = xSemaphoreCreateMutexStatic( &xStoreMutexBuffer );
+	configASSERT( xStoreMutex );
+
+	for( uxPage = 0; uxPage < 2; uxPage++ )
+	{
+		xValid[ uxPage ] = ( ( prvReadWord( uxPage, storeMAGIC_OFFSET ) == storeMAGIC ) && ( prvReadWord( uxPage, storeACTIVE_OFFSET ) == storeACTIVE ) ) ? pdTRUE : pdFALSE;
+	}
+
+	/* Both pages are active if the reset came between a compaction and the
+	erase, in which case the newer one has every record. */
+	if( ( xValid[ 0 ] != pdFALSE ) && ( xValid[ 1 ] != pdFALSE ) )
+	{
+		uxActivePage = ( ( int32_t ) ( prvReadWord( 1, storeSEQUENCE_OFFSET ) - prvReadWord( 0, storeSEQUENCE_OFFSET ) ) > 0 ) ? 1 : 0;
+	}
+	else if( xValid[ 1 ] != pdFALSE )
+	{
+		uxActivePage = 1;
+	}
+	else if( xValid[ 0 ] != pdFALSE )
+	{
+		uxActivePage = 0;
+	}
+	else
+	{
+		/* A new store.  Erasing here only happens on the first boot, or if
+		the region held something else. */
+		uxActivePage = 0;
+		if( ( prvPageIsErased( 0 ) == pdFALSE ) && ( prvErasePage( 0 ) != pdPASS ) )
+		{
+			return;
+		}
+		( void ) prvProgramWord( 0, storeMAGIC_OFFSET, storeMAGIC );
+		( void ) prvProgramWord( 0, storeSEQUENCE_OFFSET, 1 );
+		( void ) prvProgramWord( 0, storeACTIVE_OFFSET, storeACTIVE );
+	}
+
+	ulSequence = prvReadWord( uxActivePage, storeSEQUENCE_OFFSET );
+	prvScanPage();
+
+	/* The other page can be left part way through a compaction, or still full
+	from the last one. */
+	xErasePending = ( prvPageIsErased( 1 - uxActivePage ) == pdFALSE ) ? pdTRUE : pdFALSE;
+
+	xEraseTask = xTaskCreateStatic( prvEraseTask, "Config", configMINIMAL_STACK_SIZE, NULL, uxPriority, xEraseTaskStack, &xEraseTaskBuffer );
+	configASSERT( xEraseTask );
+
+	if( xErasePending != pdFALSE )
+	{
+		xTaskNotifyGive( xEraseTask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xConfigStoreGet( const char *pcKey, char *pcValue, size_t xValueLength )
+{
+size_t xKeyLength = strlen( pcKey ), xLength;
+int32_t lSlot;
+const uint8_t *pucRecord;
+BaseType_t xReturn = pdFAIL;
+
+	configASSERT( xValueLength > 0 );
+
+	if( ( xKeyLength == 0 ) || ( xKeyLength > configstoreMAX_KEY_LENGTH ) )
+	{
+		return pdFAIL;
+	}
+
+	/* The mutex also stops the page being compacted away while it is read. */
+	xSemaphoreTake( xStoreMutex, portMAX_DELAY );
+	{
+		lSlot = prvFindSlot( pcKey, xKeyLength, prvHash( pcKey, xKeyLength ) );
+		if( ( lSlot >= 0 ) && ( xIndex[ lSlot ].usOffset > storeSLOT_REMOVED ) )
+		{
+			pucRecord = prvPage( uxActivePage ) + xIndex[ lSlot ].usOffset;
+			xLength = pucRecord[ 1 ];
+			if( xLength >= xValueLength )
+			{
+				xLength = xValueLength - 1;
+			}
+			memcpy( pcValue, &pucRecord[ 4 + pucRecord[ 0 ] ], xLength );
+			pcValue[ xLength ] = 0x00;
+			xReturn = pdPASS;
+		}
+	}
+	xSemaphoreGive( xStoreMutex );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xConfigStoreSet( const char *pcKey, const char *pcValue )
+{
+size_t xKeyLength = strlen( pcKey ), xValueLength = 0;
+BaseType_t xReturn;
+
+	if( pcValue != NULL )
+	{
+		xValueLength = strlen( pcValue );
+	}
+
+	if( ( xKeyLength == 0 ) || ( xKeyLength > configstoreMAX_KEY_LENGTH ) || ( xValueLength > configstoreMAX_VALUE_LENGTH ) )
+	{
+		return pdFAIL;
+	}
+
+	xSemaphoreTake( xStoreMutex, portMAX_DELAY );
+	{
+		xReturn = prvAppend( pcKey, xKeyLength, pcValue, xValueLength );
+	}
+	xSemaphoreGive( xStoreMutex );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xConfigStoreNext( UBaseType_t *puxPosition, char *pcKey, size_t xKeyLength, char *pcValue, size_t xValueLength )
+{
+const uint8_t *pucRecord;
+size_t xLength;
+BaseType_t xReturn = pdFALSE;
+
+	configASSERT( ( xKeyLength > 0 ) && ( xValueLength > 0 ) );
+
+	xSemaphoreTake( xStoreMutex, portMAX_DELAY );
+	{
+		while( *puxPosition < storeINDEX_SLOTS )
+		{
+			if( xIndex[ *puxPosition ].usOffset > storeSLOT_REMOVED )
+			{
+				pucRecord = prvPage( uxActivePage ) + xIndex[ *puxPosition ].usOffset;
+
+				xLength = ( pucRecord[ 0 ] < xKeyLength ) ? pucRecord[ 0 ] : ( xKeyLength - 1 );
+				memcpy( pcKey, &pucRecord[ 4 ], xLength );
+				pcKey[ xLength ] = 0x00;
+
+				xLength = ( pucRecord[ 1 ] < xValueLength ) ? pucRecord[ 1 ] : ( xValueLength - 1 );
+				memcpy( pcValue, &pucRecord[ 4 + pucRecord[ 0 ] ], xLength );
+				pcValue[ xLength ] = 0x00;
+
+				xReturn = pdTRUE;
+			}
+
+			( *puxPosition )++;
+			if( xReturn != pdFALSE )
+			{
+				break;
+			}
+		}
+	}
+	xSemaphoreGive( xStoreMutex );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vConfigStoreGetStats( ConfigStoreStats_t *pxStats )
+{
+	xSemaphoreTake( xStoreMutex, portMAX_DELAY );
+	{
+		pxStats->uxActivePage = uxActivePage;
+		pxStats->xUsed = xWriteOffset;
+		pxStats->xSize = configstorePAGE_SIZE;
+		pxStats->uxKeys = uxKeys;
+		pxStats->ulCompactions = ulSequence - 1;
+		pxStats->xErasePending = xErasePending;
+	}
+	xSemaphoreGive( xStoreMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEraseTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		xSemaphoreTake( xStoreMutex, portMAX_DELAY );
+		{
+			if( ( xErasePending != pdFALSE ) && ( prvErasePage( 1 - uxActivePage ) == pdPASS ) )
+			{
+				xErasePending = pdFALSE;
+			}
+		}
+		xSemaphoreGive( xStoreMutex );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static const uint8_t *prvPage( UBaseType_t uxPage )
+{
+	return &_sconfig_store[ uxPage * configstorePAGE_SIZE ];
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReadWord( UBaseType_t uxPage, size_t xOffset )
+{
+	return *( ( const uint32_t * ) ( prvPage( uxPage ) + xOffset ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProgram( UBaseType_t uxPage, size_t xOffset, const uint8_t *pucData, size_t xLength )
+{
+	configASSERT( ( xOffset & 3 ) == 0 );
+
+	return xFlashProgram( ( uint32_t ) ( prvPage( uxPage ) + xOffset ), pucData, xLength );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProgramWord( UBaseType_t uxPage, size_t xOffset, uint32_t ulWord )
+{
+	return prvProgram( uxPage, xOffset, ( const uint8_t * ) &ulWord, sizeof( ulWord ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvErasePage( UBaseType_t uxPage )
+{
+	return xFlashEraseSector( ( uint32_t ) prvPage( uxPage ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPageIsErased( UBaseType_t uxPage )
+{
+size_t xOffset;
+
+	for( xOffset = 0; xOffset < configstorePAGE_SIZE; xOffset += 4 )
+	{
+		if( prvReadWord( uxPage, xOffset ) != storeERASED )
+		{
+			return pdFALSE;
+		}
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvScanPage( void )
+{
+const uint8_t *pucPage = prvPage( uxActivePage );
+size_t xOffset = storeFIRST_RECORD, xKeyLength, xValueLength, xSize;
+uint32_t ulHeader;
+int32_t lSlot;
+
+	memset( xIndex, 0x00, sizeof( xIndex ) );
+	uxKeys = 0;
+
+	while( ( xOffset + 4 ) <= configstorePAGE_SIZE )
+	{
+		ulHeader = prvReadWord( uxActivePage, xOffset );
+		if( ulHeader == storeERASED )
+		{
+			break;
+		}
+
+		xKeyLength = ulHeader & 0xFFUL;
+		xValueLength = ( ulHeader >> 8 ) & 0xFFUL;
+		xSize = storeRECORD_SIZE( xKeyLength, ( xValueLength == storeDELETED ) ? 0 : xValueLength );
+
+		/* Nothing after a header that makes no sense can be trusted, so the
+		page is treated as full and compacted by the next write. */
+		if( ( xKeyLength == 0 ) || ( xKeyLength > configstoreMAX_KEY_LENGTH ) ||
+			( ( xValueLength != storeDELETED ) && ( xValueLength > configstoreMAX_VALUE_LENGTH ) ) ||
+			( ( xOffset + xSize ) > configstorePAGE_SIZE ) )
+		{
+			xOffset = configstorePAGE_SIZE;
+			break;
+		}
+
+		/* A record torn by a reset fails its CRC and is skipped, leaving the
+		previous value of the key in place. */
+		if( ( uint16_t ) ( ulHeader >> 16 ) == prvRecordCRC( ulHeader, &pucPage[ xOffset + 4 ], xSize - 4 ) )
+		{
+			lSlot = prvFindSlot( ( const char * ) &pucPage[ xOffset + 4 ], xKeyLength, prvHash( ( const char * ) &pucPage[ xOffset + 4 ], xKeyLength ) );
+			if( lSlot >= 0 )
+			{
+				if( xValueLength == storeDELETED )
+				{
+					if( xIndex[ lSlot ].usOffset > storeSLOT_REMOVED )
+					{
+						xIndex[ lSlot ].usOffset = storeSLOT_REMOVED;
+						uxKeys--;
+					}
+				}
+				else
+				{
+					if( xIndex[ lSlot ].usOffset <= storeSLOT_REMOVED )
+					{
+						uxKeys++;
+					}
+					xIndex[ lSlot ].usOffset = ( uint16_t ) xOffset;
+					xIndex[ lSlot ].usHash = prvHash( ( const char * ) &pucPage[ xOffset + 4 ], xKeyLength );
+				}
+			}
+		}
+
+		xOffset += xSize;
+	}
+
+	xWriteOffset = xOffset;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvFindSlot( const char *pcKey, size_t xKeyLength, uint16_t usHash )
+{
+const uint8_t *pucRecord;
+UBaseType_t uxSlot = usHash % storeINDEX_SLOTS, uxProbe;
+int32_t lFree = -1;
+
+	for( uxProbe = 0; uxProbe < storeINDEX_SLOTS; uxProbe++ )
+	{
+		if( xIndex[ uxSlot ].usOffset == storeSLOT_EMPTY )
+		{
+			/* The end of the chain.  A removed slot passed on the way can be
+			reused. */
+			return ( lFree >= 0 ) ? lFree : ( int32_t ) uxSlot;
+		}
+
+		if( xIndex[ uxSlot ].usOffset == storeSLOT_REMOVED )
+		{
+			if( lFree < 0 )
+			{
+				lFree = ( int32_t ) uxSlot;
+			}
+		}
+		else if( xIndex[ uxSlot ].usHash == usHash )
+		{
+			pucRecord = prvPage( uxActivePage ) + xIndex[ uxSlot ].usOffset;
+			if( ( pucRecord[ 0 ] == xKeyLength ) && ( memcmp( &pucRecord[ 4 ], pcKey, xKeyLength ) == 0 ) )
+			{
+				return ( int32_t ) uxSlot;
+			}
+		}
+
+		uxSlot = ( uxSlot + 1 ) % storeINDEX_SLOTS;
+	}
+
+	return lFree;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvHash( const char *pcKey, size_t xKeyLength )
+{
+uint32_t ulHash = 2166136261UL;
+size_t x;
+
+	/* FNV-1a, folded to 16 bits. */
+	for( x = 0; x < xKeyLength; x++ )
+	{
+		ulHash = ( ulHash ^ ( uint8_t ) pcKey[ x ] ) * 16777619UL;
+	}
+
+	return ( uint16_t ) ( ulHash ^ ( ulHash >> 16 ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvRecordCRC( uint32_t ulLengths, const uint8_t *pucData, size_t xLength )
+{
+uint8_t ucLengths[ 2 ] = { ( uint8_t ) ulLengths, ( uint8_t ) ( ulLengths >> 8 ) };
+
+	/* The CRC of the framed protocol.  The padding is included, it is always
+	0xFF. */
+	return usCommandFrameCRC( usCommandFrameCRC( 0xFFFF, ucLengths, sizeof( ucLengths ) ), pucData, xLength );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppend( const char *pcKey, size_t xKeyLength, const char *pcValue, size_t xValueLength )
+{
+uint8_t ucRecord[ storeRECORD_SIZE( configstoreMAX_KEY_LENGTH, configstoreMAX_VALUE_LENGTH ) ];
+size_t xSize;
+uint32_t ulHeader;
+int32_t lSlot;
+uint16_t usHash = prvHash( pcKey, xKeyLength );
+
+	lSlot = prvFindSlot( pcKey, xKeyLength, usHash );
+	if( pcValue == NULL )
+	{
+		/* Deleting a key that is not set needs no record. */
+		if( ( lSlot < 0 ) || ( xIndex[ lSlot ].usOffset <= storeSLOT_REMOVED ) )
+		{
+			return pdPASS;
+		}
+	}
+	else if( ( lSlot < 0 ) || ( ( xIndex[ lSlot ].usOffset <= storeSLOT_REMOVED ) && ( uxKeys >= configstoreMAX_KEYS ) ) )
+	{
+		return pdFAIL;
+	}
+
+	xSize = storeRECORD_SIZE( xKeyLength, xValueLength );
+	memset( ucRecord, 0xFF, sizeof( ucRecord ) );
+	memcpy( &ucRecord[ 4 ], pcKey, xKeyLength );
+	if( pcValue != NULL )
+	{
+		memcpy( &ucRecord[ 4 + xKeyLength ], pcValue, xValueLength );
+	}
+	ulHeader = ( uint32_t ) xKeyLength | ( ( uint32_t ) ( ( pcValue != NULL ) ? xValueLength : storeDELETED ) << 8 );
+	ulHeader |= ( uint32_t ) prvRecordCRC( ulHeader, &ucRecord[ 4 ], xSize - 4 ) << 16;
+	memcpy( ucRecord, &ulHeader, sizeof( ulHeader ) );
+
+	if( ( xWriteOffset + xSize ) > configstorePAGE_SIZE )
+	{
+		if( prvCompact() != pdPASS )
+		{
+			return pdFAIL;
+		}
+
+		if( ( xWriteOffset + xSize ) > configstorePAGE_SIZE )
+		{
+			return pdFAIL;
+		}
+
+		/* The slots moved with the records. */
+		lSlot = prvFindSlot( pcKey, xKeyLength, usHash );
+		configASSERT( lSlot >= 0 );
+	}
+
+	/* The header goes first, so a reset part way through leaves a record the
+	scan can step over. */
+	if( prvProgram( uxActivePage, xWriteOffset, ucRecord, xSize ) != pdPASS )
+	{
+		/* Whatever was programmed cannot be written again. */
+		xWriteOffset = configstorePAGE_SIZE;
+		return pdFAIL;
+	}
+
+	if( pcValue == NULL )
+	{
+		xIndex[ lSlot ].usOffset = storeSLOT_REMOVED;
+		uxKeys--;
+	}
+	else
+	{
+		if( xIndex[ lSlot ].usOffset <= storeSLOT_REMOVED )
+		{
+			uxKeys++;
+		}
+		xIndex[ lSlot ].usOffset = ( uint16_t ) xWriteOffset;
+		xIndex[ lSlot ].usHash = usHash;
+	}
+	xWriteOffset += xSize;
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompact( void )
+{
+const UBaseType_t uxTarget = 1 - uxActivePage;
+const uint8_t *pucRecord;
+size_t xOffset = storeFIRST_RECORD, xSize;
+UBaseType_t uxSlot;
+uint32_t ulNewSequence = ulSequence + 1;
+
+	/* Normally erased long ago by the erase task. */
+	if( xErasePending != pdFALSE )
+	{
+		if( prvErasePage( uxTarget ) != pdPASS )
+		{
+			return pdFAIL;
+		}
+		xErasePending = pdFALSE;
+	}
+
+	if( ( prvProgramWord( uxTarget, storeMAGIC_OFFSET, storeMAGIC ) != pdPASS ) ||
+		( prvProgramWord( uxTarget, storeSEQUENCE_OFFSET, ulNewSequence ) != pdPASS ) )
+	{
+		xErasePending = pdTRUE;
+		return pdFAIL;
+	}
+
+	/* The live records are copied as they are, they already have their
+	CRC. */
+	for( uxSlot = 0; uxSlot < storeINDEX_SLOTS; uxSlot++ )
+	{
+		if( xIndex[ uxSlot ].usOffset <= storeSLOT_REMOVED )
+		{
+			continue;
+		}
+
+		pucRecord = prvPage( uxActivePage ) + xIndex[ uxSlot ].usOffset;
+		xSize = storeRECORD_SIZE( pucRecord[ 0 ], pucRecord[ 1 ] );
+		if( prvProgram( uxTarget, xOffset, pucRecord, xSize ) != pdPASS )
+		{
+			xErasePending = pdTRUE;
+			return pdFAIL;
+		}
+		xOffset += xSize;
+	}
+
+	/* Until this word is written a reset returns to the old page. */
+	if( prvProgramWord( uxTarget, storeACTIVE_OFFSET, storeACTIVE ) != pdPASS )
+	{
+		xErasePending = pdTRUE;
+		return pdFAIL;
+	}
+
+	uxActivePage = uxTarget;
+	ulSequence = ulNewSequence;
+	prvScanPage();
+
+	xErasePending = pdTRUE;
+	if( xEraseTask != NULL )
+	{
+		xTaskNotifyGive( xEraseTask );
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
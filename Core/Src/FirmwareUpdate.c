@@ -0,0 +1,442 @@
+/*
+ * FirmwareUpdate.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "FirmwareUpdate.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "FlashAccess.h"
+
+/* The number of buffers data is copied to.  One is programmed while the
+other is filled. */
+#define updateCHUNKS				2
+
+/* The longest xFirmwareUpdateWrite() waits for a buffer, which covers a
+sector being erased. */
+#define updateWRITE_TIMEOUT			( 5000 / portTICK_PERIOD_MS )
+
+/* The longest xFirmwareUpdateCommit() waits for the data to be programmed. */
+#define updateCOMMIT_TIMEOUT		( 10000 / portTICK_PERIOD_MS )
+
+/* How far past the data received so far the update area is erased while no
+data is waiting, which is the largest sector. */
+#define updateERASE_AHEAD			( 256UL * 1024UL )
+
+/* The image follows the header. */
+#define updateIMAGE_OFFSET			sizeof( FirmwareUpdateHeader_t )
+
+/* Defined by the linker script. */
+extern const uint8_t _sapplication[];
+extern const uint8_t _eapplication[];
+extern const uint8_t _supdate[];
+extern const uint8_t _eupdate[];
+
+typedef struct xUPDATE_CHUNK
+{
+	uint32_t ulSession;
+	uint32_t ulOffset;
+	size_t xLength;
+	uint8_t ucData[ updateCHUNK_SIZE ];
+} UpdateChunk_t;
+
+static UpdateChunk_t xChunks[ updateCHUNKS ];
+
+/* The chunks that can be filled, and the ones waiting to be programmed.  A
+NULL in xFullChunks only wakes the task. */
+static QueueHandle_t xFreeChunks = NULL;
+static StaticQueue_t xFreeChunksBuffer;
+static uint8_t ucFreeChunksStorage[ updateCHUNKS * sizeof( UpdateChunk_t * ) ];
+static QueueHandle_t xFullChunks = NULL;
+static StaticQueue_t xFullChunksBuffer;
+static uint8_t ucFullChunksStorage[ ( updateCHUNKS + 1 ) * sizeof( UpdateChunk_t * ) ];
+
+/* Serialises begin, commit and abort.  The state below is only changed in
+critical sections, as the task and xFirmwareUpdateWrite() do not take the
+mutex. */
+static SemaphoreHandle_t xUpdateMutex = NULL;
+static StaticSemaphore_t xUpdateMutexBuffer;
+
+static FirmwareUpdateState_t eState = eUpdateIdle;
+static uint32_t ulSession = 0;
+static uint32_t ulLength = 0;
+static uint32_t ulCRC = 0;
+static uint32_t ulReceived = 0;
+static uint32_t ulProgrammed = 0;
+
+/* The bytes from the start of the update area that have been erased for the
+current upload.  Only written by the task, and by begin while the task has no
+data. */
+static uint32_t ulErased = 0;
+
+static StaticTask_t xUpdateTaskBuffer;
+static StackType_t xUpdateTaskStack[ configMINIMAL_STACK_SIZE * 2 ];
+
+/*
+ * Programs the chunks, and erases the update area ahead of them.
+ */
+static void prvUpdateTask( void *pvParameters );
+
+/*
+ * Return pdTRUE if the next sector of the update area should be erased before
+ * more data arrives.  Called in a critical section.
+ */
+static BaseType_t prvEraseAheadNeeded( void );
+
+/*
+ * Erase the sectors of the update area up to ulEnd.  Returns pdFAIL if the
+ * upload was dropped or an erase failed.
+ */
+static BaseType_t prvEraseTo( uint32_t ulSessionToErase, uint32_t ulEnd );
+
+static void prvProgramChunk( UpdateChunk_t *pxChunk );
+
+/*
+ * Mark the current upload as failed, unless it has been dropped.
+ */
+static void prvFail( uint32_t ulFailedSession );
+
+/*-----------------------------------------------------------*/
+
+void FirmwareUpdateStart( unsigned long uxPriority )
+{
+UBaseType_t x;
+UpdateChunk_t *pxChunk;
+
+	xUpdateMutex = xSemaphoreCreateMutexStatic( &xUpdateMutexBuffer );
+	xFreeChunks = xQueueCreateStatic( updateCHUNKS, sizeof( UpdateChunk_t * ), ucFreeChunksStorage, &xFreeChunksBuffer );
+	xFullChunks = xQueueCreateStatic( updateCHUNKS + 1, sizeof( UpdateChunk_t * ), ucFullChunksStorage, &xFullChunksBuffer );
+	configASSERT( xUpdateMutex && xFreeChunks && xFullChunks );
+
+	for( x = 0; x < updateCHUNKS; x++ )
+	{
+		pxChunk = &xChunks[ x ];
+		xQueueSend( xFreeChunks, &pxChunk, 0 );
+	}
+
+	xTaskCreateStatic( prvUpdateTask, "Update", configMINIMAL_STACK_SIZE * 2, NULL, uxPriority, xUpdateTaskStack, &xUpdateTaskBuffer );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateBegin( uint32_t ulImageLength, uint32_t ulImageCRC )
+{
+UpdateChunk_t *pxWake = NULL;
+
+	if( ( ulImageLength == 0 ) || ( ulImageLength > ( uint32_t ) ( _eapplication - _sapplication ) ) ||
+		( ( updateIMAGE_OFFSET + ulImageLength ) > ( uint32_t ) ( _eupdate - _supdate ) ) )
+	{
+		return pdFAIL;
+	}
+
+	xSemaphoreTake( xUpdateMutex, portMAX_DELAY );
+	{
+		/* Chunks of the previous upload still queued are dropped by the
+		task, as their session no longer matches.  The area is erased again
+		from the start, which also removes the header of an image that was
+		committed but not installed. */
+		taskENTER_CRITICAL();
+		{
+			ulSession++;
+			eState = eUpdateReceiving;
+			ulLength = ulImageLength;
+			ulCRC = ulImageCRC;
+			ulReceived = 0;
+			ulProgrammed = 0;
+			ulErased = 0;
+		}
+		taskEXIT_CRITICAL();
+	}
+	xSemaphoreGive( xUpdateMutex );
+
+	/* Let the task start erasing. */
+	xQueueSend( xFullChunks, &pxWake, 0 );
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateWrite( uint32_t ulOffset, const uint8_t *pucData, size_t xLength )
+{
+UpdateChunk_t *pxChunk;
+uint32_t ulWriteSession;
+BaseType_t xAccepted = pdFAIL, xRepeated = pdFALSE;
+
+	if( ( xLength == 0 ) || ( xLength > updateCHUNK_SIZE ) )
+	{
+		return pdFAIL;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		ulWriteSession = ulSession;
+		if( eState == eUpdateReceiving )
+		{
+			if( ( ulOffset + xLength ) <= ulReceived )
+			{
+				xRepeated = pdTRUE;
+			}
+			else if( ( ulOffset == ulReceived ) && ( ( ulOffset + xLength ) <= ulLength ) &&
+					 ( ( ( xLength & 3 ) == 0 ) || ( ( ulOffset + xLength ) == ulLength ) ) )
+			{
+				xAccepted = pdPASS;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xRepeated != pdFALSE )
+	{
+		return pdPASS;
+	}
+
+	if( ( xAccepted == pdFAIL ) || ( xQueueReceive( xFreeChunks, &pxChunk, updateWRITE_TIMEOUT ) != pdTRUE ) )
+	{
+		return pdFAIL;
+	}
+
+	pxChunk->ulSession = ulWriteSession;
+	pxChunk->ulOffset = ulOffset;
+	pxChunk->xLength = xLength;
+	memcpy( pxChunk->ucData, pucData, xLength );
+
+	/* Another console may have written the same offset, or begun again,
+	while this one waited for the buffer. */
+	xAccepted = pdFAIL;
+	taskENTER_CRITICAL();
+	{
+		if( ( ulSession == ulWriteSession ) && ( eState == eUpdateReceiving ) && ( ulReceived == ulOffset ) )
+		{
+			ulReceived += ( uint32_t ) xLength;
+			xAccepted = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	xQueueSend( ( xAccepted != pdFAIL ) ? xFullChunks : xFreeChunks, &pxChunk, portMAX_DELAY );
+
+	return xAccepted;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateCommit( void )
+{
+const FirmwareUpdateHeader_t *pxHeader = ( const FirmwareUpdateHeader_t * ) _supdate;
+uint32_t ulWords[ 2 ], ulMagic = updateMAGIC;
+TickType_t xStart = xTaskGetTickCount();
+BaseType_t xReturn = pdFAIL;
+
+	xSemaphoreTake( xUpdateMutex, portMAX_DELAY );
+	{
+		if( eState == eUpdateCommitted )
+		{
+			/* Committed again by an empty line repeating the command. */
+			xReturn = pdPASS;
+		}
+		else if( ( eState == eUpdateReceiving ) && ( ulReceived == ulLength ) )
+		{
+			while( ( eState == eUpdateReceiving ) && ( ulProgrammed != ulLength ) &&
+				   ( ( xTaskGetTickCount() - xStart ) < updateCOMMIT_TIMEOUT ) )
+			{
+				vTaskDelay( pdMS_TO_TICKS( 10 ) );
+			}
+
+			/* The CRC is checked against what was read back from the flash,
+			not what was received. */
+			if( ( eState == eUpdateReceiving ) && ( ulProgrammed == ulLength ) &&
+				( ulFirmwareBootCRC32( 0, &_supdate[ updateIMAGE_OFFSET ], ulLength ) == ulCRC ) )
+			{
+				/* The magic is programmed last, so the boot code never sees a
+				header that is only partly written. */
+				ulWords[ 0 ] = ulLength;
+				ulWords[ 1 ] = ulCRC;
+				if( ( xFlashProgram( ( uint32_t ) &( pxHeader->ulLength ), ulWords, sizeof( ulWords ) ) == pdPASS ) &&
+					( xFlashProgram( ( uint32_t ) &( pxHeader->ulMagic ), &ulMagic, sizeof( ulMagic ) ) == pdPASS ) )
+				{
+					xReturn = pdPASS;
+				}
+			}
+
+			taskENTER_CRITICAL();
+			{
+				eState = ( xReturn == pdPASS ) ? eUpdateCommitted : eUpdateFailed;
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+	xSemaphoreGive( xUpdateMutex );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vFirmwareUpdateAbort( void )
+{
+	xSemaphoreTake( xUpdateMutex, portMAX_DELAY );
+	{
+		taskENTER_CRITICAL();
+		{
+			ulSession++;
+			eState = eUpdateIdle;
+		}
+		taskEXIT_CRITICAL();
+	}
+	xSemaphoreGive( xUpdateMutex );
+}
+/*-----------------------------------------------------------*/
+
+void vFirmwareUpdateGetStatus( FirmwareUpdateStatus_t *pxStatus )
+{
+const FirmwareUpdateHeader_t *pxHeader = ( const FirmwareUpdateHeader_t * ) _supdate;
+
+	taskENTER_CRITICAL();
+	{
+		pxStatus->eState = eState;
+		pxStatus->ulLength = ulLength;
+		pxStatus->ulReceived = ulReceived;
+		pxStatus->ulProgrammed = ulProgrammed;
+		pxStatus->ulErased = ulErased;
+	}
+	taskEXIT_CRITICAL();
+
+	pxStatus->ulMaximumLength = ( uint32_t ) ( _eapplication - _sapplication );
+	pxStatus->xInstallPending = ( ( pxHeader->ulMagic == updateMAGIC ) && ( pxHeader->ulInstalled == updateERASED ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateTask( void *pvParameters )
+{
+UpdateChunk_t *pxChunk;
+uint32_t ulTarget, ulTargetSession;
+BaseType_t xEraseAhead;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		/* Data is programmed as soon as it arrives.  Sectors are only erased
+		ahead of it while there is none waiting, which is while the next chunk
+		is being received, and one at a time, so data that arrives meanwhile
+		goes first. */
+		taskENTER_CRITICAL();
+		{
+			xEraseAhead = prvEraseAheadNeeded();
+			ulTarget = ulErased + 1UL;
+			ulTargetSession = ulSession;
+		}
+		taskEXIT_CRITICAL();
+
+		if( xQueueReceive( xFullChunks, &pxChunk, ( xEraseAhead != pdFALSE ) ? 0 : portMAX_DELAY ) == pdTRUE )
+		{
+			if( pxChunk != NULL )
+			{
+				prvProgramChunk( pxChunk );
+				xQueueSend( xFreeChunks, &pxChunk, 0 );
+			}
+		}
+		else if( prvEraseTo( ulTargetSession, ulTarget ) != pdPASS )
+		{
+			prvFail( ulTargetSession );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEraseAheadNeeded( void )
+{
+uint32_t ulEnd;
+
+	if( eState != eUpdateReceiving )
+	{
+		return pdFALSE;
+	}
+
+	ulEnd = updateIMAGE_OFFSET + ulReceived + updateERASE_AHEAD;
+	if( ulEnd > ( updateIMAGE_OFFSET + ulLength ) )
+	{
+		ulEnd = updateIMAGE_OFFSET + ulLength;
+	}
+
+	return ( ulErased < ulEnd ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEraseTo( uint32_t ulSessionToErase, uint32_t ulEnd )
+{
+uint32_t ulStart, ulSize;
+
+	while( ulErased < ulEnd )
+	{
+		if( ulSession != ulSessionToErase )
+		{
+			return pdFAIL;
+		}
+
+		ulSize = ulFlashSector( ( uint32_t ) &_supdate[ ulErased ], &ulStart );
+		if( ( ulSize == 0 ) || ( xFlashEraseSector( ulStart ) != pdPASS ) )
+		{
+			return pdFAIL;
+		}
+
+		taskENTER_CRITICAL();
+		{
+			if( ulSession == ulSessionToErase )
+			{
+				ulErased = ( ulStart + ulSize ) - ( uint32_t ) _supdate;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProgramChunk( UpdateChunk_t *pxChunk )
+{
+const uint8_t *pucTarget = &_supdate[ updateIMAGE_OFFSET + pxChunk->ulOffset ];
+
+	if( pxChunk->ulSession != ulSession )
+	{
+		return;
+	}
+
+	if( ( prvEraseTo( pxChunk->ulSession, updateIMAGE_OFFSET + pxChunk->ulOffset + pxChunk->xLength ) != pdPASS ) ||
+		( xFlashProgram( ( uint32_t ) pucTarget, pxChunk->ucData, pxChunk->xLength ) != pdPASS ) ||
+		( memcmp( pucTarget, pxChunk->ucData, pxChunk->xLength ) != 0 ) )
+	{
+		prvFail( pxChunk->ulSession );
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		if( ulSession == pxChunk->ulSession )
+		{
+			ulProgrammed = pxChunk->ulOffset + ( uint32_t ) pxChunk->xLength;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulFailedSession )
+{
+	taskENTER_CRITICAL();
+	{
+		if( ( ulSession == ulFailedSession ) && ( eState == eUpdateReceiving ) )
+		{
+			eState = eUpdateFailed;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
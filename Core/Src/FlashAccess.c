@@ -0,0 +1,187 @@
+/*
+ * FlashAccess.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "FlashAccess.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "semphr.h"
+
+#include "stm32f7xx_hal.h"
+
+/* The sectors of the 2M flash in single bank mode: four of 32K, one of 128K
+and seven of 256K. */
+#define flashSECTORS				12
+#define flashSMALL_SECTOR_SIZE		( 32UL * 1024UL )
+#define flashMEDIUM_SECTOR_SIZE		( 128UL * 1024UL )
+#define flashLARGE_SECTOR_SIZE		( 256UL * 1024UL )
+#define flashMEDIUM_SECTOR			4
+#define flashFIRST_LARGE_SECTOR		5
+
+#define flashERASED					0xFFFFFFFFUL
+
+static SemaphoreHandle_t xFlashMutex = NULL;
+static StaticSemaphore_t xFlashMutexBuffer;
+
+/*
+ * Take the flash for one operation.  The first caller, which is
+ * ConfigStoreStart(), creates the mutex before the scheduler is started.
+ */
+static void prvLock( void );
+static void prvUnlock( void );
+
+/*
+ * Return the number of the sector that holds ulAddress, or -1.  The start and
+ * size of the sector are returned in *pulStart and *pulSize.
+ */
+static int32_t prvSectorNumber( uint32_t ulAddress, uint32_t *pulStart, uint32_t *pulSize );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xFlashProgram( uint32_t ulAddress, const void *pvData, size_t xLength )
+{
+const uint8_t *pucData = ( const uint8_t * ) pvData;
+uint32_t ulWord;
+size_t xDone, xChunk;
+BaseType_t xReturn = pdPASS;
+
+	configASSERT( ( ulAddress & 3 ) == 0 );
+
+	prvLock();
+	{
+		HAL_FLASH_Unlock();
+		for( xDone = 0; xDone < xLength; xDone += 4 )
+		{
+			ulWord = flashERASED;
+			xChunk = ( ( xLength - xDone ) < 4 ) ? ( xLength - xDone ) : 4;
+			memcpy( &ulWord, &pucData[ xDone ], xChunk );
+
+			if( HAL_FLASH_Program( FLASH_TYPEPROGRAM_WORD, ulAddress + xDone, ulWord ) != HAL_OK )
+			{
+				xReturn = pdFAIL;
+				break;
+			}
+		}
+		HAL_FLASH_Lock();
+
+		/* The flash is read through the D-cache, which still holds the
+		erased words. */
+		SCB_InvalidateDCache_by_Addr( ( uint32_t * ) ( ulAddress & ~31UL ), ( int32_t ) ( xLength + ( ulAddress & 31UL ) ) );
+	}
+	prvUnlock();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFlashEraseSector( uint32_t ulAddress )
+{
+FLASH_EraseInitTypeDef xErase = { 0 };
+uint32_t ulStart, ulSize, ulSectorError = 0;
+int32_t lSector;
+HAL_StatusTypeDef xStatus;
+
+	lSector = prvSectorNumber( ulAddress, &ulStart, &ulSize );
+	if( ( lSector < 0 ) || ( ulStart != ulAddress ) )
+	{
+		return pdFAIL;
+	}
+
+	xErase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	xErase.Sector = ( uint32_t ) lSector;
+	xErase.NbSectors = 1;
+	xErase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	prvLock();
+	{
+		HAL_FLASH_Unlock();
+		xStatus = HAL_FLASHEx_Erase( &xErase, &ulSectorError );
+		HAL_FLASH_Lock();
+
+		SCB_InvalidateDCache_by_Addr( ( uint32_t * ) ulStart, ( int32_t ) ulSize );
+	}
+	prvUnlock();
+
+	return ( xStatus == HAL_OK ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulFlashSector( uint32_t ulAddress, uint32_t *pulStart )
+{
+uint32_t ulSize = 0;
+
+	if( prvSectorNumber( ulAddress, pulStart, &ulSize ) < 0 )
+	{
+		return 0;
+	}
+
+	return ulSize;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvSectorNumber( uint32_t ulAddress, uint32_t *pulStart, uint32_t *pulSize )
+{
+uint32_t ulOffset = ulAddress - FLASH_BASE;
+int32_t lSector;
+
+	if( ( ulAddress < FLASH_BASE ) || ( ulOffset >= ( FLASH_END - FLASH_BASE + 1UL ) ) )
+	{
+		return -1;
+	}
+
+	if( ulOffset < ( flashMEDIUM_SECTOR * flashSMALL_SECTOR_SIZE ) )
+	{
+		lSector = ( int32_t ) ( ulOffset / flashSMALL_SECTOR_SIZE );
+		*pulSize = flashSMALL_SECTOR_SIZE;
+		*pulStart = FLASH_BASE + ( ( uint32_t ) lSector * flashSMALL_SECTOR_SIZE );
+	}
+	else if( ulOffset < flashLARGE_SECTOR_SIZE )
+	{
+		lSector = flashMEDIUM_SECTOR;
+		*pulSize = flashMEDIUM_SECTOR_SIZE;
+		*pulStart = FLASH_BASE + ( flashMEDIUM_SECTOR * flashSMALL_SECTOR_SIZE );
+	}
+	else
+	{
+		lSector = ( int32_t ) ( ( ulOffset / flashLARGE_SECTOR_SIZE ) - 1UL ) + flashFIRST_LARGE_SECTOR;
+		*pulSize = flashLARGE_SECTOR_SIZE;
+		*pulStart = FLASH_BASE + ( ( ulOffset / flashLARGE_SECTOR_SIZE ) * flashLARGE_SECTOR_SIZE );
+	}
+
+	configASSERT( lSector < flashSECTORS );
+
+	return lSector;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLock( void )
+{
+	if( xFlashMutex == NULL )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( xFlashMutex == NULL )
+			{
+				xFlashMutex = xSemaphoreCreateMutexStatic( &xFlashMutexBuffer );
+			}
+		}
+		taskEXIT_CRITICAL();
+		configASSERT( xFlashMutex );
+	}
+
+	xSemaphoreTake( xFlashMutex, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlock( void )
+{
+	xSemaphoreGive( xFlashMutex );
+}
+/*-----------------------------------------------------------*/
@@ -35,6 +35,7 @@
 
 /* Utils includes. */
 #include "FreeRTOS_CLI.h"
+#include "BlockPool.h"
 
 /* If the application writer needs to place the buffer used by the CLI at a
 fixed address then set configAPPLICATION_PROVIDES_cOutputBuffer to 1 in
@@ -46,11 +47,34 @@ one of the application files:
 	#define configAPPLICATION_PROVIDES_cOutputBuffer 0
 #endif
 
-typedef struct xCOMMAND_INPUT_LIST
-{
-	const CLI_Command_Definition_t *pxCommandLineDefinition;
-	struct xCOMMAND_INPUT_LIST *pxNext;
-} CLI_Definition_List_Item_t;
+/* The maximum number of commands that can be registered, including the help
+command.  Registered commands are indexed in a sorted array of this size so
+they can be found with a binary search.  Set configCOMMAND_INT_MAX_COMMANDS in
+FreeRTOSConfig.h to change it.  Not used when configCOMMAND_INT_STATIC_COMMANDS
+is 1. */
+#ifndef configCOMMAND_INT_MAX_COMMANDS
+	#define configCOMMAND_INT_MAX_COMMANDS 32
+#endif
+
+/* The thread local storage pointer used to make the session being served
+available to the command callbacks, see FreeRTOS_CLIGetSession(). */
+#ifndef configCOMMAND_INT_TLS_INDEX
+	#define configCOMMAND_INT_TLS_INDEX 0
+#endif
+
+#if( configNUM_THREAD_LOCAL_STORAGE_POINTERS <= configCOMMAND_INT_TLS_INDEX )
+	#error configNUM_THREAD_LOCAL_STORAGE_POINTERS must be greater than configCOMMAND_INT_TLS_INDEX
+#endif
+
+#if( configCOMMAND_INT_STATIC_COMMANDS == 0 )
+
+	typedef struct xCOMMAND_INPUT_LIST
+	{
+		CLI_Command_Table_Entry_t xEntry;	/* The command and its cached length. */
+		struct xCOMMAND_INPUT_LIST *pxNext;
+	} CLI_Definition_List_Item_t;
+
+#endif /* configCOMMAND_INT_STATIC_COMMANDS */
 
 /*
  * The callback function that is executed when "help" is entered.  This is the
@@ -59,36 +83,106 @@ typedef struct xCOMMAND_INPUT_LIST
 static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
 /*
- * Return the number of parameters that follow the command name.
+ * Find the parameter that starts at or after pcString, skipping any leading
+ * spaces.  A parameter is either a space delimited word or, if it starts with a
+ * double quote, everything up to the closing double quote.  The quotes are not
+ * part of the parameter.  Returns a pointer to the character after the
+ * parameter, or NULL if there are no more parameters.
  */
-static int8_t prvGetNumberOfParameters( const char *pcCommandString );
+static const char *prvNextParameter( const char *pcString, const char **ppcParameter, size_t *pxParameterLength );
+
+/*
+ * Build the parameter table for the command line pcCommandInput in a single
+ * pass over the string.
+ */
+static void prvTokeniseCommand( const char *pcCommandInput, CLI_Parameter_Table_t *pxTable );
+
+/*
+ * Return the parameter table of the command being executed by the calling
+ * task, if pcCommandString is that command's command line, otherwise NULL.
+ */
+static const CLI_Parameter_Table_t *prvGetParameterTable( const char *pcCommandString );
+
+/*
+ * Compare the xLength bytes at pcCommand with a registered command, in the
+ * order used by the command index.
+ */
+static int prvCompareCommand( const char *pcCommand, size_t xLength, const CLI_Command_Table_Entry_t *pxEntry );
+
+/*
+ * Return the position in the command index at which the command pcCommand, of
+ * xLength bytes, is or would be stored.  *pxFound is set to pdTRUE if the
+ * command is registered.
+ */
+static UBaseType_t prvSearchIndex( const char *pcCommand, size_t xLength, BaseType_t *pxFound );
+
+/*
+ * Add the text written to the output buffer of pxSession since the last output
+ * chunk to its output chunks.
+ */
+static void prvChunkOutputText( CLI_Session_t *pxSession );
+
+/*
+ * The help string of a command, the position of the command in the index or
+ * list being kept in the command state.  Called from prvHelpCommand().
+ */
+static const char *prvNextHelpString( CLI_Command_State_t *pxState );
 
 /* The definition of the "help" command.  This command is always at the front
 of the list of registered commands. */
-static const CLI_Command_Definition_t xHelpCommand =
-{
-	"help",
-	"\r\nhelp:\r\n Lists all the registered commands\r\n\r\n",
-	prvHelpCommand,
-	0
-};
-
-/* The definition of the list of commands.  Commands that are registered are
-added to this list. */
-static CLI_Definition_List_Item_t xRegisteredCommands =
-{
-	&xHelpCommand,	/* The first command in the list is always the help command, defined in this file. */
-	NULL			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
-};
+FreeRTOS_CLI_DEFINE_COMMAND_WITH_FLAGS( xHelpCommand, "help", "\r\nhelp:\r\n Lists all the registered commands\r\n\r\n", prvHelpCommand, 0, cliCOMMAND_FLAG_READ_ONLY );
+
+#if( configCOMMAND_INT_STATIC_COMMANDS == 1 )
+
+	/* The command table is collected by the linker from the .cli_commands.*
+	input sections.  Each section is named after its command string and the
+	linker script sorts them by name, so the table is already in the order
+	needed by the binary search and nothing has to be done at run time.  See the
+	.cli_commands output section in the linker scripts. */
+	extern const CLI_Command_Table_Entry_t __cli_commands_start[];
+	extern const CLI_Command_Table_Entry_t __cli_commands_end[];
+
+	#define cliINDEXED_COMMAND( uxPosition )	( &__cli_commands_start[ ( uxPosition ) ] )
+	#define cliINDEXED_COMMAND_COUNT()			( ( UBaseType_t ) ( __cli_commands_end - __cli_commands_start ) )
+
+#else
+
+	/* The definition of the list of commands.  Commands that are registered are
+	added to this list. */
+	static CLI_Definition_List_Item_t xRegisteredCommands =
+	{
+		{
+			&xHelpCommand,	/* The first command in the list is always the help command, defined in this file. */
+			sizeof( "help" ) - 1
+		},
+		NULL			/* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+	};
+
+	/* The registered commands sorted by command string, so the command entered on
+	the command line can be found with a binary search rather than by walking the
+	list.  The list above is still used to keep the registration order for the help
+	command. */
+	static CLI_Definition_List_Item_t *pxCommandIndex[ configCOMMAND_INT_MAX_COMMANDS ] =
+	{
+		&xRegisteredCommands
+	};
+	static UBaseType_t uxIndexedCommands = 1;
+
+	#define cliINDEXED_COMMAND( uxPosition )	( &( pxCommandIndex[ ( uxPosition ) ]->xEntry ) )
+	#define cliINDEXED_COMMAND_COUNT()			( uxIndexedCommands )
+
+#endif /* configCOMMAND_INT_STATIC_COMMANDS */
+
+/* The session used by FreeRTOS_CLIProcessCommand(), which predates sessions
+and is therefore not re-entrant. */
+static CLI_Session_t xDefaultSession;
 
 /* A buffer into which command outputs can be written is declared here, rather
-than in the command console implementation, to allow multiple command consoles
-to share the same buffer.  For example, an application may allow access to the
-command interpreter by UART and by Ethernet.  Sharing a buffer is done purely
-to save RAM.  Note, however, that the command console itself is not re-entrant,
-so only one command interpreter interface can be used at any one time.  For that
-reason, no attempt at providing mutual exclusion to the cOutputBuffer array is
-attempted.
+than in the command console implementation, to allow a command console that
+does not need its own buffer to use this one.  Each session can be given its
+own output buffer, so consoles that run at the same time in different tasks
+must not share this buffer.  No attempt at providing mutual exclusion to the
+cOutputBuffer array is made.
 
 configAPPLICATION_PROVIDES_cOutputBuffer is provided to allow the application
 writer to provide their own cOutputBuffer declaration in cases where the
@@ -102,109 +196,202 @@ buffer needs to be placed at a fixed address (rather than by the linker). */
 
 /*-----------------------------------------------------------*/
 
-BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
-{
-static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
-CLI_Definition_List_Item_t *pxNewListItem;
-BaseType_t xReturn = pdFAIL;
+#if( configCOMMAND_INT_STATIC_COMMANDS == 1 )
+
+	BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
+	{
+	BaseType_t xFound;
+	UBaseType_t uxPosition;
 
-	/* Check the parameter is not NULL. */
-	configASSERT( pxCommandToRegister );
+		/* Commands are collected into the table at link time, so there is
+		nothing to do other than check the command really is in the table. */
+		configASSERT( pxCommandToRegister );
+		uxPosition = prvSearchIndex( pxCommandToRegister->pcCommand, strlen( pxCommandToRegister->pcCommand ), &xFound );
 
-	/* Create a new list item that will reference the command being registered. */
-	pxNewListItem = ( CLI_Definition_List_Item_t * ) pvPortMalloc( sizeof( CLI_Definition_List_Item_t ) );
-	configASSERT( pxNewListItem );
+		if( ( xFound != pdFALSE ) && ( cliINDEXED_COMMAND( uxPosition )->pxCommandLineDefinition == pxCommandToRegister ) )
+		{
+			return pdPASS;
+		}
 
-	if( pxNewListItem != NULL )
+		return pdFAIL;
+	}
+
+#else
+
+	BaseType_t FreeRTOS_CLIRegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
 	{
-		taskENTER_CRITICAL();
+	static CLI_Definition_List_Item_t *pxLastCommandInList = &xRegisteredCommands;
+	CLI_Definition_List_Item_t *pxNewListItem;
+	BaseType_t xReturn = pdFAIL, xFound;
+	UBaseType_t uxPosition;
+	size_t xCommandLength;
+
+		/* Check the parameter is not NULL. */
+		configASSERT( pxCommandToRegister );
+
+		/* Commands are looked up by the first word on the command line, so the
+		command string itself must be a single word. */
+		configASSERT( strchr( pxCommandToRegister->pcCommand, ' ' ) == NULL );
+		xCommandLength = strlen( pxCommandToRegister->pcCommand );
+
+		/* Create a new list item that will reference the command being
+		registered.  It comes from the block pool so registering commands does
+		not fragment the heap. */
+		pxNewListItem = ( CLI_Definition_List_Item_t * ) pvBlockPoolAllocate( sizeof( CLI_Definition_List_Item_t ) );
+		configASSERT( pxNewListItem );
+
+		if( pxNewListItem != NULL )
 		{
-			/* Reference the command being registered from the newly created
-			list item. */
-			pxNewListItem->pxCommandLineDefinition = pxCommandToRegister;
+			taskENTER_CRITICAL();
+			{
+				uxPosition = prvSearchIndex( pxCommandToRegister->pcCommand, xCommandLength, &xFound );
 
-			/* The new list item will get added to the end of the list, so
-			pxNext has nowhere to point. */
-			pxNewListItem->pxNext = NULL;
+				/* A command can only be registered once, and the index must have
+				space for it. */
+				if( ( xFound == pdFALSE ) && ( uxIndexedCommands < configCOMMAND_INT_MAX_COMMANDS ) )
+				{
+					/* Reference the command being registered from the newly created
+					list item. */
+					pxNewListItem->xEntry.pxCommandLineDefinition = pxCommandToRegister;
+					pxNewListItem->xEntry.xCommandLength = xCommandLength;
+
+					/* The new list item will get added to the end of the list, so
+					pxNext has nowhere to point. */
+					pxNewListItem->pxNext = NULL;
+
+					/* Add the newly created list item to the end of the already existing
+					list. */
+					pxLastCommandInList->pxNext = pxNewListItem;
+
+					/* Set the end of list marker to the new list item. */
+					pxLastCommandInList = pxNewListItem;
+
+					/* Insert the list item into the sorted index. */
+					memmove( &pxCommandIndex[ uxPosition + 1 ], &pxCommandIndex[ uxPosition ], ( uxIndexedCommands - uxPosition ) * sizeof( pxCommandIndex[ 0 ] ) );
+					pxCommandIndex[ uxPosition ] = pxNewListItem;
+					uxIndexedCommands++;
 
-			/* Add the newly created list item to the end of the already existing
-			list. */
-			pxLastCommandInList->pxNext = pxNewListItem;
+					xReturn = pdPASS;
+				}
+			}
+			taskEXIT_CRITICAL();
 
-			/* Set the end of list marker to the new list item. */
-			pxLastCommandInList = pxNewListItem;
+			if( xReturn != pdPASS )
+			{
+				vBlockPoolFree( pxNewListItem );
+			}
 		}
-		taskEXIT_CRITICAL();
 
-		xReturn = pdPASS;
+		configASSERT( xReturn == pdPASS );
+
+		return xReturn;
 	}
 
-	return xReturn;
+#endif /* configCOMMAND_INT_STATIC_COMMANDS */
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLISessionInit( CLI_Session_t *pxSession, char *pcOutputBuffer, size_t xOutputBufferLength )
+{
+	configASSERT( pxSession );
+	configASSERT( pcOutputBuffer );
+
+	memset( pxSession, 0x00, sizeof( CLI_Session_t ) );
+	pxSession->pcOutputBuffer = pcOutputBuffer;
+	pxSession->xOutputBufferLength = xOutputBufferLength;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
+BaseType_t FreeRTOS_CLIProcessSessionCommand( CLI_Session_t *pxSession, const char * const pcCommandInput )
 {
-static const CLI_Definition_List_Item_t *pxCommand = NULL;
-BaseType_t xReturn = pdTRUE;
-const char *pcRegisteredCommandString;
+BaseType_t xReturn = pdTRUE, xFound;
+UBaseType_t uxPosition;
 size_t xCommandStringLength;
+char *pcWriteBuffer;
+size_t xWriteBufferLen;
+void *pvCallingSession;
+
+	configASSERT( pxSession );
+	pcWriteBuffer = pxSession->pcOutputBuffer;
+	xWriteBufferLen = pxSession->xOutputBufferLength;
+
+	/* All the state used to execute the command is held in the session, so
+	different sessions can be served by different tasks at the same time.  The
+	session is made available to the command itself through the calling task's
+	thread local storage, and the previous value restored afterwards in case one
+	session is executing commands on behalf of another. */
+	pvCallingSession = pvTaskGetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX );
+	vTaskSetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX, pxSession );
+
+	if( pxSession->pxCommand == NULL )
+	{
+		/* Split the command line into the command and its parameters.  The
+		command is the first word of the input string.  To ensure the string
+		lengths match exactly, so as not to pick up a sub-string of a longer
+		command, the whole word is compared. */
+		prvTokeniseCommand( pcCommandInput, &( pxSession->xParameters ) );
+		xCommandStringLength = pxSession->xParameters.xCommandLength;
 
-	/* Note:  This function is not re-entrant.  It must not be called from more
-	thank one task. */
+		/* The command starts with a clean state. */
+		memset( &( pxSession->xCommandState ), 0x00, sizeof( pxSession->xCommandState ) );
 
-	if( pxCommand == NULL )
-	{
-		/* Search for the command string in the list of registered commands. */
-		for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
+		/* Search for the command string in the index of registered commands. */
+		uxPosition = prvSearchIndex( pcCommandInput, xCommandStringLength, &xFound );
+
+		if( xFound != pdFALSE )
 		{
-			pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-			xCommandStringLength = strlen( pcRegisteredCommandString );
-
-			/* To ensure the string lengths match exactly, so as not to pick up
-			a sub-string of a longer command, check the byte after the expected
-			end of the string is either the end of the string or a space before
-			a parameter. */
-			if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+			pxSession->pxCommand = cliINDEXED_COMMAND( uxPosition );
+
+			/* The command has been found.  Check it has the expected
+			number of parameters.  If cExpectedNumberOfParameters is -1,
+			then there could be a variable number of parameters and no
+			check is made. */
+			if( pxSession->pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
 			{
-				if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+				if( pxSession->xParameters.uxNumberOfParameters != ( UBaseType_t ) pxSession->pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
 				{
-					/* The command has been found.  Check it has the expected
-					number of parameters.  If cExpectedNumberOfParameters is -1,
-					then there could be a variable number of parameters and no
-					check is made. */
-					if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-						{
-							xReturn = pdFALSE;
-						}
-					}
-
-					break;
+					xReturn = pdFALSE;
 				}
 			}
 		}
 	}
 
-	if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+	/* The output of each call starts afresh. */
+	pxSession->uxOutputChunks = 0;
+	pxSession->xOutputChunked = 0;
+
+	if( ( pxSession->pxCommand != NULL ) && ( xReturn == pdFALSE ) )
 	{
 		/* The command was found, but the number of parameters with the command
 		was incorrect. */
 		strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-		pxCommand = NULL;
+		pxSession->pxCommand = NULL;
 	}
-	else if( pxCommand != NULL )
+	else if( pxSession->pxCommand != NULL )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		xReturn = pxSession->pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+
+		/* Whatever the command wrote after its last reference follows it.  A
+		session executing commands on behalf of another, into the same output
+		buffer, passes the chunks on. */
+		if( pxSession->uxOutputChunks > 0 )
+		{
+			prvChunkOutputText( pxSession );
+
+			if( ( pvCallingSession != NULL ) && ( ( ( CLI_Session_t * ) pvCallingSession )->pcOutputBuffer == pcWriteBuffer ) )
+			{
+				memcpy( ( ( CLI_Session_t * ) pvCallingSession )->xOutputChunks, pxSession->xOutputChunks, pxSession->uxOutputChunks * sizeof( CLI_Output_Chunk_t ) );
+				( ( CLI_Session_t * ) pvCallingSession )->uxOutputChunks = pxSession->uxOutputChunks;
+				( ( CLI_Session_t * ) pvCallingSession )->xOutputChunked = pxSession->xOutputChunked;
+			}
+		}
 
 		/* If xReturn is pdFALSE, then no further strings will be returned
 		after this one, and	pxCommand can be reset to NULL ready to search
 		for the next entered command. */
 		if( xReturn == pdFALSE )
 		{
-			pxCommand = NULL;
+			pxSession->pxCommand = NULL;
 		}
 	}
 	else
@@ -214,10 +401,235 @@ size_t xCommandStringLength;
 		xReturn = pdFALSE;
 	}
 
+	vTaskSetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX, pvCallingSession );
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+void FreeRTOS_CLIAbandonCommand( CLI_Session_t *pxSession )
+{
+void *pvCallingSession;
+
+	configASSERT( pxSession );
+
+	if( pxSession->pxCommand != NULL )
+	{
+		/* The abandon function runs in the session, as the command did, in case
+		it has a session of its own to abandon. */
+		if( pxSession->xCommandState.pxAbandon != NULL )
+		{
+			pvCallingSession = pvTaskGetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX );
+			vTaskSetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX, pxSession );
+			pxSession->xCommandState.pxAbandon( &( pxSession->xCommandState ) );
+			vTaskSetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX, pvCallingSession );
+		}
+
+		pxSession->pxCommand = NULL;
+		memset( &( pxSession->xCommandState ), 0x00, sizeof( pxSession->xCommandState ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer, size_t xWriteBufferLen  )
+{
+	/* Note:  This function is not re-entrant.  It must not be called from more
+	thank one task. */
+	xDefaultSession.pcOutputBuffer = pcWriteBuffer;
+	xDefaultSession.xOutputBufferLength = xWriteBufferLen;
+
+	return FreeRTOS_CLIProcessSessionCommand( &xDefaultSession, pcCommandInput );
+}
+/*-----------------------------------------------------------*/
+
+CLI_Session_t *FreeRTOS_CLIGetSession( void )
+{
+	return ( CLI_Session_t * ) pvTaskGetThreadLocalStoragePointer( NULL, configCOMMAND_INT_TLS_INDEX );
+}
+/*-----------------------------------------------------------*/
+
+CLI_Command_State_t *FreeRTOS_CLIGetCommandState( void )
+{
+CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+CLI_Command_State_t *pxReturn = NULL;
+
+	if( ( pxSession != NULL ) && ( pxSession->pxCommand != NULL ) )
+	{
+		pxReturn = &( pxSession->xCommandState );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLISetMachineReadable( CLI_Session_t *pxSession, BaseType_t xMachineReadable )
+{
+	configASSERT( pxSession );
+	pxSession->xMachineReadable = xMachineReadable;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIIsMachineReadable( void )
+{
+CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+
+	return ( ( pxSession != NULL ) && ( pxSession->xMachineReadable != pdFALSE ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLISetSessionOwner( CLI_Session_t *pxSession, void *pvOwner )
+{
+	configASSERT( pxSession );
+	pxSession->pvOwner = pvOwner;
+}
+/*-----------------------------------------------------------*/
+
+void *FreeRTOS_CLIGetSessionOwner( void )
+{
+CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+
+	return ( pxSession != NULL ) ? pxSession->pvOwner : NULL;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLISetAcceptsReferences( CLI_Session_t *pxSession, BaseType_t xAcceptsReferences )
+{
+	configASSERT( pxSession );
+	pxSession->xAcceptsReferences = xAcceptsReferences;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIAcceptsReferences( void )
+{
+CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+
+	return ( ( pxSession != NULL ) && ( pxSession->xAcceptsReferences != pdFALSE ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIWriteReference( const char *pcData, size_t xLength )
+{
+CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+CLI_Output_Chunk_t *pxChunk;
+
+	/* There has to be room for the text written before the reference, the
+	reference, and the text written after it. */
+	if( ( pxSession == NULL ) || ( pxSession->xAcceptsReferences == pdFALSE ) || ( xLength > UINT16_MAX ) ||
+		( ( pxSession->uxOutputChunks + 3 ) > configCOMMAND_INT_MAX_OUTPUT_CHUNKS ) )
+	{
+		return pdFAIL;
+	}
+
+	if( xLength > 0 )
+	{
+		prvChunkOutputText( pxSession );
+
+		pxChunk = &( pxSession->xOutputChunks[ pxSession->uxOutputChunks ] );
+		pxChunk->pcData = pcData;
+		pxChunk->usLength = ( uint16_t ) xLength;
+		pxChunk->ucReference = pdTRUE;
+		pxSession->uxOutputChunks++;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t FreeRTOS_CLIGetOutputChunks( const CLI_Session_t *pxSession, const CLI_Output_Chunk_t **ppxChunks )
+{
+	configASSERT( pxSession );
+	*ppxChunks = pxSession->xOutputChunks;
+	return pxSession->uxOutputChunks;
+}
+/*-----------------------------------------------------------*/
+
+static void prvChunkOutputText( CLI_Session_t *pxSession )
+{
+size_t xText = strlen( pxSession->pcOutputBuffer );
+CLI_Output_Chunk_t *pxChunk;
+
+	if( xText > pxSession->xOutputChunked )
+	{
+		pxChunk = &( pxSession->xOutputChunks[ pxSession->uxOutputChunks ] );
+		pxChunk->pcData = &( pxSession->pcOutputBuffer[ pxSession->xOutputChunked ] );
+		pxChunk->usLength = ( uint16_t ) ( xText - pxSession->xOutputChunked );
+		pxChunk->ucReference = pdFALSE;
+		pxSession->uxOutputChunks++;
+		pxSession->xOutputChunked = xText;
+	}
+}
+/*-----------------------------------------------------------*/
+
+const CLI_Command_Definition_t *FreeRTOS_CLIGetCommand( UBaseType_t uxPosition )
+{
+	if( uxPosition >= cliINDEXED_COMMAND_COUNT() )
+	{
+		return NULL;
+	}
+
+	return cliINDEXED_COMMAND( uxPosition )->pxCommandLineDefinition;
+}
+/*-----------------------------------------------------------*/
+
+const CLI_Command_Definition_t *FreeRTOS_CLIFindCommand( const char *pcCommandInput )
+{
+size_t xCommandStringLength = 0;
+UBaseType_t uxPosition;
+BaseType_t xFound;
+
+	configASSERT( pcCommandInput );
+
+	/* The command is the first word of the command line. */
+	while( ( pcCommandInput[ xCommandStringLength ] != 0x00 ) && ( pcCommandInput[ xCommandStringLength ] != ' ' ) )
+	{
+		xCommandStringLength++;
+	}
+
+	uxPosition = prvSearchIndex( pcCommandInput, xCommandStringLength, &xFound );
+
+	return ( xFound != pdFALSE ) ? cliINDEXED_COMMAND( uxPosition )->pxCommandLineDefinition : NULL;
+}
+/*-----------------------------------------------------------*/
+
+const char *FreeRTOS_CLINextCommand( const char *pcCommands, char *pcCommand, size_t xCommandLength )
+{
+size_t xLength = 0;
+BaseType_t xQuoted = pdFALSE;
+
+	configASSERT( pcCommands );
+	configASSERT( pcCommand );
+	configASSERT( xCommandLength > 0 );
+
+	while( *pcCommands == ' ' )
+	{
+		pcCommands++;
+	}
+
+	while( ( *pcCommands != 0x00 ) && ( ( *pcCommands != ';' ) || ( xQuoted != pdFALSE ) ) )
+	{
+		if( *pcCommands == '"' )
+		{
+			xQuoted = ( xQuoted == pdFALSE ) ? pdTRUE : pdFALSE;
+		}
+
+		if( xLength < ( xCommandLength - 1 ) )
+		{
+			pcCommand[ xLength ] = *pcCommands;
+			xLength++;
+		}
+		pcCommands++;
+	}
+
+	while( ( xLength > 0 ) && ( pcCommand[ xLength - 1 ] == ' ' ) )
+	{
+		xLength--;
+	}
+	pcCommand[ xLength ] = 0x00;
+
+	return ( *pcCommands == ';' ) ? ( pcCommands + 1 ) : NULL;
+}
+/*-----------------------------------------------------------*/
+
 char *FreeRTOS_CLIGetOutputBuffer( void )
 {
 	return cOutputBuffer;
@@ -227,125 +639,305 @@ char *FreeRTOS_CLIGetOutputBuffer( void )
 const char *FreeRTOS_CLIGetParameter( const char *pcCommandString, UBaseType_t uxWantedParameter, BaseType_t *pxParameterStringLength )
 {
 UBaseType_t uxParametersFound = 0;
-const char *pcReturn = NULL;
+const char *pcReturn = NULL, *pcParameter;
+size_t xParameterLength;
+const CLI_Parameter_Table_t *pxTable = prvGetParameterTable( pcCommandString );
 
 	*pxParameterStringLength = 0;
 
-	while( uxParametersFound < uxWantedParameter )
+	if( uxWantedParameter == 0 )
 	{
-		/* Index the character pointer past the current word.  If this is the start
-		of the command string then the first word is the command itself. */
-		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
+		/* Parameters are numbered from 1, the command itself is not a
+		parameter. */
+	}
+	else if( ( pxTable != NULL ) && ( uxWantedParameter <= configCOMMAND_INT_MAX_PARAMETERS ) )
+	{
+		/* This is the command being executed, so the position of the parameter
+		is already known. */
+		if( uxWantedParameter <= pxTable->uxNumberOfParameters )
 		{
-			pcCommandString++;
+			pcReturn = pcCommandString + pxTable->xParameters[ uxWantedParameter - 1 ].usOffset;
+			*pxParameterStringLength = ( BaseType_t ) pxTable->xParameters[ uxWantedParameter - 1 ].usLength;
 		}
-
-		/* Find the start of the next string. */
-		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) == ' ' ) )
+	}
+	else
+	{
+		/* Index the character pointer past the command itself, which is the
+		first word of the command string. */
+		while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
 		{
 			pcCommandString++;
 		}
 
-		/* Was a string found? */
-		if( *pcCommandString != 0x00 )
+		/* Step through the parameters until the wanted one is found. */
+		while( ( pcCommandString = prvNextParameter( pcCommandString, &pcParameter, &xParameterLength ) ) != NULL )
 		{
-			/* Is this the start of the required parameter? */
 			uxParametersFound++;
 
 			if( uxParametersFound == uxWantedParameter )
 			{
-				/* How long is the parameter? */
-				pcReturn = pcCommandString;
-				while( ( ( *pcCommandString ) != 0x00 ) && ( ( *pcCommandString ) != ' ' ) )
-				{
-					( *pxParameterStringLength )++;
-					pcCommandString++;
-				}
-
-				if( *pxParameterStringLength == 0 )
-				{
-					pcReturn = NULL;
-				}
-
+				pcReturn = pcParameter;
+				*pxParameterStringLength = ( BaseType_t ) xParameterLength;
 				break;
 			}
 		}
-		else
-		{
-			break;
-		}
 	}
 
 	return pcReturn;
 }
 /*-----------------------------------------------------------*/
 
+UBaseType_t FreeRTOS_CLIGetNumberOfParameters( const char *pcCommandString )
+{
+CLI_Parameter_Table_t xTable;
+const CLI_Parameter_Table_t *pxTable = prvGetParameterTable( pcCommandString );
+
+	if( pxTable != NULL )
+	{
+		return pxTable->uxNumberOfParameters;
+	}
+
+	prvTokeniseCommand( pcCommandString, &xTable );
+	return xTable.uxNumberOfParameters;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
-static const CLI_Definition_List_Item_t * pxCommand = NULL;
-BaseType_t xReturn;
+CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+CLI_Command_State_t xNext;
+const char *pcHelpString;
+BaseType_t xReferenced = pdFALSE;
 
 	( void ) pcCommandString;
+	configASSERT( pxState );
 
-	if( pxCommand == NULL )
+	/* When the console can send the help strings from flash, as many of them
+	as the output of one call can hold are referenced each call.  Otherwise
+	one is copied to the output buffer per call. */
+	for( ;; )
 	{
-		/* Reset the pxCommand pointer back to the start of the list. */
-		pxCommand = &xRegisteredCommands;
+		xNext = *pxState;
+		pcHelpString = prvNextHelpString( &xNext );
+		if( pcHelpString == NULL )
+		{
+			/* There are no more commands, so there will be no more strings to
+			return after this one and pdFALSE should be returned. */
+			return pdFALSE;
+		}
+
+		if( FreeRTOS_CLIWriteReference( pcHelpString, strlen( pcHelpString ) ) != pdPASS )
+		{
+			if( xReferenced != pdFALSE )
+			{
+				/* The rest are referenced by the next call. */
+				return pdTRUE;
+			}
+
+			strncpy( pcWriteBuffer, pcHelpString, xWriteBufferLen );
+			*pxState = xNext;
+			break;
+		}
+
+		xReferenced = pdTRUE;
+		*pxState = xNext;
 	}
 
-	/* Return the next command help string, before moving the pointer on to
-	the next command in the list. */
-	strncpy( pcWriteBuffer, pxCommand->pxCommandLineDefinition->pcHelpString, xWriteBufferLen );
-	pxCommand = pxCommand->pxNext;
+	xNext = *pxState;
+	return ( prvNextHelpString( &xNext ) != NULL ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+#if( configCOMMAND_INT_STATIC_COMMANDS == 1 )
 
-	if( pxCommand == NULL )
+	static const char *prvNextHelpString( CLI_Command_State_t *pxState )
 	{
-		/* There are no more commands in the list, so there will be no more
-		strings to return after this one and pdFALSE should be returned. */
-		xReturn = pdFALSE;
+	const char *pcHelpString = NULL;
+
+		/* The command table is sorted, so the commands are listed in
+		alphabetical order.  The position in the table is kept in the command
+		state of the session, which starts at zero. */
+		if( pxState->uxIndex < cliINDEXED_COMMAND_COUNT() )
+		{
+			pcHelpString = cliINDEXED_COMMAND( pxState->uxIndex )->pxCommandLineDefinition->pcHelpString;
+			pxState->uxIndex++;
+		}
+
+		return pcHelpString;
 	}
-	else
+
+#else
+
+	static const char *prvNextHelpString( CLI_Command_State_t *pxState )
 	{
-		xReturn = pdTRUE;
+	const CLI_Definition_List_Item_t * pxCommand;
+
+		/* The position in the list is kept in the command state of the session.
+		xStep is set once the first command has been listed, after which a
+		NULL position is the end of the list. */
+		if( pxState->xStep == 0 )
+		{
+			pxCommand = &xRegisteredCommands;
+		}
+		else
+		{
+			pxCommand = ( const CLI_Definition_List_Item_t * ) pxState->pvPosition;
+		}
+
+		if( pxCommand == NULL )
+		{
+			return NULL;
+		}
+
+		pxState->xStep = 1;
+		pxState->pvPosition = pxCommand->pxNext;
+
+		return pxCommand->xEntry.pxCommandLineDefinition->pcHelpString;
 	}
 
-	return xReturn;
+#endif /* configCOMMAND_INT_STATIC_COMMANDS */
+/*-----------------------------------------------------------*/
+
+static const char *prvNextParameter( const char *pcString, const char **ppcParameter, size_t *pxParameterLength )
+{
+char cTerminator = ' ';
+
+	/* Find the start of the next parameter. */
+	while( *pcString == ' ' )
+	{
+		pcString++;
+	}
+
+	if( *pcString == 0x00 )
+	{
+		/* There are no more parameters. */
+		return NULL;
+	}
+
+	if( *pcString == '"' )
+	{
+		/* A quoted parameter can contain spaces.  It ends at the closing quote,
+		or the end of the string if the closing quote is missing. */
+		cTerminator = '"';
+		pcString++;
+	}
+
+	*ppcParameter = pcString;
+
+	while( ( *pcString != 0x00 ) && ( *pcString != cTerminator ) )
+	{
+		pcString++;
+	}
+
+	*pxParameterLength = ( size_t ) ( pcString - *ppcParameter );
+
+	if( ( cTerminator == '"' ) && ( *pcString == '"' ) )
+	{
+		/* Step over the closing quote. */
+		pcString++;
+	}
+
+	return pcString;
 }
 /*-----------------------------------------------------------*/
 
-static int8_t prvGetNumberOfParameters( const char *pcCommandString )
+static void prvTokeniseCommand( const char *pcCommandInput, CLI_Parameter_Table_t *pxTable )
 {
-int8_t cParameters = 0;
-BaseType_t xLastCharacterWasSpace = pdFALSE;
+const char *pcString = pcCommandInput, *pcParameter;
+size_t xParameterLength;
+UBaseType_t uxParameters = 0;
 
-	/* Count the number of space delimited words in pcCommandString. */
-	while( *pcCommandString != 0x00 )
+	/* The first word is the command itself. */
+	while( ( *pcString != 0x00 ) && ( *pcString != ' ' ) )
 	{
-		if( ( *pcCommandString ) == ' ' )
-		{
-			if( xLastCharacterWasSpace != pdTRUE )
-			{
-				cParameters++;
-				xLastCharacterWasSpace = pdTRUE;
-			}
-		}
-		else
+		pcString++;
+	}
+
+	pxTable->pcCommandString = pcCommandInput;
+	pxTable->xCommandLength = ( size_t ) ( pcString - pcCommandInput );
+
+	/* Record the position of each parameter that follows it. */
+	while( ( pcString = prvNextParameter( pcString, &pcParameter, &xParameterLength ) ) != NULL )
+	{
+		if( uxParameters < configCOMMAND_INT_MAX_PARAMETERS )
 		{
-			xLastCharacterWasSpace = pdFALSE;
+			pxTable->xParameters[ uxParameters ].usOffset = ( uint16_t ) ( pcParameter - pcCommandInput );
+			pxTable->xParameters[ uxParameters ].usLength = ( uint16_t ) xParameterLength;
 		}
 
-		pcCommandString++;
+		uxParameters++;
+	}
+
+	pxTable->uxNumberOfParameters = uxParameters;
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Parameter_Table_t *prvGetParameterTable( const char *pcCommandString )
+{
+const CLI_Session_t *pxSession = FreeRTOS_CLIGetSession();
+const CLI_Parameter_Table_t *pxReturn = NULL;
+
+	if( ( pxSession != NULL ) && ( pxSession->pxCommand != NULL ) && ( pxSession->xParameters.pcCommandString == pcCommandString ) )
+	{
+		pxReturn = &( pxSession->xParameters );
 	}
 
-	/* If the command string ended with spaces, then there will have been too
-	many parameters counted. */
-	if( xLastCharacterWasSpace == pdTRUE )
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareCommand( const char *pcCommand, size_t xLength, const CLI_Command_Table_Entry_t *pxEntry )
+{
+size_t xCompareLength;
+int iReturn;
+
+	xCompareLength = ( xLength < pxEntry->xCommandLength ) ? xLength : pxEntry->xCommandLength;
+	iReturn = memcmp( pcCommand, pxEntry->pxCommandLineDefinition->pcCommand, xCompareLength );
+
+	if( iReturn == 0 )
 	{
-		cParameters--;
+		/* One is a prefix of the other, the shorter one sorts first. */
+		if( xLength < pxEntry->xCommandLength )
+		{
+			iReturn = -1;
+		}
+		else if( xLength > pxEntry->xCommandLength )
+		{
+			iReturn = 1;
+		}
 	}
 
-	/* The value returned is one less than the number of space delimited words,
-	as the first word should be the command itself. */
-	return cParameters;
+	return iReturn;
 }
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvSearchIndex( const char *pcCommand, size_t xLength, BaseType_t *pxFound )
+{
+UBaseType_t uxLow = 0, uxHigh = cliINDEXED_COMMAND_COUNT(), uxMiddle;
+int iComparison;
+
+	*pxFound = pdFALSE;
+
+	while( uxLow < uxHigh )
+	{
+		uxMiddle = uxLow + ( ( uxHigh - uxLow ) / 2 );
+		iComparison = prvCompareCommand( pcCommand, xLength, cliINDEXED_COMMAND( uxMiddle ) );
+
+		if( iComparison == 0 )
+		{
+			*pxFound = pdTRUE;
+			uxLow = uxMiddle;
+			break;
+		}
+		else if( iComparison < 0 )
+		{
+			uxHigh = uxMiddle;
+		}
+		else
+		{
+			uxLow = uxMiddle + 1;
+		}
+	}
 
+	return uxLow;
+}
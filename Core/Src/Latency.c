@@ -0,0 +1,260 @@
+/*
+ * Latency.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "Latency.h"
+
+#include <string.h>
+
+#include "stm32f7xx_hal.h"
+#include "MemoryLayout.h"
+
+/* Measurements below 4 cycles get a bucket each.  Above that each power of two
+is split into 4 buckets, so a bucket is at most 25% wide and the whole 32-bit
+range fits in 124 buckets. */
+#define latencySUB_BUCKET_BITS		2
+#define latencySUB_BUCKETS			( 1UL << latencySUB_BUCKET_BITS )
+#define latencyBUCKETS				( ( 32 - latencySUB_BUCKET_BITS + 1 ) * latencySUB_BUCKETS )
+
+typedef struct xLATENCY_HISTOGRAM
+{
+	/* Incremented before and after the histogram is changed, so it is odd
+	while a measurement is being added.  Readers retry if it changed while they
+	read the histogram. */
+	volatile uint32_t ulSequence;
+
+	/* Set by vLatencyReset() and cleared by the writer. */
+	volatile BaseType_t xResetRequested;
+
+	uint32_t ulCount;
+	uint32_t ulMinimum;
+	uint32_t ulMaximum;
+	uint32_t ulBuckets[ latencyBUCKETS ];
+} Histogram_t;
+
+static Histogram_t xHistograms[ eLatencyHistograms ] memoryDTCM_BSS;
+
+static const char * const pcNames[ eLatencyHistograms ] =
+{
+	"uart-callback",
+	"uart-wake",
+	"tick-jitter"
+};
+
+/* The cycle counter on entry to the last USART3 interrupt, and on entry to the
+first one since the console task last ran. */
+static volatile uint32_t ulUARTInterruptEntry memoryDTCM_BSS;
+static volatile uint32_t ulUARTWakeStart memoryDTCM_BSS;
+static volatile BaseType_t xUARTWakePending memoryDTCM_BSS;
+
+/* The cycle counter on entry to the last TIM1 interrupt. */
+static uint32_t ulLastTick memoryDTCM_BSS;
+static BaseType_t xLastTickValid memoryDTCM_BSS;
+
+/*
+ * The bucket a measurement falls in, and the largest measurement that falls
+ * in a bucket.
+ */
+static uint32_t prvBucket( uint32_t ulCycles );
+static uint32_t prvBucketUpperEdge( uint32_t ulBucket );
+
+/*
+ * The smallest measurement that is larger than or equal to ulRank of them.
+ */
+static uint32_t prvRank( const Histogram_t *pxHistogram, uint32_t ulRank );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBucket( uint32_t ulCycles )
+{
+uint32_t ulMostSignificantBit;
+
+	if( ulCycles < latencySUB_BUCKETS )
+	{
+		return ulCycles;
+	}
+
+	ulMostSignificantBit = 31UL - __CLZ( ulCycles );
+	return ( ( ulMostSignificantBit - latencySUB_BUCKET_BITS + 1 ) * latencySUB_BUCKETS ) +
+			( ( ulCycles >> ( ulMostSignificantBit - latencySUB_BUCKET_BITS ) ) & ( latencySUB_BUCKETS - 1 ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBucketUpperEdge( uint32_t ulBucket )
+{
+uint32_t ulShift;
+
+	if( ulBucket < latencySUB_BUCKETS )
+	{
+		return ulBucket;
+	}
+
+	ulShift = ( ulBucket / latencySUB_BUCKETS ) - 1;
+	return ( ( ( latencySUB_BUCKETS + ( ulBucket % latencySUB_BUCKETS ) + 1 ) << ulShift ) - 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRank( const Histogram_t *pxHistogram, uint32_t ulRank )
+{
+uint32_t ulBucket, ulSeen = 0, ulReturn;
+
+	for( ulBucket = 0; ulBucket < ( latencyBUCKETS - 1 ); ulBucket++ )
+	{
+		ulSeen += pxHistogram->ulBuckets[ ulBucket ];
+		if( ulSeen >= ulRank )
+		{
+			break;
+		}
+	}
+
+	/* The edge of the bucket can be outside the measured range. */
+	ulReturn = prvBucketUpperEdge( ulBucket );
+	if( ulReturn > pxHistogram->ulMaximum )
+	{
+		ulReturn = pxHistogram->ulMaximum;
+	}
+	if( ulReturn < pxHistogram->ulMinimum )
+	{
+		ulReturn = pxHistogram->ulMinimum;
+	}
+
+	return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+memoryITCM_CODE void vLatencyRecord( LatencyHistogram_t eHistogram, uint32_t ulCycles )
+{
+Histogram_t *pxHistogram = &xHistograms[ eHistogram ];
+
+	pxHistogram->ulSequence++;
+	__DMB();
+
+	if( pxHistogram->xResetRequested != pdFALSE )
+	{
+		pxHistogram->xResetRequested = pdFALSE;
+		pxHistogram->ulCount = 0;
+		memset( pxHistogram->ulBuckets, 0x00, sizeof( pxHistogram->ulBuckets ) );
+	}
+
+	if( ( pxHistogram->ulCount == 0 ) || ( ulCycles < pxHistogram->ulMinimum ) )
+	{
+		pxHistogram->ulMinimum = ulCycles;
+	}
+	if( ( pxHistogram->ulCount == 0 ) || ( ulCycles > pxHistogram->ulMaximum ) )
+	{
+		pxHistogram->ulMaximum = ulCycles;
+	}
+	pxHistogram->ulCount++;
+	pxHistogram->ulBuckets[ prvBucket( ulCycles ) ]++;
+
+	__DMB();
+	pxHistogram->ulSequence++;
+}
+/*-----------------------------------------------------------*/
+
+memoryITCM_CODE void vLatencyUARTInterrupt( void )
+{
+uint32_t ulNow = DWT->CYCCNT;
+
+	ulUARTInterruptEntry = ulNow;
+
+	/* The task is woken by the first interrupt of a burst, so later ones
+	until it runs do not restart the measurement. */
+	if( xUARTWakePending == pdFALSE )
+	{
+		ulUARTWakeStart = ulNow;
+		xUARTWakePending = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+memoryITCM_CODE void vLatencyUARTCallback( void )
+{
+	vLatencyRecord( eLatencyUARTCallback, DWT->CYCCNT - ulUARTInterruptEntry );
+}
+/*-----------------------------------------------------------*/
+
+void vLatencyUARTTaskResumed( void )
+{
+uint32_t ulNow = DWT->CYCCNT, ulStart;
+
+	if( xUARTWakePending != pdFALSE )
+	{
+		ulStart = ulUARTWakeStart;
+		xUARTWakePending = pdFALSE;
+		vLatencyRecord( eLatencyUARTWake, ulNow - ulStart );
+	}
+}
+/*-----------------------------------------------------------*/
+
+memoryITCM_CODE void vLatencyTick( void )
+{
+uint32_t ulNow = DWT->CYCCNT, ulPeriod, ulExpected;
+
+	/* The cycle counter is only started with the scheduler. */
+	if( ( DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk ) == 0 )
+	{
+		return;
+	}
+
+	if( xLastTickValid != pdFALSE )
+	{
+		ulPeriod = ulNow - ulLastTick;
+		ulExpected = SystemCoreClock / 1000UL;
+		vLatencyRecord( eLatencyTickJitter, ( ulPeriod > ulExpected ) ? ( ulPeriod - ulExpected ) : ( ulExpected - ulPeriod ) );
+	}
+
+	ulLastTick = ulNow;
+	xLastTickValid = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vLatencyTickRestart( void )
+{
+	xLastTickValid = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vLatencyGetSummary( LatencyHistogram_t eHistogram, LatencySummary_t *pxSummary )
+{
+const Histogram_t *pxHistogram = &xHistograms[ eHistogram ];
+uint32_t ulSequence;
+
+	do
+	{
+		/* Wait for a measurement that is being added to complete. */
+		do
+		{
+			ulSequence = pxHistogram->ulSequence;
+		} while( ( ulSequence & 1UL ) != 0 );
+		__DMB();
+
+		memset( pxSummary, 0x00, sizeof( LatencySummary_t ) );
+
+		if( ( pxHistogram->xResetRequested == pdFALSE ) && ( pxHistogram->ulCount > 0 ) )
+		{
+			pxSummary->ulCount = pxHistogram->ulCount;
+			pxSummary->ulMinimum = pxHistogram->ulMinimum;
+			pxSummary->ulMaximum = pxHistogram->ulMaximum;
+			pxSummary->ulMedian = prvRank( pxHistogram, ( pxSummary->ulCount + 1 ) / 2 );
+			pxSummary->ul99thPercentile = prvRank( pxHistogram, ( uint32_t ) ( ( ( uint64_t ) pxSummary->ulCount * 99ULL + 99ULL ) / 100ULL ) );
+		}
+
+		__DMB();
+	} while( pxHistogram->ulSequence != ulSequence );
+}
+/*-----------------------------------------------------------*/
+
+void vLatencyReset( LatencyHistogram_t eHistogram )
+{
+	xHistograms[ eHistogram ].xResetRequested = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+const char *pcLatencyName( LatencyHistogram_t eHistogram )
+{
+	return pcNames[ eHistogram ];
+}
@@ -0,0 +1,49 @@
+/*
+ * MemoryLayout.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "MemoryLayout.h"
+
+#include "stm32f7xx_hal.h"
+
+/* The size of the non-cacheable region that holds the .dma_buffer section.
+Must match _Dma_Buffer_Size in the linker script, which aligns the section to
+it as the MPU requires. */
+#define memoryDMA_REGION_SIZE		MPU_REGION_SIZE_16KB
+
+/* Defined by the linker script. */
+extern uint8_t _sdma_buffer[];
+
+/*-----------------------------------------------------------*/
+
+void vMemoryLayoutConfigure( void )
+{
+MPU_Region_InitTypeDef xRegion;
+
+	HAL_MPU_Disable();
+
+	/* The DMA buffers are normal memory that is never cached (TEX 1, C 0,
+	B 0), so the CPU and the DMA controllers always see the same contents.
+	Everything else keeps the default memory map, in which the SRAM and TCMs
+	are write-back cacheable. */
+	xRegion.Enable = MPU_REGION_ENABLE;
+	xRegion.Number = MPU_REGION_NUMBER0;
+	xRegion.BaseAddress = ( uint32_t ) _sdma_buffer;
+	xRegion.Size = memoryDMA_REGION_SIZE;
+	xRegion.SubRegionDisable = 0x00;
+	xRegion.TypeExtField = MPU_TEX_LEVEL1;
+	xRegion.AccessPermission = MPU_REGION_FULL_ACCESS;
+	xRegion.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+	xRegion.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+	xRegion.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+	xRegion.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+	HAL_MPU_ConfigRegion( &xRegion );
+
+	HAL_MPU_Enable( MPU_PRIVILEGED_DEFAULT );
+
+	SCB_EnableICache();
+	SCB_EnableDCache();
+}
@@ -0,0 +1,484 @@
+/*
+ * NetworkInterface.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "NetworkInterface.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+#include "TelnetCommandConsole.h"
+#include "TraceLog.h"
+
+#include "stm32f7xx_hal.h"
+#include "MemoryLayout.h"
+
+/* The number of Ethernet DMA transmit descriptors.  A frame uses one
+descriptor for its headers and, when it has a payload, a second one that
+points straight at the payload. */
+#define networkTX_DESCRIPTORS		8
+
+/* Each transmit descriptor has a slot for the headers of the frame it
+starts. */
+#define networkTX_HEADER_SIZE		( networkETHERNET_HEADER_SIZE + networkIPV4_HEADER_SIZE + networkMAX_TRANSPORT_HEADER )
+
+/* The maximum time in ticks to wait for the DMA to release transmit
+descriptors before the frame is dropped. */
+#define networkMAX_TX_WAIT			( 10 / portTICK_PERIOD_MS )
+
+/* How often the TCP timers run, in ticks. */
+#define networkTIMER_PERIOD			( telnetTIMER_PERIOD_MS / portTICK_PERIOD_MS )
+
+/* The Cortex-M7 data cache line size. */
+#define networkCACHE_LINE_SIZE		32
+
+#define networkETHERTYPE_IPV4		0x0800
+#define networkETHERTYPE_ARP		0x0806
+
+#define networkARP_PACKET_SIZE		28
+#define networkARP_REQUEST			1
+#define networkARP_REPLY			2
+
+#define networkICMP_HEADER_SIZE		8
+#define networkICMP_ECHO_REPLY		0
+#define networkICMP_ECHO_REQUEST	8
+
+#define networkIP_TTL				64
+
+extern ETH_HandleTypeDef heth;
+
+/* Ethernet DMA descriptors and buffers.  Received frames are processed in
+place, straight from the receive buffers.  All of them are in the
+non-cacheable DMA region, the cache maintenance below is only needed for the
+payloads sent in place from ordinary memory. */
+static ETH_DMADescTypeDef xRxDescriptors[ ETH_RXBUFNB ] memoryDMA_BUFFER __ALIGNED( 4 );
+static ETH_DMADescTypeDef xTxDescriptors[ networkTX_DESCRIPTORS ] memoryDMA_BUFFER __ALIGNED( 4 );
+static uint8_t ucRxBuffers[ ETH_RXBUFNB ][ ETH_RX_BUF_SIZE ] memoryDMA_BUFFER __ALIGNED( networkCACHE_LINE_SIZE );
+static uint8_t ucTxHeaders[ networkTX_DESCRIPTORS ][ networkTX_HEADER_SIZE ] memoryDMA_BUFFER __ALIGNED( networkCACHE_LINE_SIZE );
+
+/* Protects the transmit descriptors and all the protocol state. */
+static SemaphoreHandle_t xNetworkMutex = NULL;
+
+/* Given by the Ethernet interrupt when a frame has been received. */
+static SemaphoreHandle_t xRxSemaphore = NULL;
+
+/* The identification field of the next IPv4 packet sent. */
+static uint16_t usIPIdentification = 0;
+
+static void prvNetworkTask( void *pvParameters );
+
+/*
+ * Queue a frame made of pucHeader followed by pucPayload for transmission.
+ * The header is copied into the header slot of the first descriptor, the
+ * payload is read by the DMA in place.
+ */
+static BaseType_t prvTransmitFrame( const uint8_t *pucHeader, size_t xHeaderLength, const uint8_t *pucPayload, size_t xPayloadLength );
+
+/*
+ * Wait until the DMA has sent every queued frame.
+ */
+static void prvWaitForTransmitter( void );
+
+/*
+ * Frame processing, called by the network task with the lock held.
+ */
+static void prvProcessFrame( const uint8_t *pucFrame, size_t xLength );
+static void prvProcessARP( const uint8_t *pucFrame, size_t xLength );
+static void prvProcessIPv4( const uint8_t *pucFrame, size_t xLength );
+static void prvProcessICMP( const uint8_t *pucSourceMAC, uint32_t ulSourceIP, const uint8_t *pucPacket, size_t xLength );
+
+/*
+ * Cache maintenance for buffers shared with the Ethernet DMA.  Both are
+ * harmless while the data cache is disabled.
+ */
+static void prvCleanDCache( const void *pvAddress, size_t xLength );
+static void prvInvalidateDCache( const void *pvAddress, size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+void NetworkInterfaceStart( uint16_t usStackSize, unsigned portBASE_TYPE uxPriority )
+{
+	/* Both are used as soon as the task runs, so they are created first. */
+	xNetworkMutex = xSemaphoreCreateMutex();
+	configASSERT( xNetworkMutex );
+	vSemaphoreCreateBinary( xRxSemaphore );
+	configASSERT( xRxSemaphore );
+	xSemaphoreTake( xRxSemaphore, 0 );
+
+	/* Create that task that handles the network interface. */
+	xTaskCreate( 	prvNetworkTask,						/* The task that implements the network interface. */
+					"ETH",								/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+					usStackSize,						/* The size of the stack allocated to the task. */
+					NULL,								/* The parameter is not used, so NULL is passed. */
+					uxPriority,							/* The priority allocated to the task. */
+					NULL );								/* A handle is not required, so just pass NULL. */
+}
+/*-----------------------------------------------------------*/
+
+void vNetworkLock( void )
+{
+	xSemaphoreTake( xNetworkMutex, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+void vNetworkUnlock( void )
+{
+	xSemaphoreGive( xNetworkMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvNetworkTask( void *pvParameters )
+{
+ETH_DMADescTypeDef *pxDescriptor;
+TickType_t xLastTimer;
+uint32_t x;
+
+	( void ) pvParameters;
+
+	/* The header slots replace the transmit buffers the HAL would use. */
+	HAL_ETH_DMATxDescListInit( &heth, xTxDescriptors, &ucTxHeaders[ 0 ][ 0 ], networkTX_DESCRIPTORS );
+	for( x = 0; x < networkTX_DESCRIPTORS; x++ )
+	{
+		xTxDescriptors[ x ].Buffer1Addr = ( uint32_t ) ucTxHeaders[ x ];
+	}
+	HAL_ETH_DMARxDescListInit( &heth, xRxDescriptors, &ucRxBuffers[ 0 ][ 0 ], ETH_RXBUFNB );
+
+	/* MX_ETH_Init() configures the MAC for polling, so enable the receive
+	interrupt here. */
+	__HAL_ETH_DMA_ENABLE_IT( &heth, ETH_DMA_IT_NIS | ETH_DMA_IT_R );
+	HAL_ETH_Start( &heth );
+
+	xLastTimer = xTaskGetTickCount();
+
+	for( ;; )
+	{
+		/* Wait for a frame, but wake up in time to run the timers. */
+		xSemaphoreTake( xRxSemaphore, networkTIMER_PERIOD );
+
+		while( HAL_ETH_GetReceivedFrame_IT( &heth ) == HAL_OK )
+		{
+			/* Frames always fit in a single receive buffer, anything else is
+			dropped. */
+			if( heth.RxFrameInfos.SegCount == 1 )
+			{
+				prvInvalidateDCache( ( const void * ) heth.RxFrameInfos.buffer, heth.RxFrameInfos.length );
+
+				vNetworkLock();
+				{
+					prvProcessFrame( ( const uint8_t * ) heth.RxFrameInfos.buffer, heth.RxFrameInfos.length );
+				}
+				vNetworkUnlock();
+			}
+
+			/* Give the descriptors back to the DMA, and restart reception if
+			it stopped because all the buffers were in use. */
+			pxDescriptor = heth.RxFrameInfos.FSRxDesc;
+			for( x = 0; x < heth.RxFrameInfos.SegCount; x++ )
+			{
+				pxDescriptor->Status |= ETH_DMARXDESC_OWN;
+				pxDescriptor = ( ETH_DMADescTypeDef * ) pxDescriptor->Buffer2NextDescAddr;
+			}
+			heth.RxFrameInfos.SegCount = 0;
+
+			if( ( heth.Instance->DMASR & ETH_DMASR_RBUS ) != 0 )
+			{
+				heth.Instance->DMASR = ETH_DMASR_RBUS;
+				heth.Instance->DMARPDR = 0;
+				vTraceLog( "ETH receive buffers exhausted", 0, 0, 0, 0 );
+			}
+		}
+
+		if( ( xTaskGetTickCount() - xLastTimer ) >= networkTIMER_PERIOD )
+		{
+			xLastTimer = xTaskGetTickCount();
+
+			vNetworkLock();
+			{
+				vTelnetTimer();
+			}
+			vNetworkUnlock();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HAL_ETH_RxCpltCallback( ETH_HandleTypeDef *pxHandle )
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	( void ) pxHandle;
+
+	xSemaphoreGiveFromISR( xRxSemaphore, &xHigherPriorityTaskWoken );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTransmitFrame( const uint8_t *pucHeader, size_t xHeaderLength, const uint8_t *pucPayload, size_t xPayloadLength )
+{
+ETH_DMADescTypeDef *pxFirst = heth.TxDesc, *pxLast = pxFirst;
+uint8_t *pucSlot;
+TickType_t xWaited = 0;
+
+	if( xPayloadLength > 0 )
+	{
+		pxLast = ( ETH_DMADescTypeDef * ) pxFirst->Buffer2NextDescAddr;
+	}
+
+	/* Wait for the DMA to release the descriptors. */
+	while( ( ( pxFirst->Status & ETH_DMATXDESC_OWN ) != 0 ) || ( ( pxLast->Status & ETH_DMATXDESC_OWN ) != 0 ) )
+	{
+		if( xWaited >= networkMAX_TX_WAIT )
+		{
+			return pdFAIL;
+		}
+
+		vTaskDelay( 1 );
+		xWaited++;
+	}
+
+	pucSlot = ucTxHeaders[ pxFirst - xTxDescriptors ];
+	memcpy( pucSlot, pucHeader, xHeaderLength );
+	prvCleanDCache( pucSlot, xHeaderLength );
+	pxFirst->Buffer1Addr = ( uint32_t ) pucSlot;
+	pxFirst->ControlBufferSize = ( xHeaderLength & ETH_DMATXDESC_TBS1 );
+
+	if( pxLast != pxFirst )
+	{
+		/* The payload is sent from where it is. */
+		prvCleanDCache( pucPayload, xPayloadLength );
+		pxLast->Buffer1Addr = ( uint32_t ) pucPayload;
+		pxLast->ControlBufferSize = ( xPayloadLength & ETH_DMATXDESC_TBS1 );
+		pxLast->Status = ( pxLast->Status & ~( ETH_DMATXDESC_FS | ETH_DMATXDESC_LS ) ) | ETH_DMATXDESC_LS | ETH_DMATXDESC_OWN;
+		pxFirst->Status = ( pxFirst->Status & ~( ETH_DMATXDESC_FS | ETH_DMATXDESC_LS ) ) | ETH_DMATXDESC_FS;
+	}
+	else
+	{
+		pxFirst->Status = ( pxFirst->Status & ~( ETH_DMATXDESC_FS | ETH_DMATXDESC_LS ) ) | ETH_DMATXDESC_FS | ETH_DMATXDESC_LS;
+	}
+
+	/* The first descriptor is handed over last so the DMA never sees a
+	partial frame. */
+	__DSB();
+	pxFirst->Status |= ETH_DMATXDESC_OWN;
+	__DSB();
+
+	heth.TxDesc = ( ETH_DMADescTypeDef * ) pxLast->Buffer2NextDescAddr;
+
+	/* Resume the DMA if it had run out of descriptors. */
+	if( ( heth.Instance->DMASR & ETH_DMASR_TBUS ) != 0 )
+	{
+		heth.Instance->DMASR = ETH_DMASR_TBUS;
+		heth.Instance->DMATPDR = 0;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForTransmitter( void )
+{
+TickType_t xWaited = 0;
+uint32_t x;
+
+	for( x = 0; x < networkTX_DESCRIPTORS; x++ )
+	{
+		while( ( ( xTxDescriptors[ x ].Status & ETH_DMATXDESC_OWN ) != 0 ) && ( xWaited < networkMAX_TX_WAIT ) )
+		{
+			vTaskDelay( 1 );
+			xWaited++;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkSendIPv4( const uint8_t *pucDestinationMAC, uint32_t ulDestinationIP, uint8_t ucProtocol,
+							 const uint8_t *pucTransportHeader, size_t xTransportHeaderLength,
+							 const uint8_t *pucPayload, size_t xPayloadLength )
+{
+uint8_t ucHeader[ networkTX_HEADER_SIZE ];
+uint8_t *pucIP = &ucHeader[ networkETHERNET_HEADER_SIZE ];
+
+	configASSERT( xTransportHeaderLength <= networkMAX_TRANSPORT_HEADER );
+	configASSERT( ( xTransportHeaderLength + xPayloadLength ) <= ( networkMTU - networkIPV4_HEADER_SIZE ) );
+
+	/* Ethernet header. */
+	memcpy( &ucHeader[ 0 ], pucDestinationMAC, 6 );
+	memcpy( &ucHeader[ 6 ], heth.Init.MACAddr, 6 );
+	vNetworkWrite16( &ucHeader[ 12 ], networkETHERTYPE_IPV4 );
+
+	/* IPv4 header, without options.  The checksum is left 0 for the MAC to
+	fill in. */
+	pucIP[ 0 ] = 0x45;
+	pucIP[ 1 ] = 0;
+	vNetworkWrite16( &pucIP[ 2 ], ( uint16_t ) ( networkIPV4_HEADER_SIZE + xTransportHeaderLength + xPayloadLength ) );
+	vNetworkWrite16( &pucIP[ 4 ], usIPIdentification++ );
+	vNetworkWrite16( &pucIP[ 6 ], 0x4000 );		/* Don't fragment. */
+	pucIP[ 8 ] = networkIP_TTL;
+	pucIP[ 9 ] = ucProtocol;
+	vNetworkWrite16( &pucIP[ 10 ], 0 );
+	vNetworkWrite32( &pucIP[ 12 ], networkIP_ADDRESS );
+	vNetworkWrite32( &pucIP[ 16 ], ulDestinationIP );
+
+	memcpy( &pucIP[ networkIPV4_HEADER_SIZE ], pucTransportHeader, xTransportHeaderLength );
+
+	return prvTransmitFrame( ucHeader, networkETHERNET_HEADER_SIZE + networkIPV4_HEADER_SIZE + xTransportHeaderLength, pucPayload, xPayloadLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessFrame( const uint8_t *pucFrame, size_t xLength )
+{
+	if( xLength < networkETHERNET_HEADER_SIZE )
+	{
+		return;
+	}
+
+	switch( usNetworkRead16( &pucFrame[ 12 ] ) )
+	{
+		case networkETHERTYPE_ARP:
+			prvProcessARP( pucFrame, xLength );
+			break;
+
+		case networkETHERTYPE_IPV4:
+			prvProcessIPv4( pucFrame, xLength );
+			break;
+
+		default:
+			break;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessARP( const uint8_t *pucFrame, size_t xLength )
+{
+const uint8_t *pucARP = &pucFrame[ networkETHERNET_HEADER_SIZE ];
+uint8_t ucReply[ networkETHERNET_HEADER_SIZE + networkARP_PACKET_SIZE ];
+uint8_t *pucReplyARP = &ucReply[ networkETHERNET_HEADER_SIZE ];
+
+	/* Only requests for the address of the board are answered.  Replies to
+	other packets are sent to the MAC address they came from, so there is no
+	need for an ARP cache. */
+	if( ( xLength < sizeof( ucReply ) ) ||
+		( usNetworkRead16( &pucARP[ 0 ] ) != 1 ) ||
+		( usNetworkRead16( &pucARP[ 2 ] ) != networkETHERTYPE_IPV4 ) ||
+		( pucARP[ 4 ] != 6 ) || ( pucARP[ 5 ] != 4 ) ||
+		( usNetworkRead16( &pucARP[ 6 ] ) != networkARP_REQUEST ) ||
+		( ulNetworkRead32( &pucARP[ 24 ] ) != networkIP_ADDRESS ) )
+	{
+		return;
+	}
+
+	memcpy( &ucReply[ 0 ], &pucARP[ 8 ], 6 );
+	memcpy( &ucReply[ 6 ], heth.Init.MACAddr, 6 );
+	vNetworkWrite16( &ucReply[ 12 ], networkETHERTYPE_ARP );
+
+	memcpy( pucReplyARP, pucARP, 6 );
+	vNetworkWrite16( &pucReplyARP[ 6 ], networkARP_REPLY );
+	memcpy( &pucReplyARP[ 8 ], heth.Init.MACAddr, 6 );
+	vNetworkWrite32( &pucReplyARP[ 14 ], networkIP_ADDRESS );
+	memcpy( &pucReplyARP[ 18 ], &pucARP[ 8 ], 10 );
+
+	( void ) prvTransmitFrame( ucReply, sizeof( ucReply ), NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessIPv4( const uint8_t *pucFrame, size_t xLength )
+{
+const uint8_t *pucIP = &pucFrame[ networkETHERNET_HEADER_SIZE ];
+size_t xHeaderLength, xTotalLength;
+uint32_t ulSourceIP;
+
+	xLength -= networkETHERNET_HEADER_SIZE;
+	if( xLength < networkIPV4_HEADER_SIZE )
+	{
+		return;
+	}
+
+	xHeaderLength = ( size_t ) ( pucIP[ 0 ] & 0x0F ) * 4;
+	xTotalLength = usNetworkRead16( &pucIP[ 2 ] );
+
+	/* Checksums were verified by the MAC, which drops frames that fail.
+	Fragments are not reassembled. */
+	if( ( ( pucIP[ 0 ] >> 4 ) != 4 ) ||
+		( xHeaderLength < networkIPV4_HEADER_SIZE ) ||
+		( xTotalLength < xHeaderLength ) || ( xTotalLength > xLength ) ||
+		( ( usNetworkRead16( &pucIP[ 6 ] ) & 0x3FFF ) != 0 ) ||
+		( ulNetworkRead32( &pucIP[ 16 ] ) != networkIP_ADDRESS ) )
+	{
+		return;
+	}
+
+	ulSourceIP = ulNetworkRead32( &pucIP[ 12 ] );
+
+	switch( pucIP[ 9 ] )
+	{
+		case networkPROTOCOL_ICMP:
+			prvProcessICMP( &pucFrame[ 6 ], ulSourceIP, &pucIP[ xHeaderLength ], xTotalLength - xHeaderLength );
+			break;
+
+		case networkPROTOCOL_TCP:
+			vTelnetTCPInput( &pucFrame[ 6 ], ulSourceIP, &pucIP[ xHeaderLength ], xTotalLength - xHeaderLength );
+			break;
+
+		default:
+			break;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessICMP( const uint8_t *pucSourceMAC, uint32_t ulSourceIP, const uint8_t *pucPacket, size_t xLength )
+{
+uint8_t ucHeader[ networkICMP_HEADER_SIZE ];
+
+	if( ( xLength < networkICMP_HEADER_SIZE ) || ( pucPacket[ 0 ] != networkICMP_ECHO_REQUEST ) )
+	{
+		return;
+	}
+
+	/* The reply keeps the identifier, sequence number and data of the
+	request.  The checksum is filled in by the MAC. */
+	memcpy( ucHeader, pucPacket, networkICMP_HEADER_SIZE );
+	ucHeader[ 0 ] = networkICMP_ECHO_REPLY;
+	ucHeader[ 1 ] = 0;
+	vNetworkWrite16( &ucHeader[ 2 ], 0 );
+
+	/* The data is sent straight from the receive buffer, which must not be
+	given back to the DMA before it has been sent. */
+	if( xNetworkSendIPv4( pucSourceMAC, ulSourceIP, networkPROTOCOL_ICMP, ucHeader, sizeof( ucHeader ),
+						  &pucPacket[ networkICMP_HEADER_SIZE ], xLength - networkICMP_HEADER_SIZE ) == pdPASS )
+	{
+		prvWaitForTransmitter();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCleanDCache( const void *pvAddress, size_t xLength )
+{
+uint32_t ulStart = ( uint32_t ) pvAddress & ~( networkCACHE_LINE_SIZE - 1 );
+uint32_t ulEnd = ( uint32_t ) pvAddress + xLength;
+
+	if( xLength > 0 )
+	{
+		SCB_CleanDCache_by_Addr( ( uint32_t * ) ulStart, ( int32_t ) ( ulEnd - ulStart ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInvalidateDCache( const void *pvAddress, size_t xLength )
+{
+uint32_t ulStart = ( uint32_t ) pvAddress & ~( networkCACHE_LINE_SIZE - 1 );
+uint32_t ulEnd = ( uint32_t ) pvAddress + xLength;
+
+	if( xLength > 0 )
+	{
+		SCB_InvalidateDCache_by_Addr( ( uint32_t * ) ulStart, ( int32_t ) ( ulEnd - ulStart ) );
+	}
+}
@@ -0,0 +1,997 @@
+/*
+ * TelnetCommandConsole.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "TelnetCommandConsole.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+#include "CommandConsole.h"
+
+#include "NetworkInterface.h"
+#include "TraceLog.h"
+
+#include "stm32f7xx_hal.h"
+
+/* Dimensions the buffer received characters are placed in until the session
+task processes them.  Its free space is the window advertised to the peer, so
+input is paced rather than lost while a command executes. */
+#define telnetRX_BUFFER_SIZE		256
+
+/* Dimensions the buffer output is copied to until the peer acknowledges it,
+which must be a power of two.  Several segments can be in flight, so the
+session task only waits for the peer once it has this much outstanding.
+Output is gathered until a full segment is waiting or the console flushes, so
+echoes and prompts share a segment with the output around them. */
+#define telnetTX_BUFFER_SIZE		4096
+#define telnetTX_BUFFER_MASK		( telnetTX_BUFFER_SIZE - 1 )
+
+/* The number of times the RNG is polled for an initial sequence number. */
+#define telnetRNG_ATTEMPTS			100
+
+/* The MSS advertised to, and assumed for, peers. */
+#define telnetMSS					( networkMTU - networkIPV4_HEADER_SIZE - telnetTCP_HEADER_SIZE )
+#define telnetDEFAULT_PEER_MSS		536
+
+/* Retransmission timing, in ticks. */
+#define telnetINITIAL_RTO			( 250 / portTICK_PERIOD_MS )
+#define telnetMAX_RTO				( 4000 / portTICK_PERIOD_MS )
+#define telnetMAX_RETRIES			6
+
+#define telnetTCP_HEADER_SIZE		20
+#define telnetTCP_MSS_OPTION_SIZE	4
+
+/* TCP flags. */
+#define telnetTCP_FIN				0x01
+#define telnetTCP_SYN				0x02
+#define telnetTCP_RST				0x04
+#define telnetTCP_PSH				0x08
+#define telnetTCP_ACK				0x10
+
+/* Telnet commands. */
+#define telnetIAC					255
+#define telnetDONT					254
+#define telnetWILL					251
+#define telnetSB					250
+#define telnetSE					240
+#define telnetOPTION_ECHO			1
+#define telnetOPTION_SGA			3
+
+/* Sequence number comparisons that cope with wrapping. */
+#define telnetSEQ_LT( a, b )		( ( int32_t ) ( ( a ) - ( b ) ) < 0 )
+#define telnetSEQ_LEQ( a, b )		( ( int32_t ) ( ( a ) - ( b ) ) <= 0 )
+
+/* The states of a connection.  Connections are only ever opened by the peer,
+and closed after the peer closes its side, or reset.  Once the peer has
+closed its side, the output of what it sent is still sent before this side is
+closed. */
+typedef enum
+{
+	eTcpClosed = 0,
+	eTcpSynReceived,
+	eTcpEstablished,
+	eTcpCloseWait,
+	eTcpLastAck
+} TcpState_t;
+
+/* The states of the telnet command parser. */
+typedef enum
+{
+	eTelnetData = 0,
+	eTelnetCommand,
+	eTelnetOption,
+	eTelnetSubnegotiation,
+	eTelnetSubnegotiationCommand
+} TelnetState_t;
+
+typedef struct xTELNET_SESSION
+{
+	/* The connection.  Protected by the network lock. */
+	TcpState_t eState;
+	uint8_t ucRemoteMAC[ 6 ];
+	uint32_t ulRemoteIP;
+	uint16_t usRemotePort;
+	uint16_t usPeerMSS;
+	uint32_t ulSndUna;
+	uint32_t ulSndNxt;
+	uint32_t ulSndWnd;
+	uint32_t ulRcvNxt;
+	uint16_t usAdvertisedWindow;
+
+	/* The output from ulSndUna to ulTxEnd, of which the part from ulSndNxt
+	has not been sent yet.  The byte with sequence number n is at
+	ucTxBuffer[ ( n - ulTxStart ) & telnetTX_BUFFER_MASK ]. */
+	uint8_t ucTxBuffer[ telnetTX_BUFFER_SIZE ];
+	uint32_t ulTxStart;
+	uint32_t ulTxEnd;
+
+	/* Retransmission of the oldest unacknowledged segment. */
+	TickType_t xTxTime;
+	TickType_t xRto;
+	UBaseType_t uxRetries;
+
+	/* Incremented each time a connection is established, so the session task
+	can tell a new connection from the one it was serving. */
+	volatile uint32_t ulConnection;
+
+	/* Received data.  Written up to xRxHead by the network task and consumed
+	from xRxTail by the session task. */
+	uint8_t ucRxBuffer[ telnetRX_BUFFER_SIZE ];
+	volatile size_t xRxHead;
+	volatile size_t xRxTail;
+
+	/* Given when data is received, and when the connection opens or
+	closes. */
+	SemaphoreHandle_t xEventSemaphore;
+
+	/* Given when data sent has been acknowledged, which makes room in
+	ucTxBuffer, or the connection closes. */
+	SemaphoreHandle_t xTxSemaphore;
+
+	/* The console.  Only used by the session task. */
+	CommandConsole_t xConsole;
+	uint32_t ulConsoleConnection;
+	TelnetState_t eTelnetState;
+	char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+} TelnetSession_t;
+
+/* Sent when a connection opens so the client leaves the echo to the console
+and sends each character as it is typed. */
+static const uint8_t ucNegotiation[] = { telnetIAC, telnetWILL, telnetOPTION_ECHO, telnetIAC, telnetWILL, telnetOPTION_SGA };
+
+static TelnetSession_t xSessions[ telnetMAX_SESSIONS ];
+
+/* The initial sequence number of the last connection, used only if the RNG
+fails. */
+static uint32_t ulNextISN = 0;
+
+static void prvTelnetSessionTask( void *pvParameters );
+
+/*
+ * Console transport functions.  pvTransport is the session.
+ */
+static BaseType_t prvTelnetWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+static void prvTelnetFlush( void *pvTransport );
+
+/*
+ * Called by the session task.
+ */
+static BaseType_t prvQueueData( TelnetSession_t *pxSession, const uint8_t *pucData, size_t xLength, size_t *pxQueued );
+static BaseType_t prvWaitForAcknowledgement( TelnetSession_t *pxSession, size_t xSpace );
+static void prvCloseAfterPeer( TelnetSession_t *pxSession );
+static void prvTelnetInput( TelnetSession_t *pxSession, const uint8_t *pucData, size_t xLength );
+
+/*
+ * Called with the network lock held.
+ */
+static BaseType_t prvConnectionOpen( const TelnetSession_t *pxSession );
+static uint32_t prvInitialSequenceNumber( void );
+static void prvOutput( TelnetSession_t *pxSession, BaseType_t xProbe );
+static void prvSendSegment( TelnetSession_t *pxSession, uint8_t ucFlags, uint32_t ulSeq, const uint8_t *pucPayload, size_t xLength );
+static void prvSendReset( const uint8_t *pucMAC, uint32_t ulIP, const uint8_t *pucSegment, size_t xDataLength );
+static void prvCloseSession( TelnetSession_t *pxSession );
+static size_t prvReceiveWindow( const TelnetSession_t *pxSession );
+
+/* Output is always copied, so TCP can send it again after the caller has
+reused its buffer, and references are written as any other output. */
+static const CommandConsoleTransport_t xTelnetTransport =
+{
+	prvTelnetWrite,
+	prvTelnetFlush,
+	NULL
+};
+
+/*-----------------------------------------------------------*/
+
+void TelnetCommandConsoleStart( uint16_t usStackSize, unsigned portBASE_TYPE uxPriority )
+{
+char cTaskName[ configMAX_TASK_NAME_LEN ];
+UBaseType_t x;
+
+	/* The initial sequence numbers come from the RNG, which runs from the
+	48 MHz clock that is also used by USB. */
+	__HAL_RCC_RNG_CLK_ENABLE();
+	RNG->CR |= RNG_CR_RNGEN;
+
+	for( x = 0; x < telnetMAX_SESSIONS; x++ )
+	{
+		/* The semaphores are given by the network task, so they are created
+		before it can accept connections. */
+		vSemaphoreCreateBinary( xSessions[ x ].xEventSemaphore );
+		configASSERT( xSessions[ x ].xEventSemaphore );
+		vSemaphoreCreateBinary( xSessions[ x ].xTxSemaphore );
+		configASSERT( xSessions[ x ].xTxSemaphore );
+		xSemaphoreTake( xSessions[ x ].xEventSemaphore, 0 );
+		xSemaphoreTake( xSessions[ x ].xTxSemaphore, 0 );
+
+		/* Each session has its own task, so a long running command on one
+		connection does not hold up the others. */
+		snprintf( cTaskName, sizeof( cTaskName ), "Telnet%u", ( unsigned ) x );
+		xTaskCreate( 	prvTelnetSessionTask,				/* The task that implements the session. */
+						cTaskName,							/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+						usStackSize,						/* The size of the stack allocated to the task. */
+						&xSessions[ x ],					/* The session served by the task. */
+						uxPriority,							/* The priority allocated to the task. */
+						NULL );								/* A handle is not required, so just pass NULL. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTelnetSessionTask( void *pvParameters )
+{
+TelnetSession_t *pxSession = ( TelnetSession_t * ) pvParameters;
+size_t xHead, xTail;
+
+	for( ;; )
+	{
+		if( xSemaphoreTake( pxSession->xEventSemaphore, portMAX_DELAY ) != pdPASS )
+		{
+			continue;
+		}
+
+		if( pxSession->ulConnection != pxSession->ulConsoleConnection )
+		{
+			/* A new connection was opened.  Start from a fresh console rather
+			than with the state left by the previous user. */
+			pxSession->ulConsoleConnection = pxSession->ulConnection;
+			pxSession->eTelnetState = eTelnetData;
+			vCommandConsoleInit( &( pxSession->xConsole ), &xTelnetTransport, pxSession, pxSession->cOutputBuffer, sizeof( pxSession->cOutputBuffer ) );
+
+			( void ) prvTelnetWrite( pxSession, ( const char * ) ucNegotiation, sizeof( ucNegotiation ) );
+			vCommandConsoleStart( &( pxSession->xConsole ) );
+		}
+
+		/* Process everything received so far in place, in two parts if it
+		wraps around the end of the buffer. */
+		xHead = pxSession->xRxHead;
+		xTail = pxSession->xRxTail;
+		if( xHead < xTail )
+		{
+			prvTelnetInput( pxSession, &( pxSession->ucRxBuffer[ xTail ] ), telnetRX_BUFFER_SIZE - xTail );
+			xTail = 0;
+		}
+		if( xHead > xTail )
+		{
+			prvTelnetInput( pxSession, &( pxSession->ucRxBuffer[ xTail ] ), xHead - xTail );
+			xTail = xHead;
+		}
+
+		if( xTail != pxSession->xRxTail )
+		{
+			pxSession->xRxTail = xTail;
+
+			/* Tell the peer if the window has opened up again. */
+			vNetworkLock();
+			{
+				if( ( pxSession->eState == eTcpEstablished ) && ( pxSession->usAdvertisedWindow < ( telnetRX_BUFFER_SIZE / 2 ) ) )
+				{
+					prvSendSegment( pxSession, telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+				}
+			}
+			vNetworkUnlock();
+		}
+
+		if( ( pxSession->eState == eTcpCloseWait ) && ( pxSession->xRxHead == pxSession->xRxTail ) &&
+			( pxSession->ulConnection == pxSession->ulConsoleConnection ) )
+		{
+			prvCloseAfterPeer( pxSession );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseAfterPeer( TelnetSession_t *pxSession )
+{
+	/* The peer closed its side and everything it sent has been executed.
+	It can still read, so its output is sent, and this side is only closed
+	once the peer has acknowledged all of it. */
+	prvTelnetFlush( pxSession );
+	if( prvWaitForAcknowledgement( pxSession, telnetTX_BUFFER_SIZE ) != pdPASS )
+	{
+		return;
+	}
+
+	vNetworkLock();
+	{
+		if( pxSession->eState == eTcpCloseWait )
+		{
+			pxSession->eState = eTcpLastAck;
+			pxSession->xRto = telnetINITIAL_RTO;
+			pxSession->uxRetries = 0;
+			pxSession->xTxTime = xTaskGetTickCount();
+			prvSendSegment( pxSession, telnetTCP_FIN | telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+			pxSession->ulSndNxt++;
+		}
+	}
+	vNetworkUnlock();
+}
+/*-----------------------------------------------------------*/
+
+static void prvTelnetInput( TelnetSession_t *pxSession, const uint8_t *pucData, size_t xLength )
+{
+size_t x, xRunStart = 0;
+uint8_t ucByte;
+
+	/* Pass runs of ordinary characters to the console, and drop telnet
+	commands and option negotiation, to which the client needs no reply. */
+	for( x = 0; x < xLength; x++ )
+	{
+		ucByte = pucData[ x ];
+
+		if( ( pxSession->eTelnetState == eTelnetData ) && ( ucByte != telnetIAC ) && ( ucByte != 0x00 ) )
+		{
+			continue;
+		}
+
+		if( x > xRunStart )
+		{
+			vCommandConsoleInput( &( pxSession->xConsole ), ( const char * ) &pucData[ xRunStart ], x - xRunStart );
+		}
+		xRunStart = x + 1;
+
+		switch( pxSession->eTelnetState )
+		{
+			case eTelnetData:
+				/* Either the start of a command, or the NUL that follows a
+				carriage return. */
+				if( ucByte == telnetIAC )
+				{
+					pxSession->eTelnetState = eTelnetCommand;
+				}
+				break;
+
+			case eTelnetCommand:
+				if( ( ucByte >= telnetWILL ) && ( ucByte <= telnetDONT ) )
+				{
+					pxSession->eTelnetState = eTelnetOption;
+				}
+				else if( ucByte == telnetSB )
+				{
+					pxSession->eTelnetState = eTelnetSubnegotiation;
+				}
+				else
+				{
+					pxSession->eTelnetState = eTelnetData;
+				}
+				break;
+
+			case eTelnetOption:
+				pxSession->eTelnetState = eTelnetData;
+				break;
+
+			case eTelnetSubnegotiation:
+				if( ucByte == telnetIAC )
+				{
+					pxSession->eTelnetState = eTelnetSubnegotiationCommand;
+				}
+				break;
+
+			case eTelnetSubnegotiationCommand:
+				pxSession->eTelnetState = ( ucByte == telnetSE ) ? eTelnetData : eTelnetSubnegotiation;
+				break;
+
+			default:
+				pxSession->eTelnetState = eTelnetData;
+				break;
+		}
+	}
+
+	if( xLength > xRunStart )
+	{
+		vCommandConsoleInput( &( pxSession->xConsole ), ( const char * ) &pucData[ xRunStart ], xLength - xRunStart );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTelnetWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
+{
+TelnetSession_t *pxSession = ( TelnetSession_t * ) pvTransport;
+const uint8_t *pucData = ( const uint8_t * ) pcBuffer;
+size_t xQueued;
+
+	for( ;; )
+	{
+		if( prvQueueData( pxSession, pucData, xBufferLength, &xQueued ) != pdPASS )
+		{
+			/* The connection this console was serving has gone. */
+			return pdFAIL;
+		}
+
+		pucData += xQueued;
+		xBufferLength -= xQueued;
+		if( xBufferLength == 0 )
+		{
+			return pdPASS;
+		}
+
+		/* The buffer is full of output the peer has not acknowledged yet. */
+		if( prvWaitForAcknowledgement( pxSession, 1 ) != pdPASS )
+		{
+			return pdFAIL;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTelnetFlush( void *pvTransport )
+{
+TelnetSession_t *pxSession = ( TelnetSession_t * ) pvTransport;
+
+	vNetworkLock();
+	{
+		if( ( prvConnectionOpen( pxSession ) != pdFALSE ) && ( pxSession->ulConnection == pxSession->ulConsoleConnection ) )
+		{
+			prvOutput( pxSession, pdFALSE );
+		}
+	}
+	vNetworkUnlock();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvQueueData( TelnetSession_t *pxSession, const uint8_t *pucData, size_t xLength, size_t *pxQueued )
+{
+BaseType_t xReturn = pdFAIL;
+size_t xFree, xOffset, xChunk;
+
+	*pxQueued = 0;
+
+	vNetworkLock();
+	{
+		if( ( prvConnectionOpen( pxSession ) != pdFALSE ) && ( pxSession->ulConnection == pxSession->ulConsoleConnection ) )
+		{
+			/* Copy as much as there is room for, in two parts if it wraps
+			around the end of the buffer. */
+			xFree = telnetTX_BUFFER_SIZE - ( size_t ) ( pxSession->ulTxEnd - pxSession->ulSndUna );
+			if( xLength > xFree )
+			{
+				xLength = xFree;
+			}
+
+			while( *pxQueued < xLength )
+			{
+				xOffset = ( size_t ) ( pxSession->ulTxEnd - pxSession->ulTxStart ) & telnetTX_BUFFER_MASK;
+				xChunk = telnetTX_BUFFER_SIZE - xOffset;
+				if( xChunk > ( xLength - *pxQueued ) )
+				{
+					xChunk = xLength - *pxQueued;
+				}
+
+				memcpy( &( pxSession->ucTxBuffer[ xOffset ] ), &pucData[ *pxQueued ], xChunk );
+				pxSession->ulTxEnd += xChunk;
+				*pxQueued += xChunk;
+			}
+
+			/* Short output waits for the flush, so it can share a segment with
+			what follows it. */
+			if( ( pxSession->ulTxEnd - pxSession->ulSndNxt ) >= pxSession->usPeerMSS )
+			{
+				prvOutput( pxSession, pdFALSE );
+			}
+
+			xReturn = pdPASS;
+		}
+	}
+	vNetworkUnlock();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitForAcknowledgement( TelnetSession_t *pxSession, size_t xSpace )
+{
+BaseType_t xOpen;
+size_t xFree;
+
+	/* Acknowledgements give the semaphore, and the retransmission limit
+	guarantees either they arrive or the connection closes. */
+	for( ;; )
+	{
+		vNetworkLock();
+		{
+			/* Taken before the check, so an acknowledgement that arrives after
+			the check wakes the task. */
+			xSemaphoreTake( pxSession->xTxSemaphore, 0 );
+			xOpen = ( ( prvConnectionOpen( pxSession ) != pdFALSE ) && ( pxSession->ulConnection == pxSession->ulConsoleConnection ) ) ? pdTRUE : pdFALSE;
+			xFree = telnetTX_BUFFER_SIZE - ( size_t ) ( pxSession->ulTxEnd - pxSession->ulSndUna );
+		}
+		vNetworkUnlock();
+
+		if( xOpen == pdFALSE )
+		{
+			return pdFAIL;
+		}
+
+		if( xFree >= xSpace )
+		{
+			return pdPASS;
+		}
+
+		xSemaphoreTake( pxSession->xTxSemaphore, portMAX_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvConnectionOpen( const TelnetSession_t *pxSession )
+{
+	return ( ( pxSession->eState == eTcpEstablished ) || ( pxSession->eState == eTcpCloseWait ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReceiveWindow( const TelnetSession_t *pxSession )
+{
+	/* One byte is always left unused so a full buffer can be told apart from
+	an empty one. */
+	return ( pxSession->xRxTail + telnetRX_BUFFER_SIZE - pxSession->xRxHead - 1 ) % telnetRX_BUFFER_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendSegment( TelnetSession_t *pxSession, uint8_t ucFlags, uint32_t ulSeq, const uint8_t *pucPayload, size_t xLength )
+{
+uint8_t ucHeader[ telnetTCP_HEADER_SIZE + telnetTCP_MSS_OPTION_SIZE ];
+size_t xHeaderLength = telnetTCP_HEADER_SIZE;
+
+	pxSession->usAdvertisedWindow = ( uint16_t ) prvReceiveWindow( pxSession );
+
+	vNetworkWrite16( &ucHeader[ 0 ], telnetPORT );
+	vNetworkWrite16( &ucHeader[ 2 ], pxSession->usRemotePort );
+	vNetworkWrite32( &ucHeader[ 4 ], ulSeq );
+	vNetworkWrite32( &ucHeader[ 8 ], pxSession->ulRcvNxt );
+
+	if( ( ucFlags & telnetTCP_SYN ) != 0 )
+	{
+		ucHeader[ 20 ] = 2;
+		ucHeader[ 21 ] = telnetTCP_MSS_OPTION_SIZE;
+		vNetworkWrite16( &ucHeader[ 22 ], telnetMSS );
+		xHeaderLength += telnetTCP_MSS_OPTION_SIZE;
+	}
+
+	ucHeader[ 12 ] = ( uint8_t ) ( ( xHeaderLength / 4 ) << 4 );
+	ucHeader[ 13 ] = ucFlags;
+	vNetworkWrite16( &ucHeader[ 14 ], pxSession->usAdvertisedWindow );
+	vNetworkWrite16( &ucHeader[ 16 ], 0 );		/* Checksum, filled in by the MAC. */
+	vNetworkWrite16( &ucHeader[ 18 ], 0 );
+
+	( void ) xNetworkSendIPv4( pxSession->ucRemoteMAC, pxSession->ulRemoteIP, networkPROTOCOL_TCP, ucHeader, xHeaderLength, pucPayload, xLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendReset( const uint8_t *pucMAC, uint32_t ulIP, const uint8_t *pucSegment, size_t xDataLength )
+{
+uint8_t ucHeader[ telnetTCP_HEADER_SIZE ];
+uint8_t ucFlags = pucSegment[ 13 ];
+uint32_t ulAck;
+
+	memset( ucHeader, 0x00, sizeof( ucHeader ) );
+	memcpy( &ucHeader[ 0 ], &pucSegment[ 2 ], 2 );
+	memcpy( &ucHeader[ 2 ], &pucSegment[ 0 ], 2 );
+	ucHeader[ 12 ] = ( telnetTCP_HEADER_SIZE / 4 ) << 4;
+
+	if( ( ucFlags & telnetTCP_ACK ) != 0 )
+	{
+		/* The reset takes the sequence number the peer expects. */
+		memcpy( &ucHeader[ 4 ], &pucSegment[ 8 ], 4 );
+		ucHeader[ 13 ] = telnetTCP_RST;
+	}
+	else
+	{
+		ulAck = ulNetworkRead32( &pucSegment[ 4 ] ) + xDataLength;
+		if( ( ucFlags & telnetTCP_SYN ) != 0 )
+		{
+			ulAck++;
+		}
+		if( ( ucFlags & telnetTCP_FIN ) != 0 )
+		{
+			ulAck++;
+		}
+		vNetworkWrite32( &ucHeader[ 8 ], ulAck );
+		ucHeader[ 13 ] = telnetTCP_RST | telnetTCP_ACK;
+	}
+
+	( void ) xNetworkSendIPv4( pucMAC, ulIP, networkPROTOCOL_TCP, ucHeader, sizeof( ucHeader ), NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutput( TelnetSession_t *pxSession, BaseType_t xProbe )
+{
+uint32_t ulOffset, ulInFlight, ulAllowed, ulSegment;
+
+	while( telnetSEQ_LT( pxSession->ulSndNxt, pxSession->ulTxEnd ) )
+	{
+		/* Send as much as the window of the peer allows.  When the window is
+		closed the retransmission timer probes it with a single byte. */
+		ulInFlight = pxSession->ulSndNxt - pxSession->ulSndUna;
+		ulAllowed = ( pxSession->ulSndWnd > ulInFlight ) ? ( pxSession->ulSndWnd - ulInFlight ) : 0;
+		if( ( ulAllowed == 0 ) && ( xProbe != pdFALSE ) && ( ulInFlight == 0 ) )
+		{
+			ulAllowed = 1;
+		}
+		if( ulAllowed == 0 )
+		{
+			break;
+		}
+
+		ulSegment = pxSession->ulTxEnd - pxSession->ulSndNxt;
+		if( ulSegment > pxSession->usPeerMSS )
+		{
+			ulSegment = pxSession->usPeerMSS;
+		}
+		if( ulSegment > ulAllowed )
+		{
+			ulSegment = ulAllowed;
+		}
+
+		/* A segment ends where the buffer wraps, the rest goes in the
+		next. */
+		ulOffset = ( pxSession->ulSndNxt - pxSession->ulTxStart ) & telnetTX_BUFFER_MASK;
+		if( ulSegment > ( telnetTX_BUFFER_SIZE - ulOffset ) )
+		{
+			ulSegment = telnetTX_BUFFER_SIZE - ulOffset;
+		}
+
+		/* The retransmission timer runs from the first segment sent after
+		everything was acknowledged.  It restarts itself when it fires. */
+		if( ( ulInFlight == 0 ) && ( xProbe == pdFALSE ) )
+		{
+			pxSession->xTxTime = xTaskGetTickCount();
+		}
+
+		prvSendSegment( pxSession, telnetTCP_ACK | telnetTCP_PSH, pxSession->ulSndNxt, &( pxSession->ucTxBuffer[ ulOffset ] ), ulSegment );
+		pxSession->ulSndNxt += ulSegment;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseSession( TelnetSession_t *pxSession )
+{
+	pxSession->eState = eTcpClosed;
+
+	/* Release the session task if it is waiting for output to be
+	acknowledged. */
+	xSemaphoreGive( pxSession->xTxSemaphore );
+	xSemaphoreGive( pxSession->xEventSemaphore );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvInitialSequenceNumber( void )
+{
+uint32_t ulStatus;
+UBaseType_t x;
+
+	/* A new number is ready 40 RNG clock periods after the last was read, so
+	one is normally waiting. */
+	for( x = 0; x < telnetRNG_ATTEMPTS; x++ )
+	{
+		ulStatus = RNG->SR;
+		if( ( ulStatus & ( RNG_SR_SECS | RNG_SR_CECS ) ) != 0 )
+		{
+			break;
+		}
+		if( ( ulStatus & RNG_SR_DRDY ) != 0 )
+		{
+			ulNextISN = RNG->DR;
+			return ulNextISN;
+		}
+	}
+
+	/* The RNG has not produced a number.  After a seed error it has to be
+	restarted, and until it recovers the number is mixed from the cycle counter,
+	which is harder to predict than the tick count. */
+	vTraceLog( "RNG error 0x%x, initial sequence number not random", RNG->SR, 0, 0, 0 );
+	RNG->SR &= ~( RNG_SR_SEIS | RNG_SR_CEIS );
+	RNG->CR &= ~RNG_CR_RNGEN;
+	RNG->CR |= RNG_CR_RNGEN;
+
+	ulNextISN += ( DWT->CYCCNT * 251 ) + 64000;
+	return ulNextISN;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAcceptConnection( TelnetSession_t *pxSession, const uint8_t *pucMAC, uint32_t ulIP, const uint8_t *pucSegment, size_t xHeaderLength )
+{
+size_t x;
+
+	memcpy( pxSession->ucRemoteMAC, pucMAC, 6 );
+	pxSession->ulRemoteIP = ulIP;
+	pxSession->usRemotePort = usNetworkRead16( &pucSegment[ 0 ] );
+	pxSession->ulRcvNxt = ulNetworkRead32( &pucSegment[ 4 ] ) + 1;
+	pxSession->ulSndWnd = usNetworkRead16( &pucSegment[ 14 ] );
+
+	/* Look for the MSS option. */
+	pxSession->usPeerMSS = telnetDEFAULT_PEER_MSS;
+	for( x = telnetTCP_HEADER_SIZE; x < xHeaderLength; )
+	{
+		if( pucSegment[ x ] == 0 )
+		{
+			break;
+		}
+		else if( pucSegment[ x ] == 1 )
+		{
+			x++;
+		}
+		else if( ( x + 1 ) >= xHeaderLength || pucSegment[ x + 1 ] < 2 )
+		{
+			break;
+		}
+		else
+		{
+			if( ( pucSegment[ x ] == 2 ) && ( pucSegment[ x + 1 ] == 4 ) && ( ( x + 4 ) <= xHeaderLength ) )
+			{
+				pxSession->usPeerMSS = usNetworkRead16( &pucSegment[ x + 2 ] );
+			}
+			x += pucSegment[ x + 1 ];
+		}
+	}
+	if( pxSession->usPeerMSS > telnetMSS )
+	{
+		pxSession->usPeerMSS = telnetMSS;
+	}
+
+	pxSession->ulSndUna = prvInitialSequenceNumber();
+	pxSession->ulSndNxt = pxSession->ulSndUna + 1;
+	pxSession->ulTxStart = pxSession->ulSndNxt;
+	pxSession->ulTxEnd = pxSession->ulSndNxt;
+
+	/* Empty the receive buffer.  The tail belongs to the session task. */
+	pxSession->xRxHead = pxSession->xRxTail;
+
+	pxSession->eState = eTcpSynReceived;
+	pxSession->xRto = telnetINITIAL_RTO;
+	pxSession->uxRetries = 0;
+	pxSession->xTxTime = xTaskGetTickCount();
+	prvSendSegment( pxSession, telnetTCP_SYN | telnetTCP_ACK, pxSession->ulSndUna, NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceiveData( TelnetSession_t *pxSession, const uint8_t *pucData, size_t xLength, BaseType_t xFin, uint32_t ulSeq )
+{
+size_t xAccepted = 0, xChunk, xWanted;
+
+	if( ulSeq != pxSession->ulRcvNxt )
+	{
+		/* Out of order or already received.  Tell the peer what is
+		expected. */
+		prvSendSegment( pxSession, telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+		return;
+	}
+
+	/* Take what fits, the peer sends the rest again once the window opens. */
+	xWanted = ( xLength > prvReceiveWindow( pxSession ) ) ? prvReceiveWindow( pxSession ) : xLength;
+	while( xAccepted < xWanted )
+	{
+		xChunk = telnetRX_BUFFER_SIZE - pxSession->xRxHead;
+		if( xChunk > ( xWanted - xAccepted ) )
+		{
+			xChunk = xWanted - xAccepted;
+		}
+
+		memcpy( &( pxSession->ucRxBuffer[ pxSession->xRxHead ] ), &pucData[ xAccepted ], xChunk );
+		pxSession->xRxHead = ( pxSession->xRxHead + xChunk ) % telnetRX_BUFFER_SIZE;
+		xAccepted += xChunk;
+	}
+	pxSession->ulRcvNxt += xAccepted;
+
+	if( xAccepted > 0 )
+	{
+		xSemaphoreGive( pxSession->xEventSemaphore );
+	}
+
+	if( ( xFin != pdFALSE ) && ( xAccepted == xLength ) && ( pxSession->eState == eTcpEstablished ) )
+	{
+		/* The peer closed its side, but still reads, as nc -N does after
+		sending a command.  The session task closes this side once the
+		commands received have been executed and their output sent. */
+		pxSession->ulRcvNxt++;
+		pxSession->eState = eTcpCloseWait;
+		xSemaphoreGive( pxSession->xEventSemaphore );
+	}
+
+	prvSendSegment( pxSession, telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+void vTelnetTCPInput( const uint8_t *pucSourceMAC, uint32_t ulSourceIP, const uint8_t *pucSegment, size_t xLength )
+{
+TelnetSession_t *pxSession = NULL, *pxFree = NULL;
+size_t xHeaderLength, xDataLength;
+uint8_t ucFlags;
+uint16_t usSourcePort;
+uint32_t ulSeq, ulAck;
+UBaseType_t x;
+
+	if( xLength < telnetTCP_HEADER_SIZE )
+	{
+		return;
+	}
+
+	xHeaderLength = ( size_t ) ( pucSegment[ 12 ] >> 4 ) * 4;
+	if( ( xHeaderLength < telnetTCP_HEADER_SIZE ) || ( xHeaderLength > xLength ) )
+	{
+		return;
+	}
+
+	xDataLength = xLength - xHeaderLength;
+	ucFlags = pucSegment[ 13 ];
+	usSourcePort = usNetworkRead16( &pucSegment[ 0 ] );
+	ulSeq = ulNetworkRead32( &pucSegment[ 4 ] );
+	ulAck = ulNetworkRead32( &pucSegment[ 8 ] );
+
+	if( usNetworkRead16( &pucSegment[ 2 ] ) == telnetPORT )
+	{
+		for( x = 0; x < telnetMAX_SESSIONS; x++ )
+		{
+			if( xSessions[ x ].eState == eTcpClosed )
+			{
+				if( pxFree == NULL )
+				{
+					pxFree = &xSessions[ x ];
+				}
+			}
+			else if( ( xSessions[ x ].ulRemoteIP == ulSourceIP ) && ( xSessions[ x ].usRemotePort == usSourcePort ) )
+			{
+				pxSession = &xSessions[ x ];
+				break;
+			}
+		}
+	}
+
+	if( pxSession == NULL )
+	{
+		if( ( ucFlags & telnetTCP_RST ) != 0 )
+		{
+			return;
+		}
+
+		if( ( ( ucFlags & ( telnetTCP_SYN | telnetTCP_ACK ) ) == telnetTCP_SYN ) && ( pxFree != NULL ) )
+		{
+			prvAcceptConnection( pxFree, pucSourceMAC, ulSourceIP, pucSegment, xHeaderLength );
+		}
+		else
+		{
+			/* Refuse connections to other ports, connections beyond
+			telnetMAX_SESSIONS, and segments for connections that no longer
+			exist. */
+			prvSendReset( pucSourceMAC, ulSourceIP, pucSegment, xDataLength );
+		}
+		return;
+	}
+
+	if( ( ucFlags & telnetTCP_RST ) != 0 )
+	{
+		/* Only accept a reset that is within the window. */
+		if( telnetSEQ_LEQ( pxSession->ulRcvNxt, ulSeq ) && telnetSEQ_LT( ulSeq, pxSession->ulRcvNxt + telnetRX_BUFFER_SIZE ) )
+		{
+			prvCloseSession( pxSession );
+		}
+		return;
+	}
+
+	if( ( ucFlags & telnetTCP_SYN ) != 0 )
+	{
+		/* Either the SYN was sent again because the SYN-ACK was lost, or it is
+		a duplicate.  Both are answered with what is expected next. */
+		if( pxSession->eState == eTcpSynReceived )
+		{
+			prvSendSegment( pxSession, telnetTCP_SYN | telnetTCP_ACK, pxSession->ulSndUna, NULL, 0 );
+		}
+		else
+		{
+			prvSendSegment( pxSession, telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+		}
+		return;
+	}
+
+	if( ( ucFlags & telnetTCP_ACK ) == 0 )
+	{
+		return;
+	}
+
+	if( pxSession->eState == eTcpSynReceived )
+	{
+		if( ulAck != pxSession->ulSndNxt )
+		{
+			prvSendReset( pucSourceMAC, ulSourceIP, pucSegment, xDataLength );
+			return;
+		}
+
+		/* The connection is open, let the session task start the console. */
+		pxSession->ulSndUna = ulAck;
+		pxSession->eState = eTcpEstablished;
+		pxSession->ulConnection++;
+		xSemaphoreGive( pxSession->xEventSemaphore );
+	}
+	else if( telnetSEQ_LT( pxSession->ulSndUna, ulAck ) && telnetSEQ_LEQ( ulAck, pxSession->ulSndNxt ) )
+	{
+		/* New data was acknowledged, which makes room in the buffer. */
+		pxSession->ulSndUna = ulAck;
+		pxSession->uxRetries = 0;
+		pxSession->xRto = telnetINITIAL_RTO;
+		pxSession->xTxTime = xTaskGetTickCount();
+		xSemaphoreGive( pxSession->xTxSemaphore );
+	}
+
+	pxSession->ulSndWnd = usNetworkRead16( &pucSegment[ 14 ] );
+
+	if( pxSession->eState == eTcpLastAck )
+	{
+		if( pxSession->ulSndUna == pxSession->ulSndNxt )
+		{
+			/* Our FIN was acknowledged. */
+			prvCloseSession( pxSession );
+		}
+		return;
+	}
+
+	/* The window might have moved.  Output still waiting for the flush is
+	sent as well, as the segment it would have shared is not coming soon. */
+	prvOutput( pxSession, pdFALSE );
+
+	if( ( xDataLength > 0 ) || ( ( ucFlags & telnetTCP_FIN ) != 0 ) )
+	{
+		prvReceiveData( pxSession, &pucSegment[ xHeaderLength ], xDataLength, ( ( ucFlags & telnetTCP_FIN ) != 0 ) ? pdTRUE : pdFALSE, ulSeq );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vTelnetTimer( void )
+{
+TelnetSession_t *pxSession;
+TickType_t xNow = xTaskGetTickCount();
+UBaseType_t x;
+
+	for( x = 0; x < telnetMAX_SESSIONS; x++ )
+	{
+		pxSession = &xSessions[ x ];
+
+		/* Only connections with something unacknowledged, or output held
+		back by a closed window, are timed. */
+		if( ( pxSession->eState == eTcpClosed ) ||
+			( ( prvConnectionOpen( pxSession ) != pdFALSE ) && ( pxSession->ulSndUna == pxSession->ulSndNxt ) &&
+			  ( ( pxSession->ulSndWnd > 0 ) || ( pxSession->ulSndNxt == pxSession->ulTxEnd ) ) ) ||
+			( ( xNow - pxSession->xTxTime ) < pxSession->xRto ) )
+		{
+			continue;
+		}
+
+		if( ++( pxSession->uxRetries ) > telnetMAX_RETRIES )
+		{
+			/* The peer has gone. */
+			prvSendSegment( pxSession, telnetTCP_RST | telnetTCP_ACK, pxSession->ulSndNxt, NULL, 0 );
+			prvCloseSession( pxSession );
+			continue;
+		}
+
+		pxSession->xTxTime = xNow;
+		pxSession->xRto = ( ( pxSession->xRto * 2 ) > telnetMAX_RTO ) ? telnetMAX_RTO : ( pxSession->xRto * 2 );
+
+		switch( pxSession->eState )
+		{
+			case eTcpSynReceived:
+				prvSendSegment( pxSession, telnetTCP_SYN | telnetTCP_ACK, pxSession->ulSndUna, NULL, 0 );
+				break;
+
+			case eTcpLastAck:
+				prvSendSegment( pxSession, telnetTCP_FIN | telnetTCP_ACK, pxSession->ulSndNxt - 1, NULL, 0 );
+				break;
+
+			default:
+				/* Go back to the oldest unacknowledged byte.  The data is
+				still in the buffer. */
+				pxSession->ulSndNxt = pxSession->ulSndUna;
+				prvOutput( pxSession, pdTRUE );
+				break;
+		}
+	}
+}
@@ -0,0 +1,141 @@
+/*
+ * TraceLog.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "TraceLog.h"
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+#include "stm32f7xx_hal.h"
+#include "MemoryLayout.h"
+
+#if( ( tracelogRECORDS & ( tracelogRECORDS - 1 ) ) != 0 )
+	#error tracelogRECORDS must be a power of two
+#endif
+
+#define tracelogINDEX_MASK			( tracelogRECORDS - 1 )
+
+/* The records are written by whatever is running, so they are kept in the
+zero wait state DTCM. */
+static TraceRecord_t xRecords[ tracelogRECORDS ] memoryDTCM_BSS;
+
+/* The index of the next record to write.  Writers claim a record by
+incrementing it with an exclusive access, so no lock is needed and a writer
+that is interrupted by another just ends up with the earlier record. */
+static volatile uint32_t ulHead memoryDTCM_BSS;
+
+/* The index of the next record to read.  Only used by tasks. */
+static uint32_t ulTail memoryDTCM_BSS;
+
+/*-----------------------------------------------------------*/
+
+/* Called from interrupts, so executed from the ITCM. */
+memoryITCM_CODE void vTraceLog( const char *pcFormat, uint32_t ulArgument1, uint32_t ulArgument2, uint32_t ulArgument3, uint32_t ulArgument4 )
+{
+uint32_t ulIndex;
+TraceRecord_t *pxRecord;
+
+	do
+	{
+		ulIndex = __LDREXW( &ulHead );
+	} while( __STREXW( ulIndex + 1, &ulHead ) != 0 );
+
+	pxRecord = &xRecords[ ulIndex & tracelogINDEX_MASK ];
+
+	/* Mark the record as being written before changing it, so a reader that
+	copies it at the same time can tell. */
+	pxRecord->ulSequence = 0;
+	__DMB();
+
+	pxRecord->ulTimestamp = DWT->CYCCNT;
+	pxRecord->pcFormat = pcFormat;
+	pxRecord->ulContext = __get_IPSR();
+	pxRecord->ulArguments[ 0 ] = ulArgument1;
+	pxRecord->ulArguments[ 1 ] = ulArgument2;
+	pxRecord->ulArguments[ 2 ] = ulArgument3;
+	pxRecord->ulArguments[ 3 ] = ulArgument4;
+
+	__DMB();
+	pxRecord->ulSequence = ulIndex + 1;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTraceLogRead( TraceRecord_t *pxRecord, uint32_t *pulLost )
+{
+const TraceRecord_t *pxSource;
+uint32_t ulSequence, ulHeadNow;
+BaseType_t xReturn = pdFALSE;
+
+	*pulLost = 0;
+
+	/* Consoles can read the log at the same time, so the tail is only
+	advanced with the scheduler suspended.  Writers are never held up. */
+	vTaskSuspendAll();
+	{
+		for( ;; )
+		{
+			ulHeadNow = ulHead;
+			if( ulTail == ulHeadNow )
+			{
+				break;
+			}
+
+			/* Skip the records that have been overwritten since they were
+			written. */
+			if( ( ulHeadNow - ulTail ) > tracelogRECORDS )
+			{
+				*pulLost += ( ulHeadNow - tracelogRECORDS ) - ulTail;
+				ulTail = ulHeadNow - tracelogRECORDS;
+			}
+
+			pxSource = &xRecords[ ulTail & tracelogINDEX_MASK ];
+			ulSequence = pxSource->ulSequence;
+
+			if( ulSequence == ( ulTail + 1 ) )
+			{
+				*pxRecord = *pxSource;
+				__DMB();
+
+				if( pxSource->ulSequence == ulSequence )
+				{
+					ulTail++;
+					xReturn = pdTRUE;
+					break;
+				}
+
+				/* The record was overwritten while it was copied. */
+				( *pulLost )++;
+				ulTail++;
+			}
+			else if( ( ulSequence == 0 ) || ( ( int32_t ) ( ulSequence - ( ulTail + 1 ) ) < 0 ) )
+			{
+				/* The record is still being written, by a writer that was
+				interrupted.  Try again next time. */
+				break;
+			}
+			else
+			{
+				/* Already overwritten by a later record. */
+				( *pulLost )++;
+				ulTail++;
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceLogClear( void )
+{
+	vTaskSuspendAll();
+	{
+		ulTail = ulHead;
+	}
+	( void ) xTaskResumeAll();
+}
@@ -0,0 +1,973 @@
+/*
+ * USBCommandConsole.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "USBCommandConsole.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+#include "CommandConsole.h"
+
+#include "stm32f7xx_hal.h"
+
+/* The console enumerates as a CDC-ACM virtual COM port using the identifiers
+of the ST virtual COM port, so no host driver has to be installed. */
+#define usbVENDOR_ID				0x0483
+#define usbPRODUCT_ID				0x5740
+
+/* Full speed bulk and control endpoints use 64 byte packets. */
+#define usbMAX_PACKET_SIZE			64
+#define usbNOTIFY_PACKET_SIZE		8
+
+/* Endpoint addresses.  The notification endpoint is required by the CDC-ACM
+descriptors but never used. */
+#define usbEP_CONTROL_OUT			0x00
+#define usbEP_CONTROL_IN			0x80
+#define usbEP_DATA_OUT				0x01
+#define usbEP_DATA_IN				0x81
+#define usbEP_NOTIFY_IN				0x82
+
+/* FIFO sizes in 32-bit words.  The USB_OTG_FS core has 320 words of FIFO RAM
+in total.  The bulk IN FIFO holds two packets so the core can send one while
+the next is written. */
+#define usbRX_FIFO_SIZE				0x80
+#define usbTX0_FIFO_SIZE			0x20
+#define usbTX1_FIFO_SIZE			0x80
+#define usbTX2_FIFO_SIZE			0x10
+
+/* The maximum time in ticks to wait for the host to read a transfer before the
+transfer is aborted and the output dropped, for example because the terminal
+was closed without dropping DTR. */
+#define usbMAX_TX_WAIT				( 100 / portTICK_PERIOD_MS )
+
+/* Fields of the setup packet. */
+#define usbREQUEST_TYPE_MASK		0x60
+#define usbREQUEST_TYPE_STANDARD	0x00
+#define usbREQUEST_TYPE_CLASS		0x20
+#define usbREQUEST_RECIPIENT_MASK	0x1F
+#define usbREQUEST_RECIPIENT_EP		0x02
+
+/* Standard requests. */
+#define usbREQ_GET_STATUS			0x00
+#define usbREQ_CLEAR_FEATURE		0x01
+#define usbREQ_SET_FEATURE			0x03
+#define usbREQ_SET_ADDRESS			0x05
+#define usbREQ_GET_DESCRIPTOR		0x06
+#define usbREQ_GET_CONFIGURATION	0x08
+#define usbREQ_SET_CONFIGURATION	0x09
+#define usbREQ_GET_INTERFACE		0x0A
+#define usbREQ_SET_INTERFACE		0x0B
+
+/* CDC-ACM class requests. */
+#define usbREQ_SET_LINE_CODING		0x20
+#define usbREQ_GET_LINE_CODING		0x21
+#define usbREQ_SET_CONTROL_LINE_STATE	0x22
+#define usbREQ_SEND_BREAK			0x23
+
+/* Descriptor types. */
+#define usbDESC_DEVICE				0x01
+#define usbDESC_CONFIGURATION		0x02
+#define usbDESC_STRING				0x03
+
+#define usbFEATURE_ENDPOINT_HALT	0x00
+#define usbCONTROL_LINE_DTR			0x01
+
+#define usbLOBYTE( x )				( ( uint8_t ) ( ( x ) & 0xFF ) )
+#define usbHIBYTE( x )				( ( uint8_t ) ( ( ( x ) >> 8 ) & 0xFF ) )
+
+/* The stage of the control transfer in progress on endpoint 0. */
+typedef enum
+{
+	eControlIdle = 0,
+	eControlDataIn,
+	eControlDataOut,
+	eControlStatusIn,
+	eControlStatusOut
+} ControlState_t;
+
+/* The decoded setup packet of a control transfer. */
+typedef struct xSETUP_PACKET
+{
+	uint8_t ucRequestType;
+	uint8_t ucRequest;
+	uint16_t usValue;
+	uint16_t usIndex;
+	uint16_t usLength;
+} SetupPacket_t;
+
+static const uint8_t ucDeviceDescriptor[] =
+{
+	18,							/* bLength */
+	usbDESC_DEVICE,				/* bDescriptorType */
+	0x00, 0x02,					/* bcdUSB 2.00 */
+	0x02,						/* bDeviceClass: CDC */
+	0x00,						/* bDeviceSubClass */
+	0x00,						/* bDeviceProtocol */
+	usbMAX_PACKET_SIZE,			/* bMaxPacketSize0 */
+	usbLOBYTE( usbVENDOR_ID ), usbHIBYTE( usbVENDOR_ID ),
+	usbLOBYTE( usbPRODUCT_ID ), usbHIBYTE( usbPRODUCT_ID ),
+	0x00, 0x02,					/* bcdDevice 2.00 */
+	1,							/* iManufacturer */
+	2,							/* iProduct */
+	3,							/* iSerialNumber */
+	1							/* bNumConfigurations */
+};
+
+static const uint8_t ucConfigurationDescriptor[] =
+{
+	/* Configuration. */
+	9, usbDESC_CONFIGURATION,
+	67, 0,						/* wTotalLength */
+	2,							/* bNumInterfaces */
+	1,							/* bConfigurationValue */
+	0,							/* iConfiguration */
+	0x80,						/* bmAttributes: bus powered */
+	50,							/* bMaxPower: 100mA */
+
+	/* Communication class interface. */
+	9, 0x04, 0, 0, 1, 0x02, 0x02, 0x01, 0,
+
+	/* Header, call management, ACM (line coding and control line state
+	requests) and union functional descriptors. */
+	5, 0x24, 0x00, 0x10, 0x01,
+	5, 0x24, 0x01, 0x00, 1,
+	4, 0x24, 0x02, 0x02,
+	5, 0x24, 0x06, 0, 1,
+
+	/* Notification endpoint. */
+	7, 0x05, usbEP_NOTIFY_IN, 0x03, usbNOTIFY_PACKET_SIZE, 0, 0x10,
+
+	/* Data class interface. */
+	9, 0x04, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+
+	/* Bulk data endpoints. */
+	7, 0x05, usbEP_DATA_OUT, 0x02, usbMAX_PACKET_SIZE, 0, 0,
+	7, 0x05, usbEP_DATA_IN, 0x02, usbMAX_PACKET_SIZE, 0, 0
+};
+
+static const uint8_t ucLanguageDescriptor[] = { 4, usbDESC_STRING, 0x09, 0x04 };
+static const char * const pcManufacturerString = "STMicroelectronics";
+static const char * const pcProductString = "FreeRTOS command console";
+
+extern PCD_HandleTypeDef hpcd_USB_OTG_FS;
+
+/* The console served over USB, and its own output buffer so it can execute
+commands at the same time as the UART console. */
+static CommandConsole_t xUSBConsole;
+static char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+
+/* Endpoint 0 state.  Only accessed from the USB interrupt. */
+static ControlState_t eControlState = eControlIdle;
+static const uint8_t *pucControlData = NULL;
+static size_t xControlRemaining = 0;
+static BaseType_t xControlZeroLengthPacket = pdFALSE;
+static uint8_t ucControlRequest = 0;
+static uint8_t ucControlBuffer[ usbMAX_PACKET_SIZE ] __ALIGNED( 4 );
+
+/* The value set by the last SET_CONFIGURATION request, 0 when the device is
+not configured, and the value of the last SET_LINE_CODING request, which is
+only stored to be returned to the host. */
+static volatile uint8_t ucConfiguration = 0;
+static uint8_t ucLineCoding[ 7 ] = { 0x00, 0xC2, 0x01, 0x00, 0, 0, 8 };
+
+/* Set while the device is configured and a terminal holds DTR, which is the
+only time output is sent.  xWelcomePending asks the task to send the welcome
+message once a terminal has opened the port. */
+static volatile BaseType_t xHostReady = pdFALSE;
+static volatile BaseType_t xWelcomePending = pdFALSE;
+
+/* The packet last received on the bulk OUT endpoint.  The endpoint is only
+re-armed once the task has processed the packet, until then the host is NAKed,
+which paces the input without losing any of it. */
+static uint8_t ucRxPacket[ usbMAX_PACKET_SIZE ] __ALIGNED( 4 );
+static volatile size_t xRxLength = 0;
+static volatile BaseType_t xRxPending = pdFALSE;
+
+/* Output shorter than a packet, such as echoes and prompts, is gathered in
+ucTxStaging so it goes out as one packet when the console flushes.  Longer
+output is handed to the endpoint straight from the buffer of the caller. */
+static uint8_t ucTxStaging[ usbMAX_PACKET_SIZE ] __ALIGNED( 4 );
+static size_t xTxStaged = 0;
+
+/* Set while a bulk IN transfer is in progress.  A transfer that ends with a
+full packet is followed by a zero length packet so the host knows it has
+ended. */
+static volatile BaseType_t xTxBusy = pdFALSE;
+static volatile BaseType_t xTxZeroLengthPacket = pdFALSE;
+
+/* Given by the USB interrupt each time a bulk IN transfer completes or is
+cancelled. */
+static SemaphoreHandle_t xTxCompleteSemaphore = NULL;
+
+/* Given by the USB interrupt when a packet is received or a terminal opens the
+port. */
+static SemaphoreHandle_t xEventSemaphore = NULL;
+
+static void prvUSBCommandConsoleTask( void *pvParameters );
+
+/*
+ * Console transport functions.
+ */
+static BaseType_t prvUSBWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+static void prvUSBFlush( void *pvTransport );
+static BaseType_t prvUSBWriteReference( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+
+/*
+ * Bulk IN transfer management, called from the task.
+ */
+static BaseType_t prvStartTransmission( const uint8_t *pucBuffer, size_t xLength );
+static BaseType_t prvWaitForTransmission( void );
+static BaseType_t prvSendStaged( void );
+
+/*
+ * Abort the bulk IN transfer in progress, if any.  Called from the USB
+ * interrupt or with it masked.
+ */
+static void prvCancelTransmission( void );
+
+/*
+ * Give xSemaphore from the USB interrupt.
+ */
+static void prvGiveFromISR( SemaphoreHandle_t xSemaphore );
+
+/*
+ * Control transfer handling, called from the USB interrupt.
+ */
+static BaseType_t prvStandardRequest( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup );
+static BaseType_t prvClassRequest( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup );
+static BaseType_t prvGetDescriptor( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup );
+static size_t prvStringDescriptor( const char *pcString );
+static void prvSetConfiguration( PCD_HandleTypeDef *hpcd, uint8_t ucValue );
+static void prvSetHostReady( BaseType_t xReady );
+static void prvControlSendData( PCD_HandleTypeDef *hpcd, const uint8_t *pucData, size_t xLength, uint16_t usRequested );
+static void prvControlSendStatus( PCD_HandleTypeDef *hpcd );
+static void prvControlStall( PCD_HandleTypeDef *hpcd );
+
+static const CommandConsoleTransport_t xUSBTransport =
+{
+	prvUSBWrite,
+	prvUSBFlush,
+	prvUSBWriteReference
+};
+
+/*-----------------------------------------------------------*/
+
+void USBCommandConsoleStart( uint16_t usStackSize, unsigned portBASE_TYPE uxPriority )
+{
+	/* Create that task that handles the console itself. */
+	xTaskCreate( 	prvUSBCommandConsoleTask,			/* The task that implements the command console. */
+					"USB CLI",							/* Text name assigned to the task.  This is just to assist debugging.  The kernel does not use this name itself. */
+					usStackSize,						/* The size of the stack allocated to the task. */
+					NULL,								/* The parameter is not used, so NULL is passed. */
+					uxPriority,							/* The priority allocated to the task. */
+					NULL );								/* A handle is not required, so just pass NULL. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvUSBCommandConsoleTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	/* Both semaphores are given from the USB interrupt, so they must exist
+	before the device is started. */
+	vSemaphoreCreateBinary( xTxCompleteSemaphore );
+	configASSERT( xTxCompleteSemaphore );
+	vSemaphoreCreateBinary( xEventSemaphore );
+	configASSERT( xEventSemaphore );
+	xSemaphoreTake( xTxCompleteSemaphore, 0 );
+	xSemaphoreTake( xEventSemaphore, 0 );
+
+	vCommandConsoleInit( &xUSBConsole, &xUSBTransport, NULL, cOutputBuffer, sizeof( cOutputBuffer ) );
+	vCommandConsoleEnableFrames( &xUSBConsole );
+
+	/* Partition the FIFO RAM then connect to the bus. */
+	HAL_PCDEx_SetRxFiFo( &hpcd_USB_OTG_FS, usbRX_FIFO_SIZE );
+	HAL_PCDEx_SetTxFiFo( &hpcd_USB_OTG_FS, 0, usbTX0_FIFO_SIZE );
+	HAL_PCDEx_SetTxFiFo( &hpcd_USB_OTG_FS, 1, usbTX1_FIFO_SIZE );
+	HAL_PCDEx_SetTxFiFo( &hpcd_USB_OTG_FS, 2, usbTX2_FIFO_SIZE );
+	HAL_PCD_Start( &hpcd_USB_OTG_FS );
+
+	for( ;; )
+	{
+		if( xSemaphoreTake( xEventSemaphore, portMAX_DELAY ) != pdPASS )
+		{
+			continue;
+		}
+
+		if( xWelcomePending != pdFALSE )
+		{
+			/* A terminal has just opened the port. */
+			xWelcomePending = pdFALSE;
+			vCommandConsoleStart( &xUSBConsole );
+		}
+
+		if( xRxPending != pdFALSE )
+		{
+			/* The packet is processed in place. */
+			vCommandConsoleInput( &xUSBConsole, ( const char * ) ucRxPacket, xRxLength );
+
+			/* Accept the next packet, unless the device was reconfigured
+			meanwhile, in which case the endpoint has already been re-armed. */
+			taskENTER_CRITICAL();
+			{
+				if( ( xRxPending != pdFALSE ) && ( ucConfiguration != 0 ) )
+				{
+					xRxPending = pdFALSE;
+					HAL_PCD_EP_Receive( &hpcd_USB_OTG_FS, usbEP_DATA_OUT, ucRxPacket, usbMAX_PACKET_SIZE );
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUSBWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
+{
+BaseType_t xReturn = pdPASS;
+
+	( void ) pvTransport;
+
+	if( xHostReady == pdFALSE )
+	{
+		/* Nobody is listening. */
+		xTxStaged = 0;
+		return pdFAIL;
+	}
+
+	if( ( xTxStaged + xBufferLength ) <= sizeof( ucTxStaging ) )
+	{
+		/* Gather short output.  The staging buffer might still be in
+		flight. */
+		if( prvWaitForTransmission() != pdPASS )
+		{
+			xReturn = pdFAIL;
+		}
+
+		memcpy( &ucTxStaging[ xTxStaged ], pcBuffer, xBufferLength );
+		xTxStaged += xBufferLength;
+	}
+	else
+	{
+		/* Keep the output in order by sending what was gathered so far
+		first. */
+		if( prvSendStaged() != pdPASS )
+		{
+			xReturn = pdFAIL;
+		}
+
+		if( prvWaitForTransmission() != pdPASS )
+		{
+			xReturn = pdFAIL;
+		}
+
+		if( xBufferLength < sizeof( ucTxStaging ) )
+		{
+			memcpy( ucTxStaging, pcBuffer, xBufferLength );
+			xTxStaged = xBufferLength;
+		}
+		else
+		{
+			/* Send straight from the buffer of the caller, which can reuse the
+			buffer as soon as this function returns, so the transfer has to
+			complete first.  The USB core splits the transfer into packets
+			itself. */
+			if( ( prvStartTransmission( ( const uint8_t * ) pcBuffer, xBufferLength ) != pdPASS ) ||
+				( prvWaitForTransmission() != pdPASS ) )
+			{
+				xReturn = pdFAIL;
+			}
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUSBWriteReference( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
+{
+BaseType_t xReturn = pdPASS;
+
+	/* Short output is still gathered, so it shares a packet with the output
+	around it. */
+	if( ( xTxStaged + xBufferLength ) <= sizeof( ucTxStaging ) )
+	{
+		return prvUSBWrite( pvTransport, pcBuffer, xBufferLength );
+	}
+
+	if( xHostReady == pdFALSE )
+	{
+		xTxStaged = 0;
+		return pdFAIL;
+	}
+
+	/* The data does not change, so the transfer can still be in progress
+	when this function returns.  The next write waits for it. */
+	if( ( prvSendStaged() != pdPASS ) || ( prvWaitForTransmission() != pdPASS ) ||
+		( prvStartTransmission( ( const uint8_t * ) pcBuffer, xBufferLength ) != pdPASS ) )
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUSBFlush( void *pvTransport )
+{
+	( void ) pvTransport;
+
+	( void ) prvSendStaged();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendStaged( void )
+{
+BaseType_t xReturn = pdPASS;
+
+	if( xTxStaged > 0 )
+	{
+		if( ( prvWaitForTransmission() != pdPASS ) ||
+			( prvStartTransmission( ucTxStaging, xTxStaged ) != pdPASS ) )
+		{
+			xReturn = pdFAIL;
+		}
+
+		xTxStaged = 0;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStartTransmission( const uint8_t *pucBuffer, size_t xLength )
+{
+BaseType_t xReturn = pdFAIL;
+
+	/* The critical section stops the USB interrupt changing the configuration
+	between the check and the start of the transfer. */
+	taskENTER_CRITICAL();
+	{
+		if( xHostReady != pdFALSE )
+		{
+			xTxBusy = pdTRUE;
+			xTxZeroLengthPacket = ( ( xLength % usbMAX_PACKET_SIZE ) == 0 ) ? pdTRUE : pdFALSE;
+
+			if( HAL_PCD_EP_Transmit( &hpcd_USB_OTG_FS, usbEP_DATA_IN, ( uint8_t * ) pucBuffer, xLength ) == HAL_OK )
+			{
+				xReturn = pdPASS;
+			}
+			else
+			{
+				xTxBusy = pdFALSE;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitForTransmission( void )
+{
+	while( xTxBusy != pdFALSE )
+	{
+		if( xSemaphoreTake( xTxCompleteSemaphore, usbMAX_TX_WAIT ) != pdPASS )
+		{
+			/* The host is not reading.  Cancel the transfer so the buffer it
+			was sending from is released. */
+			taskENTER_CRITICAL();
+			{
+				prvCancelTransmission();
+			}
+			taskEXIT_CRITICAL();
+
+			return pdFAIL;
+		}
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCancelTransmission( void )
+{
+	if( xTxBusy != pdFALSE )
+	{
+		/* Disabling the endpoint stops the transfer. */
+		HAL_PCD_EP_Close( &hpcd_USB_OTG_FS, usbEP_DATA_IN );
+		HAL_PCD_EP_Flush( &hpcd_USB_OTG_FS, usbEP_DATA_IN );
+		xTxBusy = pdFALSE;
+
+		if( ucConfiguration != 0 )
+		{
+			HAL_PCD_EP_Open( &hpcd_USB_OTG_FS, usbEP_DATA_IN, usbMAX_PACKET_SIZE, EP_TYPE_BULK );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvGiveFromISR( SemaphoreHandle_t xSemaphore )
+{
+	portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	xSemaphoreGiveFromISR( xSemaphore, &xHigherPriorityTaskWoken );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetHostReady( BaseType_t xReady )
+{
+	if( ( xReady != pdFALSE ) && ( xHostReady == pdFALSE ) )
+	{
+		xHostReady = pdTRUE;
+		xWelcomePending = pdTRUE;
+		prvGiveFromISR( xEventSemaphore );
+	}
+	else if( ( xReady == pdFALSE ) && ( xHostReady != pdFALSE ) )
+	{
+		xHostReady = pdFALSE;
+
+		/* Release the task if it is waiting for a transfer that will now
+		never complete. */
+		if( xTxBusy != pdFALSE )
+		{
+			prvCancelTransmission();
+			prvGiveFromISR( xTxCompleteSemaphore );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetConfiguration( PCD_HandleTypeDef *hpcd, uint8_t ucValue )
+{
+	if( ucValue == ucConfiguration )
+	{
+		return;
+	}
+
+	if( ucConfiguration != 0 )
+	{
+		prvSetHostReady( pdFALSE );
+		HAL_PCD_EP_Close( hpcd, usbEP_DATA_IN );
+		HAL_PCD_EP_Close( hpcd, usbEP_DATA_OUT );
+		HAL_PCD_EP_Close( hpcd, usbEP_NOTIFY_IN );
+	}
+
+	ucConfiguration = ucValue;
+
+	if( ucConfiguration != 0 )
+	{
+		HAL_PCD_EP_Open( hpcd, usbEP_DATA_IN, usbMAX_PACKET_SIZE, EP_TYPE_BULK );
+		HAL_PCD_EP_Open( hpcd, usbEP_DATA_OUT, usbMAX_PACKET_SIZE, EP_TYPE_BULK );
+		HAL_PCD_EP_Open( hpcd, usbEP_NOTIFY_IN, usbNOTIFY_PACKET_SIZE, EP_TYPE_INTR );
+
+		xRxPending = pdFALSE;
+		HAL_PCD_EP_Receive( hpcd, usbEP_DATA_OUT, ucRxPacket, usbMAX_PACKET_SIZE );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvStringDescriptor( const char *pcString )
+{
+size_t x, xLength = strlen( pcString );
+
+	/* String descriptors are UTF-16LE. */
+	if( xLength > ( ( sizeof( ucControlBuffer ) - 2 ) / 2 ) )
+	{
+		xLength = ( sizeof( ucControlBuffer ) - 2 ) / 2;
+	}
+
+	ucControlBuffer[ 0 ] = ( uint8_t ) ( 2 + ( xLength * 2 ) );
+	ucControlBuffer[ 1 ] = usbDESC_STRING;
+
+	for( x = 0; x < xLength; x++ )
+	{
+		ucControlBuffer[ 2 + ( x * 2 ) ] = ( uint8_t ) pcString[ x ];
+		ucControlBuffer[ 3 + ( x * 2 ) ] = 0;
+	}
+
+	return ucControlBuffer[ 0 ];
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvGetDescriptor( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup )
+{
+static const char cHexDigits[] = "0123456789ABCDEF";
+char cSerialNumber[ 13 ];
+uint32_t ulUID;
+size_t x;
+BaseType_t xReturn = pdTRUE;
+
+	switch( usbHIBYTE( pxSetup->usValue ) )
+	{
+		case usbDESC_DEVICE:
+			prvControlSendData( hpcd, ucDeviceDescriptor, sizeof( ucDeviceDescriptor ), pxSetup->usLength );
+			break;
+
+		case usbDESC_CONFIGURATION:
+			prvControlSendData( hpcd, ucConfigurationDescriptor, sizeof( ucConfigurationDescriptor ), pxSetup->usLength );
+			break;
+
+		case usbDESC_STRING:
+			switch( usbLOBYTE( pxSetup->usValue ) )
+			{
+				case 0:
+					prvControlSendData( hpcd, ucLanguageDescriptor, sizeof( ucLanguageDescriptor ), pxSetup->usLength );
+					break;
+
+				case 1:
+					prvControlSendData( hpcd, ucControlBuffer, prvStringDescriptor( pcManufacturerString ), pxSetup->usLength );
+					break;
+
+				case 2:
+					prvControlSendData( hpcd, ucControlBuffer, prvStringDescriptor( pcProductString ), pxSetup->usLength );
+					break;
+
+				case 3:
+					/* Derive the serial number from the unique device ID so
+					the host gives each board its own port name. */
+					ulUID = HAL_GetUIDw0() + HAL_GetUIDw2();
+					for( x = 0; x < 8; x++ )
+					{
+						cSerialNumber[ x ] = cHexDigits[ ( ulUID >> ( 28 - ( x * 4 ) ) ) & 0x0F ];
+					}
+					ulUID = HAL_GetUIDw1();
+					for( x = 0; x < 4; x++ )
+					{
+						cSerialNumber[ 8 + x ] = cHexDigits[ ( ulUID >> ( 28 - ( x * 4 ) ) ) & 0x0F ];
+					}
+					cSerialNumber[ 12 ] = '\0';
+					prvControlSendData( hpcd, ucControlBuffer, prvStringDescriptor( cSerialNumber ), pxSetup->usLength );
+					break;
+
+				default:
+					xReturn = pdFALSE;
+					break;
+			}
+			break;
+
+		default:
+			/* Includes the device qualifier, which a full speed only device
+			must not return. */
+			xReturn = pdFALSE;
+			break;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStandardRequest( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup )
+{
+BaseType_t xReturn = pdTRUE;
+BaseType_t xEndpointHalt;
+
+	xEndpointHalt = ( ( ( pxSetup->ucRequestType & usbREQUEST_RECIPIENT_MASK ) == usbREQUEST_RECIPIENT_EP ) &&
+					  ( pxSetup->usValue == usbFEATURE_ENDPOINT_HALT ) &&
+					  ( ( pxSetup->usIndex & 0x7F ) != 0 ) ) ? pdTRUE : pdFALSE;
+
+	switch( pxSetup->ucRequest )
+	{
+		case usbREQ_GET_STATUS:
+			ucControlBuffer[ 0 ] = 0;
+			ucControlBuffer[ 1 ] = 0;
+			prvControlSendData( hpcd, ucControlBuffer, 2, pxSetup->usLength );
+			break;
+
+		case usbREQ_CLEAR_FEATURE:
+			if( xEndpointHalt != pdFALSE )
+			{
+				HAL_PCD_EP_ClrStall( hpcd, usbLOBYTE( pxSetup->usIndex ) );
+			}
+			prvControlSendStatus( hpcd );
+			break;
+
+		case usbREQ_SET_FEATURE:
+			if( xEndpointHalt != pdFALSE )
+			{
+				HAL_PCD_EP_SetStall( hpcd, usbLOBYTE( pxSetup->usIndex ) );
+			}
+			prvControlSendStatus( hpcd );
+			break;
+
+		case usbREQ_SET_ADDRESS:
+			/* The OTG core applies the address after the status stage
+			itself. */
+			HAL_PCD_SetAddress( hpcd, ( uint8_t ) ( pxSetup->usValue & 0x7F ) );
+			prvControlSendStatus( hpcd );
+			break;
+
+		case usbREQ_GET_DESCRIPTOR:
+			xReturn = prvGetDescriptor( hpcd, pxSetup );
+			break;
+
+		case usbREQ_GET_CONFIGURATION:
+			ucControlBuffer[ 0 ] = ucConfiguration;
+			prvControlSendData( hpcd, ucControlBuffer, 1, pxSetup->usLength );
+			break;
+
+		case usbREQ_SET_CONFIGURATION:
+			if( pxSetup->usValue <= 1 )
+			{
+				prvSetConfiguration( hpcd, ( uint8_t ) pxSetup->usValue );
+				prvControlSendStatus( hpcd );
+			}
+			else
+			{
+				xReturn = pdFALSE;
+			}
+			break;
+
+		case usbREQ_GET_INTERFACE:
+			ucControlBuffer[ 0 ] = 0;
+			prvControlSendData( hpcd, ucControlBuffer, 1, pxSetup->usLength );
+			break;
+
+		case usbREQ_SET_INTERFACE:
+			/* Neither interface has alternate settings. */
+			xReturn = ( pxSetup->usValue == 0 ) ? pdTRUE : pdFALSE;
+			if( xReturn != pdFALSE )
+			{
+				prvControlSendStatus( hpcd );
+			}
+			break;
+
+		default:
+			xReturn = pdFALSE;
+			break;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvClassRequest( PCD_HandleTypeDef *hpcd, const SetupPacket_t *pxSetup )
+{
+BaseType_t xReturn = pdTRUE;
+
+	switch( pxSetup->ucRequest )
+	{
+		case usbREQ_SET_LINE_CODING:
+			if( pxSetup->usLength == sizeof( ucLineCoding ) )
+			{
+				/* The line coding arrives in the data stage. */
+				ucControlRequest = pxSetup->ucRequest;
+				eControlState = eControlDataOut;
+				HAL_PCD_EP_Receive( hpcd, usbEP_CONTROL_OUT, ucControlBuffer, sizeof( ucLineCoding ) );
+			}
+			else
+			{
+				xReturn = pdFALSE;
+			}
+			break;
+
+		case usbREQ_GET_LINE_CODING:
+			prvControlSendData( hpcd, ucLineCoding, sizeof( ucLineCoding ), pxSetup->usLength );
+			break;
+
+		case usbREQ_SET_CONTROL_LINE_STATE:
+			/* Terminals raise DTR when they open the port and drop it when
+			they close it. */
+			prvSetHostReady( ( ( ucConfiguration != 0 ) && ( ( pxSetup->usValue & usbCONTROL_LINE_DTR ) != 0 ) ) ? pdTRUE : pdFALSE );
+			prvControlSendStatus( hpcd );
+			break;
+
+		case usbREQ_SEND_BREAK:
+			prvControlSendStatus( hpcd );
+			break;
+
+		default:
+			xReturn = pdFALSE;
+			break;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlSendData( PCD_HandleTypeDef *hpcd, const uint8_t *pucData, size_t xLength, uint16_t usRequested )
+{
+	if( xLength > usRequested )
+	{
+		xLength = usRequested;
+	}
+
+	/* A reply shorter than requested that ends with a full packet has to be
+	terminated by a zero length packet. */
+	xControlZeroLengthPacket = ( ( xLength < usRequested ) && ( xLength > 0 ) && ( ( xLength % usbMAX_PACKET_SIZE ) == 0 ) ) ? pdTRUE : pdFALSE;
+	pucControlData = pucData;
+	xControlRemaining = xLength;
+	eControlState = eControlDataIn;
+
+	/* Endpoint 0 is sent one packet at a time, the rest is sent from the data
+	IN stage callback. */
+	xLength = ( xControlRemaining > usbMAX_PACKET_SIZE ) ? usbMAX_PACKET_SIZE : xControlRemaining;
+	HAL_PCD_EP_Transmit( hpcd, usbEP_CONTROL_IN, ( uint8_t * ) pucControlData, xLength );
+	pucControlData += xLength;
+	xControlRemaining -= xLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlSendStatus( PCD_HandleTypeDef *hpcd )
+{
+	eControlState = eControlStatusIn;
+	HAL_PCD_EP_Transmit( hpcd, usbEP_CONTROL_IN, NULL, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlStall( PCD_HandleTypeDef *hpcd )
+{
+	/* The stall is cleared by the core when the next setup packet
+	arrives. */
+	eControlState = eControlIdle;
+	HAL_PCD_EP_SetStall( hpcd, usbEP_CONTROL_IN );
+	HAL_PCD_EP_SetStall( hpcd, usbEP_CONTROL_OUT );
+}
+/*-----------------------------------------------------------*/
+
+void HAL_PCD_SetupStageCallback( PCD_HandleTypeDef *hpcd )
+{
+const uint8_t *pucSetup = ( const uint8_t * ) hpcd->Setup;
+SetupPacket_t xSetup;
+BaseType_t xHandled;
+
+	xSetup.ucRequestType = pucSetup[ 0 ];
+	xSetup.ucRequest = pucSetup[ 1 ];
+	xSetup.usValue = ( uint16_t ) ( pucSetup[ 2 ] | ( pucSetup[ 3 ] << 8 ) );
+	xSetup.usIndex = ( uint16_t ) ( pucSetup[ 4 ] | ( pucSetup[ 5 ] << 8 ) );
+	xSetup.usLength = ( uint16_t ) ( pucSetup[ 6 ] | ( pucSetup[ 7 ] << 8 ) );
+
+	switch( xSetup.ucRequestType & usbREQUEST_TYPE_MASK )
+	{
+		case usbREQUEST_TYPE_STANDARD:
+			xHandled = prvStandardRequest( hpcd, &xSetup );
+			break;
+
+		case usbREQUEST_TYPE_CLASS:
+			xHandled = prvClassRequest( hpcd, &xSetup );
+			break;
+
+		default:
+			xHandled = pdFALSE;
+			break;
+	}
+
+	if( xHandled == pdFALSE )
+	{
+		prvControlStall( hpcd );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HAL_PCD_DataInStageCallback( PCD_HandleTypeDef *hpcd, uint8_t epnum )
+{
+size_t xLength;
+
+	if( epnum == 0 )
+	{
+		if( eControlState == eControlDataIn )
+		{
+			if( xControlRemaining > 0 )
+			{
+				xLength = ( xControlRemaining > usbMAX_PACKET_SIZE ) ? usbMAX_PACKET_SIZE : xControlRemaining;
+				HAL_PCD_EP_Transmit( hpcd, usbEP_CONTROL_IN, ( uint8_t * ) pucControlData, xLength );
+				pucControlData += xLength;
+				xControlRemaining -= xLength;
+			}
+			else if( xControlZeroLengthPacket != pdFALSE )
+			{
+				xControlZeroLengthPacket = pdFALSE;
+				HAL_PCD_EP_Transmit( hpcd, usbEP_CONTROL_IN, NULL, 0 );
+			}
+			else
+			{
+				/* All the data was sent, receive the status stage. */
+				eControlState = eControlStatusOut;
+				HAL_PCD_EP_Receive( hpcd, usbEP_CONTROL_OUT, NULL, 0 );
+			}
+		}
+		else
+		{
+			eControlState = eControlIdle;
+		}
+	}
+	else if( epnum == ( usbEP_DATA_IN & 0x7F ) )
+	{
+		if( xTxZeroLengthPacket != pdFALSE )
+		{
+			xTxZeroLengthPacket = pdFALSE;
+			HAL_PCD_EP_Transmit( hpcd, usbEP_DATA_IN, NULL, 0 );
+		}
+		else
+		{
+			xTxBusy = pdFALSE;
+			prvGiveFromISR( xTxCompleteSemaphore );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HAL_PCD_DataOutStageCallback( PCD_HandleTypeDef *hpcd, uint8_t epnum )
+{
+	if( epnum == 0 )
+	{
+		if( eControlState == eControlDataOut )
+		{
+			if( ucControlRequest == usbREQ_SET_LINE_CODING )
+			{
+				memcpy( ucLineCoding, ucControlBuffer, sizeof( ucLineCoding ) );
+			}
+
+			prvControlSendStatus( hpcd );
+		}
+		else
+		{
+			eControlState = eControlIdle;
+		}
+	}
+	else if( epnum == usbEP_DATA_OUT )
+	{
+		/* Hand the packet to the task.  The endpoint is re-armed once it has
+		been processed. */
+		xRxLength = HAL_PCD_EP_GetRxCount( hpcd, epnum );
+		xRxPending = pdTRUE;
+		prvGiveFromISR( xEventSemaphore );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void HAL_PCD_ResetCallback( PCD_HandleTypeDef *hpcd )
+{
+	/* The bus reset deconfigures the device. */
+	ucConfiguration = 0;
+	prvSetHostReady( pdFALSE );
+	eControlState = eControlIdle;
+
+	HAL_PCD_EP_Open( hpcd, usbEP_CONTROL_OUT, usbMAX_PACKET_SIZE, EP_TYPE_CTRL );
+	HAL_PCD_EP_Open( hpcd, usbEP_CONTROL_IN, usbMAX_PACKET_SIZE, EP_TYPE_CTRL );
+}
+/*-----------------------------------------------------------*/
+
+void HAL_PCD_DisconnectCallback( PCD_HandleTypeDef *hpcd )
+{
+	( void ) hpcd;
+
+	/* VBUS was removed. */
+	ucConfiguration = 0;
+	prvSetHostReady( pdFALSE );
+	eControlState = eControlIdle;
+}
@@ -24,7 +24,8 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "timers.h"
+#include "RunTimeStats.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -34,7 +35,10 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/* The 32-bit cycle counter wraps every 2^32 / SystemCoreClock seconds, which is
+about 20 seconds at 216MHz.  It is sampled at least this often so a wrap is
+never missed, even when no context switch happens. */
+#define runtimeSAMPLE_PERIOD_MS    5000
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -44,12 +48,21 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+/* The cycle counter extended to 64 bits, and the same time in microseconds.
+The microseconds are kept as a running total, with the cycles that do not yet
+make up a whole microsecond carried in ulCycleRemainder, so updating never
+needs a 64-bit division. */
+static uint64_t ullCycles = 0;
+static uint64_t ullMicroseconds = 0;
+static uint32_t ulLastCycleCount = 0;
+static uint32_t ulCycleRemainder = 0;
+static uint32_t ulCyclesPerMicrosecond = 1;
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
-
+static void prvUpdateRunTimeCounter( void );
+static void prvRunTimeSampleCallback( TimerHandle_t xTimer );
 /* USER CODE END FunctionPrototypes */
 
 /* Hook prototypes */
@@ -58,14 +71,123 @@ unsigned long getRunTimeCounterValue(void);
 
 /* USER CODE BEGIN 1 */
 /* Functions needed when configGENERATE_RUN_TIME_STATS is on */
-__weak void configureTimerForRunTimeStats(void)
+void configureTimerForRunTimeStats(void)
+{
+TimerHandle_t xSampleTimer;
+
+	/* Start the DWT cycle counter.  The Cortex-M7 DWT is locked until the
+	lock access register is written. */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	ulCyclesPerMicrosecond = SystemCoreClock / 1000000UL;
+	if( ulCyclesPerMicrosecond == 0 )
+	{
+		ulCyclesPerMicrosecond = 1;
+	}
+
+	/* Called by vTaskStartScheduler() after the timer task was created, so
+	the timer starts as soon as the scheduler does. */
+	xSampleTimer = xTimerCreate( "RunTime", pdMS_TO_TICKS( runtimeSAMPLE_PERIOD_MS ), pdTRUE, NULL, prvRunTimeSampleCallback );
+	configASSERT( xSampleTimer );
+	xTimerStart( xSampleTimer, 0 );
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+	/* This kernel only has 32-bit run-time counters, so it is given the low
+	bits of a count of runtimeCOUNTER_PERIOD_US periods.  It subtracts them from
+	each other to work out how long a task ran, which is right across a wrap.
+	The total it returns from uxTaskGetSystemState(), and the time of each task,
+	all wrap after 2^32 periods, about 5 days; with microseconds even the idle
+	task's time would wrap after 71 minutes.  Anything that needs the full time
+	should call ullGetRunTimeMicroseconds(). */
+	return ( unsigned long ) ( ullGetRunTimeMicroseconds() / runtimeCOUNTER_PERIOD_US );
+}
+
+uint64_t ullGetRunTimeCycles( void )
+{
+UBaseType_t uxSavedInterruptStatus;
+uint64_t ullReturn;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		prvUpdateRunTimeCounter();
+		ullReturn = ullCycles;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return ullReturn;
+}
+
+uint64_t ullGetRunTimeMicroseconds( void )
+{
+UBaseType_t uxSavedInterruptStatus;
+uint64_t ullReturn;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		prvUpdateRunTimeCounter();
+		ullReturn = ullMicroseconds;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return ullReturn;
+}
+
+static void prvUpdateRunTimeCounter( void )
+{
+uint32_t ulNow = DWT->CYCCNT;
+uint32_t ulElapsed = ulNow - ulLastCycleCount;
+
+	/* Must be called with interrupts masked. */
+	ulLastCycleCount = ulNow;
+	ullCycles += ulElapsed;
+
+	ulCycleRemainder += ulElapsed;
+	if( ulCycleRemainder >= ulCyclesPerMicrosecond )
+	{
+		ullMicroseconds += ulCycleRemainder / ulCyclesPerMicrosecond;
+		ulCycleRemainder %= ulCyclesPerMicrosecond;
+	}
+}
+
+void vRunTimeStatsClockChanged( void )
+{
+UBaseType_t uxSavedInterruptStatus;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		/* Cycles counted since the caller collected them are few enough to be
+		converted at the new rate. */
+		prvUpdateRunTimeCounter();
+		ulCycleRemainder = 0;
+		ulCyclesPerMicrosecond = SystemCoreClock / 1000000UL;
+		if( ulCyclesPerMicrosecond == 0 )
+		{
+			ulCyclesPerMicrosecond = 1;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+
+void vRunTimeStatsAddMicroseconds( uint32_t ulMicroseconds )
 {
+UBaseType_t uxSavedInterruptStatus;
 
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		ullMicroseconds += ulMicroseconds;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
 }
 
-__weak unsigned long getRunTimeCounterValue(void)
+static void prvRunTimeSampleCallback( TimerHandle_t xTimer )
 {
-return 0;
+	( void ) xTimer;
+	( void ) ullGetRunTimeCycles();
 }
 /* USER CODE END 1 */
 
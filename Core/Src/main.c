@@ -23,6 +23,14 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "CommandLineInterface.h"
+#include "USBCommandConsole.h"
+#include "NetworkInterface.h"
+#include "TelnetCommandConsole.h"
+#include "CommandWorker.h"
+#include "MemoryLayout.h"
+#include "ClockProfile.h"
+#include "ConfigStore.h"
+#include "FirmwareUpdate.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -55,7 +63,8 @@ const osThreadAttr_t defaultTask_attributes = {
   .priority = (osPriority_t) osPriorityNormal,
 };
 /* USER CODE BEGIN PV */
-
+DMA_HandleTypeDef hdma_usart3_rx;
+DMA_HandleTypeDef hdma_usart3_tx;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -82,7 +91,7 @@ void StartDefaultTask(void *argument);
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-
+  vMemoryLayoutConfigure();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -98,6 +107,9 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  /* SystemClock_Config() leaves over-drive on, which the boot profile may not
+  need. */
+  ( void ) xClockProfileApply( clockBOOT_PROFILE );
 
   /* USER CODE END SysInit */
 
@@ -107,7 +119,13 @@ int main(void)
   MX_USART3_UART_Init();
   MX_USB_OTG_FS_PCD_Init();
   /* USER CODE BEGIN 2 */
+  ConfigStoreStart( tskIDLE_PRIORITY );
+  FirmwareUpdateStart( tskIDLE_PRIORITY );
   CommandLineInterfaceStart( ( configMINIMAL_STACK_SIZE * 3 ), tskIDLE_PRIORITY);
+  USBCommandConsoleStart( ( configMINIMAL_STACK_SIZE * 3 ), tskIDLE_PRIORITY);
+  NetworkInterfaceStart( ( configMINIMAL_STACK_SIZE * 3 ), tskIDLE_PRIORITY + 1);
+  TelnetCommandConsoleStart( ( configMINIMAL_STACK_SIZE * 3 ), tskIDLE_PRIORITY);
+  CommandWorkerStart( tskIDLE_PRIORITY );
   /* USER CODE END 2 */
 
   /* Init scheduler */
@@ -247,7 +265,11 @@ static void MX_ETH_Init(void)
   heth.Init.MediaInterface = ETH_MEDIA_INTERFACE_RMII;
 
   /* USER CODE BEGIN MACADDRESS */
-
+  /* Keep the ST prefix, but take the rest of the address from the unique
+  device ID so boards on the same network do not clash. */
+  MACAddr[3] = (uint8_t)(HAL_GetUIDw0() ^ (HAL_GetUIDw0() >> 24));
+  MACAddr[4] = (uint8_t)(HAL_GetUIDw1() ^ (HAL_GetUIDw1() >> 16));
+  MACAddr[5] = (uint8_t)(HAL_GetUIDw2() ^ (HAL_GetUIDw2() >> 8));
   /* USER CODE END MACADDRESS */
 
   if (HAL_ETH_Init(&heth) != HAL_OK)
@@ -91,6 +91,24 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Copy the ITCM code and the DTCM data initializers from flash. */
+  ldr r0, =_sitcm
+  ldr r1, =_eitcm
+  ldr r2, =_siitcm
+  bl CopySection
+  ldr r0, =_sdtcm_data
+  ldr r1, =_edtcm_data
+  ldr r2, =_sidtcm_data
+  bl CopySection
+
+/* Zero fill the DTCM bss and the DMA buffers. */
+  ldr r0, =_sdtcm_bss
+  ldr r1, =_edtcm_bss
+  bl ZeroSection
+  ldr r0, =_sdma_buffer
+  ldr r1, =_edma_buffer
+  bl ZeroSection
+
 /* Call the clock system initialization function.*/
   bl  SystemInit   
 /* Call static constructors */
@@ -100,6 +118,36 @@ LoopFillZerobss:
   bx  lr    
 .size  Reset_Handler, .-Reset_Handler
 
+/* Copy the words from r2 to [r0, r1). */
+CopySection:
+  movs r3, #0
+  b LoopCopySection
+
+CopySectionWord:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopySection:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopySectionWord
+  bx lr
+
+/* Zero fill [r0, r1). */
+ZeroSection:
+  movs r3, #0
+  b LoopZeroSection
+
+ZeroSectionWord:
+  str  r3, [r0]
+  adds r0, r0, #4
+
+LoopZeroSection:
+  cmp r0, r1
+  bcc ZeroSectionWord
+  bx lr
+
 /**
  * @brief  This is the code that gets called when the processor receives an 
  *         unexpected interrupt.  This simply enters an infinite loop, preserving
@@ -0,0 +1,61 @@
+/*
+ * BenchHarness.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef INC_BENCHHARNESS_H_
+#define INC_BENCHHARNESS_H_
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/*
+ * Runs the benchmarks of the host build, see Host/CMakeLists.txt.  Each
+ * benchmark program passes its main() arguments to iBenchMain(), which runs
+ * the benchmark in a FreeRTOS task, as the command interpreter expects, and
+ * checks each result reported with vBenchReport() against the thresholds
+ * file named on the command line.  A line of that file holds a result name and
+ * the highest value it may take, in the unit of the result, and # starts a
+ * comment.  The program fails if a result is over its threshold, or if the file
+ * cannot be read.  Results without a threshold are only printed.
+ *
+ * Times depend on the host, so the thresholds are set on results that compare
+ * two times taken in the same run, with ulBenchPercent().
+ */
+
+/* The number of times a measurement is repeated.  The fastest run is taken, as
+the others only add the time the host spent elsewhere. */
+#ifndef benchREPEATS
+	#define benchREPEATS		15
+#endif
+
+typedef void ( *BenchFunction_t )( void *pvContext );
+
+/*
+ * Start the scheduler and run pxBenchmark in a task.  Never returns: the
+ * program exits once pxBenchmark has, with a status telling whether every
+ * result was within its threshold.
+ */
+int iBenchMain( int argc, char *argv[], BenchFunction_t pxBenchmark, void *pvContext );
+
+/*
+ * The number of nanoseconds a call to pxFunction takes, from the fastest of
+ * benchREPEATS runs of ulIterations calls.
+ */
+uint32_t ulBenchTime( BenchFunction_t pxFunction, void *pvContext, uint32_t ulIterations );
+
+/*
+ * ulValue as a percentage of ulReference, rounded up.
+ */
+uint32_t ulBenchPercent( uint32_t ulValue, uint32_t ulReference );
+
+/*
+ * Print a result, and check it against its threshold.
+ */
+void vBenchReport( const char *pcName, uint32_t ulValue, const char *pcUnit );
+
+#endif /* INC_BENCHHARNESS_H_ */
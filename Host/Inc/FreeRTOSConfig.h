@@ -0,0 +1,88 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*
+ * The kernel configuration of the host build, see Host/CMakeLists.txt.  It
+ * follows Core/Inc/FreeRTOSConfig.h wherever the command interpreter core can
+ * tell the difference, and the needs of the POSIX port everywhere else.
+ */
+
+#include <stdint.h>
+
+/* Provided by BenchHarness.c. */
+extern void vBenchAssertCalled( const char *pcFile, unsigned long ulLine );
+extern void vBenchConfigureRunTimeCounter( void );
+extern unsigned long ulBenchGetRunTimeCounter( void );
+
+#define configUSE_PREEMPTION                     1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       ( ( unsigned long ) 1000000 )
+#define configTICK_RATE_HZ                       ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                     ( 8 )
+/* In words.  Each task runs on a thread, whose stack must be at least
+PTHREAD_STACK_MIN bytes. */
+#define configMINIMAL_STACK_SIZE                 ( ( unsigned short ) 4096 )
+#define configTOTAL_HEAP_SIZE                    ( ( size_t ) ( 1024 * 1024 ) )
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configGENERATE_RUN_TIME_STATS            1
+#define configUSE_TRACE_FACILITY                 1
+#define configUSE_STATS_FORMATTING_FUNCTIONS     0
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                0
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_CO_ROUTINES                    0
+
+/* Nothing in the command interpreter core uses software timers. */
+#define configUSE_TIMERS                         0
+
+#define INCLUDE_vTaskPrioritySet                 1
+#define INCLUDE_uxTaskPriorityGet                1
+#define INCLUDE_vTaskDelete                      1
+#define INCLUDE_vTaskSuspend                     1
+#define INCLUDE_vTaskDelay                       1
+#define INCLUDE_xTaskGetSchedulerState           1
+#define INCLUDE_xTaskGetCurrentTaskHandle        1
+#define INCLUDE_xQueueGetMutexHolder             1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#define INCLUDE_eTaskGetState                    1
+
+#define configASSERT( x ) if( ( x ) == 0 ) { vBenchAssertCalled( __FILE__, __LINE__ ); }
+
+/* Microseconds of the monotonic clock, as the firmware counts them. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vBenchConfigureRunTimeCounter()
+#define portGET_RUN_TIME_COUNTER_VALUE() ulBenchGetRunTimeCounter()
+
+/* As the firmware, except that more commands can be registered, for the
+dispatch benchmark.  Static command tables rely on the firmware linker script,
+so the commands are registered at run time. */
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE 1024
+#define configCOMMAND_INT_STATIC_COMMANDS 0
+#define configCOMMAND_INT_MAX_COMMANDS 160
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 1
+#define configCOMMAND_INT_TLS_INDEX 0
+
+/* The block classes of the firmware, with enough small blocks for the list
+items of the commands registered by the dispatch benchmark, see BlockPool.h.
+Pointers are twice the size they are on the board, which makes a background
+command of CommandWorker.c larger than 1024 bytes, so the largest blocks are
+larger too. */
+#define poolBLOCK_CLASSES		\
+	poolCLASS( 32, 176 )		\
+	poolCLASS( 128, 8 )			\
+	poolCLASS( 1536, 4 )
+
+#endif /* FREERTOS_CONFIG_H */
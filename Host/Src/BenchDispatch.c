@@ -0,0 +1,120 @@
+/*
+ * BenchDispatch.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+/*
+ * The time FreeRTOS_CLIProcessCommand() takes to find and call a command that
+ * does nothing, as more commands are registered, and to reject a command that
+ * is not registered.  Each time is also reported as a percentage of the time
+ * taken with the fewest commands.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_CLI.h"
+#include "BenchHarness.h"
+
+/* The number of commands registered for each measurement, not counting help.
+The last must fit in configCOMMAND_INT_MAX_COMMANDS. */
+static const UBaseType_t uxCommandCounts[] = { 8, 32, 128 };
+
+#define dispatchMAX_COMMANDS	128
+#define dispatchITERATIONS		20000
+
+static char cCommandNames[ dispatchMAX_COMMANDS ][ 12 ];
+static char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+
+static BaseType_t prvNullCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvDispatch( void *pvContext );
+static void prvBenchmark( void *pvContext );
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+	return iBenchMain( argc, argv, prvBenchmark, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNullCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	pcWriteBuffer[ 0 ] = 0x00;
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDispatch( void *pvContext )
+{
+	( void ) FreeRTOS_CLIProcessCommand( ( const char * ) pvContext, cOutputBuffer, sizeof( cOutputBuffer ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmark( void *pvContext )
+{
+CLI_Command_Definition_t *pxDefinition;
+UBaseType_t uxRegistered = 0, x;
+BaseType_t xRegistered;
+uint32_t ulKnown, ulUnknown, ulFirstKnown = 0, ulFirstUnknown = 0;
+char cName[ 48 ];
+
+	( void ) pvContext;
+
+	for( x = 0; x < ( sizeof( uxCommandCounts ) / sizeof( uxCommandCounts[ 0 ] ) ); x++ )
+	{
+		/* Commands cannot be unregistered, so each count adds to the last. */
+		while( uxRegistered < uxCommandCounts[ x ] )
+		{
+			snprintf( cCommandNames[ uxRegistered ], sizeof( cCommandNames[ 0 ] ), "bench-%03u", ( unsigned int ) uxRegistered );
+
+			/* The members of a definition are const, so it is built on the
+			stack and copied. */
+			{
+				const CLI_Command_Definition_t xDefinition = { cCommandNames[ uxRegistered ], "\r\n", prvNullCommand, 0, 0 };
+
+				pxDefinition = ( CLI_Command_Definition_t * ) pvPortMalloc( sizeof( CLI_Command_Definition_t ) );
+				configASSERT( pxDefinition );
+				memcpy( pxDefinition, &xDefinition, sizeof( xDefinition ) );
+			}
+
+			xRegistered = FreeRTOS_CLIRegisterCommand( pxDefinition );
+			configASSERT( xRegistered == pdPASS );
+			uxRegistered++;
+		}
+
+		/* The command in the middle of the index, and one that is not in it. */
+		ulKnown = ulBenchTime( prvDispatch, cCommandNames[ uxRegistered / 2 ], dispatchITERATIONS );
+		snprintf( cName, sizeof( cName ), "dispatch_%u_commands", ( unsigned int ) uxRegistered );
+		vBenchReport( cName, ulKnown, "ns" );
+
+		ulUnknown = ulBenchTime( prvDispatch, ( void * ) "bench-none", dispatchITERATIONS );
+		snprintf( cName, sizeof( cName ), "dispatch_unknown_%u_commands", ( unsigned int ) uxRegistered );
+		vBenchReport( cName, ulUnknown, "ns" );
+
+		if( x == 0 )
+		{
+			ulFirstKnown = ulKnown;
+			ulFirstUnknown = ulUnknown;
+		}
+		else
+		{
+			snprintf( cName, sizeof( cName ), "dispatch_%u_vs_%u_commands", ( unsigned int ) uxRegistered, ( unsigned int ) uxCommandCounts[ 0 ] );
+			vBenchReport( cName, ulBenchPercent( ulKnown, ulFirstKnown ), "%" );
+
+			snprintf( cName, sizeof( cName ), "dispatch_unknown_%u_vs_%u_commands", ( unsigned int ) uxRegistered, ( unsigned int ) uxCommandCounts[ 0 ] );
+			vBenchReport( cName, ulBenchPercent( ulUnknown, ulFirstUnknown ), "%" );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,253 @@
+/*
+ * BenchHarness.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "BenchHarness.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+#include "RunTimeStats.h"
+
+/* The most thresholds a thresholds file can hold, and the longest name. */
+#define benchMAX_THRESHOLDS		64
+#define benchMAX_NAME			48
+
+/* The benchmark task runs above the idle task, and is boosted further by the
+consoles it initialises, see CommandGovernor.h. */
+#define benchTASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define benchTASK_STACK_SIZE	( configMINIMAL_STACK_SIZE * 4 )
+
+typedef struct xBENCH_THRESHOLD
+{
+	char cName[ benchMAX_NAME ];
+	uint32_t ulLimit;
+} BenchThreshold_t;
+
+static BenchThreshold_t xThresholds[ benchMAX_THRESHOLDS ];
+static UBaseType_t uxThresholds = 0;
+static BaseType_t xFailed = pdFALSE;
+
+static BenchFunction_t pxBenchmarkFunction = NULL;
+static void *pvBenchmarkContext = NULL;
+
+/*
+ * Read the thresholds file.  Returns pdFAIL if it cannot be read, or has a line
+ * that is not a name and a number.
+ */
+static BaseType_t prvReadThresholds( const char *pcFileName );
+
+/*
+ * The monotonic clock, in nanoseconds.
+ */
+static uint64_t prvNow( void );
+
+/*
+ * The task the benchmark runs in.
+ */
+static void prvBenchTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+int iBenchMain( int argc, char *argv[], BenchFunction_t pxBenchmark, void *pvContext )
+{
+	if( argc != 2 )
+	{
+		fprintf( stderr, "usage: %s <thresholds file>\n", argv[ 0 ] );
+		return EXIT_FAILURE;
+	}
+
+	if( prvReadThresholds( argv[ 1 ] ) != pdPASS )
+	{
+		return EXIT_FAILURE;
+	}
+
+	pxBenchmarkFunction = pxBenchmark;
+	pvBenchmarkContext = pvContext;
+
+	xTaskCreate( prvBenchTask, "Bench", benchTASK_STACK_SIZE, NULL, benchTASK_PRIORITY, NULL );
+	vTaskStartScheduler();
+
+	/* Only reached if the scheduler could not be started. */
+	fprintf( stderr, "The scheduler could not be started\n" );
+	return EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBenchTime( BenchFunction_t pxFunction, void *pvContext, uint32_t ulIterations )
+{
+uint64_t ullBest = UINT64_MAX, ullStart, ullElapsed;
+uint32_t ulRepeat, ulIteration;
+
+	configASSERT( ulIterations > 0 );
+
+	/* One call first, so nothing is measured being set up the first time. */
+	pxFunction( pvContext );
+
+	for( ulRepeat = 0; ulRepeat < benchREPEATS; ulRepeat++ )
+	{
+		ullStart = prvNow();
+		for( ulIteration = 0; ulIteration < ulIterations; ulIteration++ )
+		{
+			pxFunction( pvContext );
+		}
+		ullElapsed = prvNow() - ullStart;
+
+		if( ullElapsed < ullBest )
+		{
+			ullBest = ullElapsed;
+		}
+	}
+
+	/* Rounded up, so a call is never reported as taking no time. */
+	return ( uint32_t ) ( ( ullBest + ulIterations - 1 ) / ulIterations );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBenchPercent( uint32_t ulValue, uint32_t ulReference )
+{
+	configASSERT( ulReference > 0 );
+
+	return ( uint32_t ) ( ( ( ( uint64_t ) ulValue * 100ULL ) + ulReference - 1 ) / ulReference );
+}
+/*-----------------------------------------------------------*/
+
+void vBenchReport( const char *pcName, uint32_t ulValue, const char *pcUnit )
+{
+UBaseType_t x;
+
+	for( x = 0; x < uxThresholds; x++ )
+	{
+		if( strcmp( xThresholds[ x ].cName, pcName ) == 0 )
+		{
+			break;
+		}
+	}
+
+	if( x == uxThresholds )
+	{
+		printf( "%-32s %10u %-8s (no threshold)\n", pcName, ( unsigned int ) ulValue, pcUnit );
+	}
+	else if( ulValue > xThresholds[ x ].ulLimit )
+	{
+		printf( "%-32s %10u %-8s FAIL, the threshold is %u\n", pcName, ( unsigned int ) ulValue, pcUnit, ( unsigned int ) xThresholds[ x ].ulLimit );
+		xFailed = pdTRUE;
+	}
+	else
+	{
+		printf( "%-32s %10u %-8s ok, the threshold is %u\n", pcName, ( unsigned int ) ulValue, pcUnit, ( unsigned int ) xThresholds[ x ].ulLimit );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReadThresholds( const char *pcFileName )
+{
+FILE *pxFile;
+char cLine[ 128 ], cName[ benchMAX_NAME ];
+char *pcComment;
+unsigned long ulLimit;
+unsigned int uxLine = 0;
+BaseType_t xReturn = pdPASS;
+
+	pxFile = fopen( pcFileName, "r" );
+	if( pxFile == NULL )
+	{
+		fprintf( stderr, "%s could not be opened\n", pcFileName );
+		return pdFAIL;
+	}
+
+	while( ( xReturn == pdPASS ) && ( fgets( cLine, sizeof( cLine ), pxFile ) != NULL ) )
+	{
+		uxLine++;
+
+		pcComment = strchr( cLine, '#' );
+		if( pcComment != NULL )
+		{
+			*pcComment = 0x00;
+		}
+
+		/* Blank lines are skipped. */
+		if( strspn( cLine, " \t\r\n" ) == strlen( cLine ) )
+		{
+			continue;
+		}
+
+		if( ( sscanf( cLine, "%47s %lu", cName, &ulLimit ) != 2 ) || ( uxThresholds >= benchMAX_THRESHOLDS ) )
+		{
+			fprintf( stderr, "%s:%u: expected a result name and its threshold\n", pcFileName, uxLine );
+			xReturn = pdFAIL;
+		}
+		else
+		{
+			strcpy( xThresholds[ uxThresholds ].cName, cName );
+			xThresholds[ uxThresholds ].ulLimit = ( uint32_t ) ulLimit;
+			uxThresholds++;
+		}
+	}
+
+	fclose( pxFile );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNow( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	pxBenchmarkFunction( pvBenchmarkContext );
+
+	fflush( stdout );
+	exit( ( xFailed != pdFALSE ) ? EXIT_FAILURE : EXIT_SUCCESS );
+}
+/*-----------------------------------------------------------*/
+
+void vBenchAssertCalled( const char *pcFile, unsigned long ulLine )
+{
+	fprintf( stderr, "Assertion failed at %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+void vBenchConfigureRunTimeCounter( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulBenchGetRunTimeCounter( void )
+{
+	/* Periods of runtimeCOUNTER_PERIOD_US, as getRunTimeCounterValue() counts
+	them on the board. */
+	return ( unsigned long ) ( prvNow() / ( 1000ULL * runtimeCOUNTER_PERIOD_US ) );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+	*ppxIdleTaskStackBuffer = uxIdleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,174 @@
+/*
+ * BenchOutput.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+/*
+ * The time a command console takes to pass command output to its transport,
+ * per KiB, from the line being entered to the prompt after it.  The transport
+ * does nothing with the output, so what is measured is the console, the
+ * command interpreter and the governor.  One command writes its output into
+ * the output buffer, the other refers to a constant with
+ * FreeRTOS_CLIWriteReference(), as the firmware commands that send tables and
+ * help text do.  The time of the second is also reported as a percentage of the
+ * time of the first.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "CommandConsole.h"
+#include "BenchHarness.h"
+
+/* Each command returns this many strings of outputLINE_LENGTH bytes. */
+#define outputCALLS				64
+#define outputLINE_LENGTH		1000
+#define outputITERATIONS		200
+
+static CommandConsole_t xConsole;
+static char cConsoleBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+static char cReferenceData[ outputLINE_LENGTH + 1 ];
+
+/* Everything written to the transport. */
+static size_t xBytesWritten = 0;
+
+static BaseType_t prvNullWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength );
+static BaseType_t prvTextCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static BaseType_t prvReferenceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvEnterLine( void *pvContext );
+static uint32_t prvMeasure( const char *pcName, const char *pcLine );
+static void prvBenchmark( void *pvContext );
+
+static const CommandConsoleTransport_t xNullTransport =
+{
+	prvNullWrite,
+	NULL,
+	prvNullWrite
+};
+
+static const CLI_Command_Definition_t xTextCommand =
+{
+	"out-text",
+	"\r\nout-text:\r\n Writes its output into the output buffer\r\n",
+	prvTextCommand,
+	0,
+	0
+};
+
+static const CLI_Command_Definition_t xReferenceCommand =
+{
+	"out-ref",
+	"\r\nout-ref:\r\n Refers to its output where it is\r\n",
+	prvReferenceCommand,
+	0,
+	0
+};
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+	return iBenchMain( argc, argv, prvBenchmark, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNullWrite( void *pvTransport, const char *pcBuffer, size_t xBufferLength )
+{
+	( void ) pvTransport;
+	( void ) pcBuffer;
+
+	xBytesWritten += xBufferLength;
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTextCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+
+	( void ) pcCommandString;
+	configASSERT( xWriteBufferLen > outputLINE_LENGTH );
+
+	memset( pcWriteBuffer, 'x', outputLINE_LENGTH - 2 );
+	memcpy( &pcWriteBuffer[ outputLINE_LENGTH - 2 ], "\r\n", 3 );
+
+	pxState->uxIndex++;
+	return ( pxState->uxIndex < outputCALLS ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReferenceCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+CLI_Command_State_t *pxState = FreeRTOS_CLIGetCommandState();
+
+	( void ) xWriteBufferLen;
+	( void ) pcCommandString;
+
+	pcWriteBuffer[ 0 ] = 0x00;
+	( void ) FreeRTOS_CLIWriteReference( cReferenceData, outputLINE_LENGTH );
+
+	pxState->uxIndex++;
+	return ( pxState->uxIndex < outputCALLS ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEnterLine( void *pvContext )
+{
+const char *pcLine = ( const char * ) pvContext;
+
+	vCommandConsoleInput( &xConsole, pcLine, strlen( pcLine ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasure( const char *pcName, const char *pcLine )
+{
+size_t xBytesPerLine;
+uint32_t ulNanoseconds, ulPerKiB;
+
+	/* The output includes the echo and the prompt, as a real session's
+	does. */
+	xBytesWritten = 0;
+	prvEnterLine( ( void * ) pcLine );
+	xBytesPerLine = xBytesWritten;
+	configASSERT( xBytesPerLine >= ( outputCALLS * outputLINE_LENGTH ) );
+
+	ulNanoseconds = ulBenchTime( prvEnterLine, ( void * ) pcLine, outputITERATIONS );
+	ulPerKiB = ( uint32_t ) ( ( ( uint64_t ) ulNanoseconds * 1024ULL ) / xBytesPerLine );
+	vBenchReport( pcName, ulPerKiB, "ns/KiB" );
+
+	return ulPerKiB;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmark( void *pvContext )
+{
+BaseType_t xRegistered;
+uint32_t ulText, ulReference;
+
+	( void ) pvContext;
+
+	memset( cReferenceData, 'r', outputLINE_LENGTH - 2 );
+	memcpy( &cReferenceData[ outputLINE_LENGTH - 2 ], "\r\n", 3 );
+
+	xRegistered = FreeRTOS_CLIRegisterCommand( &xTextCommand );
+	configASSERT( xRegistered == pdPASS );
+	xRegistered = FreeRTOS_CLIRegisterCommand( &xReferenceCommand );
+	configASSERT( xRegistered == pdPASS );
+
+	/* The console is initialised by the task that enters the lines, as it is
+	on the board. */
+	vCommandConsoleInit( &xConsole, &xNullTransport, NULL, cConsoleBuffer, sizeof( cConsoleBuffer ) );
+	vCommandConsoleStart( &xConsole );
+
+	ulText = prvMeasure( "output_text", "out-text\r" );
+	ulReference = prvMeasure( "output_reference", "out-ref\r" );
+	vBenchReport( "output_reference_vs_text", ulBenchPercent( ulReference, ulText ), "%" );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,146 @@
+/*
+ * BenchParameters.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+/*
+ * The time taken to execute a command line that fetches each of its
+ * parameters with FreeRTOS_CLIGetParameter(), including the parameter count,
+ * as the number of parameters grows past configCOMMAND_INT_MAX_PARAMETERS,
+ * and the time FreeRTOS_CLIGetNumberOfParameters() takes outside a command.
+ * The time per parameter is also reported as a percentage of the time per
+ * parameter with four parameters, which grows if the cost of a parameter
+ * depends on how many there are.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_CLI.h"
+#include "BenchHarness.h"
+
+static const UBaseType_t uxParameterCounts[] = { 1, 4, 16, 32 };
+
+/* The index in uxParameterCounts[] of the count the others are compared to. */
+#define parametersREFERENCE		1
+
+#define parametersITERATIONS	20000
+
+static char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
+static char cCommandLine[ 256 ];
+
+/* Accumulates the parameter lengths, so the calls cannot be left out. */
+static volatile size_t xParameterLengths = 0;
+
+static BaseType_t prvParametersCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static void prvExecute( void *pvContext );
+static void prvCount( void *pvContext );
+static void prvBenchmark( void *pvContext );
+
+static const CLI_Command_Definition_t xParametersCommand =
+{
+	"params",
+	"\r\nparams <...>:\r\n Fetches each of its parameters\r\n",
+	prvParametersCommand,
+	-1,
+	0
+};
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+	return iBenchMain( argc, argv, prvBenchmark, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParametersCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+UBaseType_t uxParameters, x;
+BaseType_t xLength;
+
+	( void ) xWriteBufferLen;
+
+	uxParameters = FreeRTOS_CLIGetNumberOfParameters( pcCommandString );
+	for( x = 1; x <= uxParameters; x++ )
+	{
+		( void ) FreeRTOS_CLIGetParameter( pcCommandString, x, &xLength );
+		xParameterLengths += ( size_t ) xLength;
+	}
+
+	pcWriteBuffer[ 0 ] = 0x00;
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecute( void *pvContext )
+{
+	( void ) pvContext;
+	( void ) FreeRTOS_CLIProcessCommand( cCommandLine, cOutputBuffer, sizeof( cOutputBuffer ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCount( void *pvContext )
+{
+	( void ) pvContext;
+	xParameterLengths += FreeRTOS_CLIGetNumberOfParameters( cCommandLine );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmark( void *pvContext )
+{
+UBaseType_t uxCount, x;
+size_t xLength;
+BaseType_t xRegistered;
+uint32_t ulExecute, ulCount, ulReferenceExecute = 0, ulReferenceCount = 0;
+char cName[ 48 ];
+
+	( void ) pvContext;
+
+	xRegistered = FreeRTOS_CLIRegisterCommand( &xParametersCommand );
+	configASSERT( xRegistered == pdPASS );
+
+	for( x = 0; x < ( sizeof( uxParameterCounts ) / sizeof( uxParameterCounts[ 0 ] ) ); x++ )
+	{
+		/* Parameters of a few characters, as most commands take. */
+		strcpy( cCommandLine, "params" );
+		xLength = strlen( cCommandLine );
+		for( uxCount = 0; uxCount < uxParameterCounts[ x ]; uxCount++ )
+		{
+			xLength += ( size_t ) snprintf( &cCommandLine[ xLength ], sizeof( cCommandLine ) - xLength, " p%u", ( unsigned int ) uxCount );
+		}
+		configASSERT( xLength < sizeof( cCommandLine ) );
+
+		ulExecute = ulBenchTime( prvExecute, NULL, parametersITERATIONS );
+		snprintf( cName, sizeof( cName ), "parameters_%u_args", ( unsigned int ) uxParameterCounts[ x ] );
+		vBenchReport( cName, ulExecute, "ns" );
+
+		ulCount = ulBenchTime( prvCount, NULL, parametersITERATIONS );
+		snprintf( cName, sizeof( cName ), "parameter_count_%u_args", ( unsigned int ) uxParameterCounts[ x ] );
+		vBenchReport( cName, ulCount, "ns" );
+
+		if( x == parametersREFERENCE )
+		{
+			ulReferenceExecute = ulExecute;
+			ulReferenceCount = ulCount;
+		}
+		else if( x > parametersREFERENCE )
+		{
+			/* The time per parameter, scaled to the reference count so the
+			division does not lose the small times. */
+			snprintf( cName, sizeof( cName ), "parameters_%u_vs_%u_args", ( unsigned int ) uxParameterCounts[ x ], ( unsigned int ) uxParameterCounts[ parametersREFERENCE ] );
+			vBenchReport( cName, ulBenchPercent( ( ulExecute * uxParameterCounts[ parametersREFERENCE ] ) / uxParameterCounts[ x ], ulReferenceExecute ), "%" );
+
+			snprintf( cName, sizeof( cName ), "parameter_count_%u_vs_%u_args", ( unsigned int ) uxParameterCounts[ x ], ( unsigned int ) uxParameterCounts[ parametersREFERENCE ] );
+			vBenchReport( cName, ulBenchPercent( ( ulCount * uxParameterCounts[ parametersREFERENCE ] ) / uxParameterCounts[ x ], ulReferenceCount ), "%" );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
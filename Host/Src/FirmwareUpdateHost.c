@@ -0,0 +1,84 @@
+/*
+ * FirmwareUpdateHost.c
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: enes.dolap
+ */
+
+#include "FirmwareUpdate.h"
+
+/*
+ * Stands in for FirmwareUpdate.c in the host build, so the console links
+ * without FlashAccess.c and the HAL.  There is no flash to program, so every
+ * upload is refused, which is what the console answers a write with when
+ * programming has failed.
+ */
+
+void FirmwareUpdateStart( unsigned long uxPriority )
+{
+	( void ) uxPriority;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateBegin( uint32_t ulLength, uint32_t ulCRC )
+{
+	( void ) ulLength;
+	( void ) ulCRC;
+
+	return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateWrite( uint32_t ulOffset, const uint8_t *pucData, size_t xLength )
+{
+	( void ) ulOffset;
+	( void ) pucData;
+	( void ) xLength;
+
+	return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFirmwareUpdateCommit( void )
+{
+	return pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+void vFirmwareUpdateAbort( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+void vFirmwareUpdateGetStatus( FirmwareUpdateStatus_t *pxStatus )
+{
+	pxStatus->eState = eUpdateIdle;
+	pxStatus->ulLength = 0;
+	pxStatus->ulReceived = 0;
+	pxStatus->ulProgrammed = 0;
+	pxStatus->ulErased = 0;
+	pxStatus->ulMaximumLength = 0;
+	pxStatus->xInstallPending = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulFirmwareBootCRC32( uint32_t ulCRC, const uint8_t *pucData, size_t xLength )
+{
+uint32_t ulBit;
+
+	/* The same reflected CRC-32 the boot code computes, bit by bit. */
+	ulCRC = ~ulCRC;
+	while( xLength > 0 )
+	{
+		ulCRC ^= *pucData;
+		for( ulBit = 0; ulBit < 8; ulBit++ )
+		{
+			ulCRC = ( ulCRC >> 1 ) ^ ( 0xEDB88320UL & ( 0UL - ( ulCRC & 1UL ) ) );
+		}
+		pucData++;
+		xLength--;
+	}
+
+	return ~ulCRC;
+}
+/*-----------------------------------------------------------*/